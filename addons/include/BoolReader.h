@@ -1,19 +1,41 @@
 #ifndef BOOL_READER_H_
 #define BOOL_READER_H_
 
-#include <pigpio.h>
+#include <atomic>
+#include <cstdint>
+
+#include "GpioBackend.h"
 
 namespace addons {
 
 class BoolReader {
     public:
-        BoolReader(int pin);
+        // Called from a backend thread on every reported level change
+        typedef void (*ChangeFunc)(bool bValue, uint32_t uiTick, void* pUserData);
+
+        BoolReader(int pin, GpioBackend& oGpio = GpioBackend::instance());
         virtual ~BoolReader();
 
         bool read(bool& bValue);
 
+        // Edge mode: reports changes through fChange instead of being polled.
+        // Pulses shorter than uiGlitchUs are dropped by the backend where it
+        // has a glitch filter, consumers still debounce what gets through.
+        bool watch(uint32_t uiGlitchUs, ChangeFunc fChange, void* pUserData);
+        void unwatch();
+        bool watching() const;
+
     private:
+        static void onAlert(int iPin, int iLevel, uint32_t uiTick, void* pUserData);
+
         int m_iPin = -1;  // by default is "detach" state
+        GpioBackend& m_oGpio;
+        bool m_bInput = false;
+
+        ChangeFunc m_fChange = nullptr;
+        void* m_pChangeData = nullptr;
+        // Last level seen in edge mode, read() answers from it
+        std::atomic<int> m_iLevel {-1};
 
     };
 
@@ -1,23 +1,105 @@
 #ifndef DHT11_H_
 #define DHT11_H_
 
-#include <pigpio.h>
+#include <atomic>
+#include <cstdint>
+
+#include "GpioBackend.h"
 
 namespace addons {
 
+class EdgeLogWriter;
+
 class DHT11 {
     public:
-        DHT11(int pin);
+        enum CaptureMode {
+            CAPTURE_POLL,   // busy-poll the line for every pulse
+            CAPTURE_ALERT,  // collect backend edge timestamps, decode afterwards
+        };
+
+        enum Status {
+            STATUS_OK,
+            STATUS_INVALID_PIN,
+            STATUS_TIMEOUT,   // missing or late edges
+            STATUS_CHECKSUM,
+        };
+
+        // Falling/rising edges from the response LOW up to the end-of-frame LOW.
+        static constexpr int FRAME_EDGES = 83;
+
+        DHT11(int pin, GpioBackend& oGpio = GpioBackend::instance());
         virtual ~DHT11();
 
         bool read(float& fTemp, float& fHum);
+        // Outcome of the last read()
+        Status lastStatus() const;
+
+        // Returns false if the backend can't report edges, mode is unchanged then.
+        bool setCaptureMode(CaptureMode eMode);
+        CaptureMode captureMode() const;
+
+        // Edge timestamps of one frame, filled from an alert callback.
+        struct EdgeCapture {
+            std::atomic<bool> bArmed {false};
+            std::atomic<int> iCount {0};
+            uint32_t uiArmTick = 0;
+            uint32_t aTicks[FRAME_EDGES];
+        };
+
+        // Appends an alert to an armed capture, dropping edges that can't
+        // belong to the frame.
+        static void captureEdge(EdgeCapture& oCapture, int iLevel, uint32_t uiTick);
+
+        // Records the edges of every frame read in alert mode, nullptr stops.
+        // The log must outlive the reads.
+        void setEdgeLog(EdgeLogWriter* pLog);
+
+        // Bit HIGH pulses at least this long are ones: 26-28 us is a zero, 70 us
+        // a one. Scaled from the response LOW+HIGH (nominally 160 us) so the
+        // sensor's own clock sets it rather than the bit's LOW pulse alone.
+        static uint32_t bitThreshold(uint32_t uiResponseUs);
+
+        // Decodes a frame from edge timestamps, the first one being the falling
+        // edge of the response LOW. A zero threshold is learned from the frame's
+        // response pulses. Throws std::runtime_error on a short frame.
+        static uint64_t decodeEdges(const uint32_t* aTicks, int iCount, uint32_t uiThresholdUs = 0);
+
+        // Checks the checksum of a 40 bit frame and extracts the values.
+        static Status parseFrame(uint64_t data, float& fTemp, float& fHum);
+
+        // Feeds the read metrics for a frame captured outside read(). iEdges
+        // is the number of captured edges, naming the stage of a timeout.
+        static void countRead(Status eStatus, int iEdges, uint32_t uiDurationUs);
 
     private:
+        // Pulse the read was waiting for when it timed out.
+        enum Stage {
+            STAGE_RESPONSE,       // sensor pulling the line LOW
+            STAGE_RESPONSE_LOW,
+            STAGE_RESPONSE_HIGH,
+            STAGE_BIT_LOW,
+            STAGE_BIT_HIGH,
+            STAGE_END,
+            STAGE_COUNT,
+        };
+
+        static Stage stageOf(int iEdges);
+        static void onEdge(int iPin, int iLevel, uint32_t uiTick, void* pUserData);
+
+        uint64_t capturePoll();
+        uint64_t captureAlert();
         int waitLow(uint32_t uiTimeoutUs);
         int waitHigh(uint32_t uiTimeoutUs);
         bool sendRequest();
+        void record();
 
         int m_iPin = -1;  // by default is "detach" state
+        GpioBackend& m_oGpio;
+        CaptureMode m_eCaptureMode = CAPTURE_POLL;
+        Status m_eLastStatus = STATUS_OK;
+        Stage m_eStage = STAGE_RESPONSE;
+        EdgeCapture m_oCapture;
+        EdgeLogWriter* m_pEdgeLog = nullptr;
 
     };
 
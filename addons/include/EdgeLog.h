@@ -0,0 +1,77 @@
+#ifndef EDGE_LOG_H_
+#define EDGE_LOG_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "DHT11.h"
+
+namespace addons {
+
+// Edge logs are binary files of raw DHT11 frames. Edge timestamps are
+// LEB128 varints, the first one absolute and the others as deltas, so a
+// frame takes ~90 bytes.
+//
+//   file:  "THCEDGE1" frame*
+//   frame: time pin status count tick0 delta1 ... delta(count-1)
+
+struct EdgeFrame {
+    uint32_t uiTime;        // unix seconds
+    int iPin;
+    DHT11::Status eStatus;  // what the live decoder made of it
+    int iCount;
+    uint32_t aTicks[DHT11::FRAME_EDGES];
+};
+
+class EdgeLogWriter {
+    public:
+        EdgeLogWriter();
+        virtual ~EdgeLogWriter();
+
+        EdgeLogWriter(const EdgeLogWriter&) = delete;
+        EdgeLogWriter& operator=(const EdgeLogWriter&) = delete;
+
+        // Appends to an existing log
+        bool open(const std::string& sPath);
+        void close();
+        bool isOpen() const;
+
+        bool append(uint32_t uiTime, int iPin, DHT11::Status eStatus, const uint32_t* aTicks, int iCount);
+
+    private:
+        FILE* m_pFile = nullptr;
+};
+
+// Maps the whole file, frames are parsed in place.
+class EdgeLogReader {
+    public:
+        EdgeLogReader();
+        virtual ~EdgeLogReader();
+
+        EdgeLogReader(const EdgeLogReader&) = delete;
+        EdgeLogReader& operator=(const EdgeLogReader&) = delete;
+
+        bool open(const std::string& sPath);
+        void close();
+
+        // False at the end of the log or on a truncated frame.
+        bool next(EdgeFrame& oFrame);
+        // Back to the first frame
+        void rewind();
+
+        size_t size() const;
+
+    private:
+        bool varint(uint32_t& uiValue);
+
+        void* m_pMap = nullptr;
+        size_t m_uiSize = 0;
+        const uint8_t* m_pPos = nullptr;
+        const uint8_t* m_pEnd = nullptr;
+};
+
+}
+
+#endif  // EDGE_LOG_H_
@@ -0,0 +1,112 @@
+#ifndef GPIO_BACKEND_H_
+#define GPIO_BACKEND_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace addons {
+
+// Low level GPIO access the drivers are written against. Mode, pull and level
+// values match the pigpio constants so the pigpio backend is a thin pass-through.
+class GpioBackend {
+public:
+    enum Mode {
+        MODE_INPUT  = 0,
+        MODE_OUTPUT = 1,
+    };
+
+    enum Pull {
+        PUD_OFF  = 0,
+        PUD_DOWN = 1,
+        PUD_UP   = 2,
+    };
+
+    // One waveform step, same layout as pigpio's gpioPulse_t: set the pins in
+    // uiOn, clear the pins in uiOff, then wait uiDelayUs. Masks cover GPIO 0-31.
+    struct Pulse {
+        uint32_t uiOn;
+        uint32_t uiOff;
+        uint32_t uiDelayUs;
+    };
+
+    // Same signature as pigpio's gpioAlertFuncEx_t. Level 2 reports a watchdog timeout.
+    typedef void (*AlertFunc)(int iPin, int iLevel, uint32_t uiTick, void* pUserData);
+
+    virtual ~GpioBackend();
+
+    virtual const char* name() const = 0;
+
+    // Starts whatever threads the backend runs, the alert one included, so
+    // the caller may change its own scheduling afterwards.
+    virtual int initialise() = 0;
+    virtual void terminate() = 0;
+
+    virtual int setMode(unsigned uiPin, unsigned uiMode) = 0;
+    virtual int setPullUpDown(unsigned uiPin, unsigned uiPud) = 0;
+    virtual int read(unsigned uiPin) = 0;
+    virtual int write(unsigned uiPin, unsigned uiLevel) = 0;
+
+    // GPIO 0-31 at once, bit n for GPIO n. writeBank() sets the pins in uiSet,
+    // then clears the pins in uiClear. Backends with bank registers touch each
+    // once, the defaults go pin by pin.
+    virtual uint32_t readBank();
+    virtual int writeBank(uint32_t uiSet, uint32_t uiClear);
+
+    // Microseconds since an arbitrary point, wraps every ~72 minutes.
+    virtual uint32_t tick() = 0;
+    virtual uint32_t delay(uint32_t uiMicros) = 0;
+
+    // Calls fAlert from a backend thread on every level change of the pin,
+    // nullptr removes it. Returns a negative value if edges can't be reported.
+    virtual int setAlertFunc(unsigned uiPin, AlertFunc fAlert, void* pUserData);
+    // Level changes are only reported once the pin held the new level for
+    // uiSteadyUs, 0 turns the filter off. Negative if it isn't supported.
+    virtual int setGlitchFilter(unsigned uiPin, uint32_t uiSteadyUs);
+
+    // Pre-compiled waveforms played out by hardware without the CPU. Only the
+    // output levels of pins already in output mode can be changed by a wave.
+    virtual bool supportsWaves() const;
+    // Returns a wave id, negative on failure.
+    virtual int waveCreate(const std::vector<Pulse>& vPulses);
+    // Starts a one-shot transmission, waveBusy() reports when it is done.
+    virtual int waveSend(unsigned uiWaveId);
+    virtual bool waveBusy();
+    virtual int waveDelete(unsigned uiWaveId);
+
+    // Writes, mode changes and delays between beginBatch() and endBatch() may be
+    // queued and sent together by remote backends, keeping their order and
+    // delays. Calls returning a level or a tick send what is queued first.
+    // Local backends run every call right away. Batches nest.
+    virtual void beginBatch();
+    virtual void endBatch();
+
+    // beginBatch() for the lifetime of the object.
+    class Batch {
+    public:
+        explicit Batch(GpioBackend& oGpio);
+        ~Batch();
+
+        Batch(const Batch&) = delete;
+        Batch& operator=(const Batch&) = delete;
+
+    private:
+        GpioBackend& m_oGpio;
+    };
+
+    // Creates a backend by name ("pigpio", "pigpiod", "sim"), nullptr if it is not available.
+    static std::unique_ptr<GpioBackend> create(const std::string& sName);
+    static const char* defaultName();
+
+    // Process wide backend used by drivers constructed without an explicit one.
+    static void setInstance(GpioBackend* pBackend);
+    static GpioBackend& instance();
+
+private:
+    static GpioBackend* s_pInstance;
+};
+
+}
+
+#endif  // GPIO_BACKEND_H_
@@ -0,0 +1,41 @@
+#ifndef JITTER_PROBE_H_
+#define JITTER_PROBE_H_
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "GpioBackend.h"
+
+namespace addons {
+
+// Measures how long GpioBackend::delay() really takes against the monotonic
+// clock, for the delays the drivers use.
+class JitterProbe {
+    public:
+        // Overshoot distribution of one requested delay, in microseconds.
+        struct Result {
+            uint32_t uiRequestedUs;
+            int iSamples;
+            double dMin;
+            double dMedian;
+            double dP99;
+            double dP999;
+            double dMax;
+        };
+
+        JitterProbe(GpioBackend& oGpio = GpioBackend::instance());
+
+        // Runs iSamples delays of each duration.
+        std::vector<Result> run(const std::vector<uint32_t>& vRequestedUs, int iSamples);
+
+        static void print(std::ostream& oOut, const std::vector<Result>& vResults);
+
+    private:
+        GpioBackend& m_oGpio;
+
+    };
+
+}
+
+#endif  // JITTER_PROBE_H_
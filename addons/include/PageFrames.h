@@ -0,0 +1,91 @@
+#ifndef PAGE_FRAMES_H_
+#define PAGE_FRAMES_H_
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "SegmentFont.h"
+
+namespace addons {
+
+// Segments of the clock's pages on a 4 digit TM1637, rendered with integer
+// arithmetic straight into a frame: no text, no heap.
+namespace pages {
+
+typedef std::array<uint8_t, 4> Frame;
+
+constexpr uint8_t digit(int iValue) {
+    return segments::glyph(static_cast<char>('0' + iValue));
+}
+
+// "HHMM", the colon is lit separately
+constexpr Frame clock(int iHour, int iMinute) {
+    return Frame {digit(iHour / 10), digit(iHour % 10), digit(iMinute / 10), digit(iMinute % 10)};
+}
+
+constexpr std::array<Frame, 24 * 60> makeClockFrames() {
+    std::array<Frame, 24 * 60> aFrames {};
+    for (int i = 0; i < 24 * 60; ++i) {
+        aFrames[i] = clock(i / 60, i % 60);
+    }
+    return aFrames;
+}
+
+// Every minute of the day, 5.6 KiB of read-only data
+inline constexpr std::array<Frame, 24 * 60> CLOCK_FRAMES = makeClockFrames();
+
+inline const Frame& clockFrame(int iHour, int iMinute) {
+    return CLOCK_FRAMES[(iHour * 60 + iMinute) % (24 * 60)];
+}
+
+// "23*C", " 5*C", "-15*" or " -5*"; false if the rounded value needs more
+// than two digits. Rounds half to even, like printf.
+inline bool temperature(float fTemp, Frame& aFrame) {
+    long lTemp = std::lrint(fTemp);
+    if (lTemp < -99 || lTemp > 99) {
+        return false;
+    }
+
+    constexpr uint8_t BLANK = 0;
+    constexpr uint8_t DEGREE = segments::glyph('*');
+    if (lTemp >= 0) {
+        aFrame = {lTemp < 10 ? BLANK : digit(lTemp / 10), digit(lTemp % 10), DEGREE, segments::glyph('C')};
+    } else if (lTemp > -10) {
+        aFrame = {BLANK, segments::glyph('-'), digit(-lTemp), DEGREE};
+    } else {
+        aFrame = {segments::glyph('-'), digit(-lTemp / 10), digit(-lTemp % 10), DEGREE};
+    }
+    return true;
+}
+
+// Right aligned percent; false if negative or wider than the display.
+inline bool humidity(float fHum, Frame& aFrame) {
+    long lHum = std::lrint(fHum);
+    if (lHum < 0 || lHum > 9999) {
+        return false;
+    }
+
+    for (size_t i = aFrame.size(); i-- > 0;) {
+        aFrame[i] = digit(lHum % 10);
+        lHum /= 10;
+        if (lHum == 0) {
+            while (i-- > 0) {
+                aFrame[i] = 0;
+            }
+            break;
+        }
+    }
+    return true;
+}
+
+static_assert(clock(7, 5)[0] == digit(0) && clock(7, 5)[3] == digit(5), "clock pads with zeros");
+static_assert(CLOCK_FRAMES[23 * 60 + 59][1] == digit(3) && CLOCK_FRAMES[23 * 60 + 59][2] == digit(5),
+              "one frame per minute");
+
+}
+
+}
+
+#endif  // PAGE_FRAMES_H_
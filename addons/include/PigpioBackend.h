@@ -0,0 +1,44 @@
+#ifndef PIGPIO_BACKEND_H_
+#define PIGPIO_BACKEND_H_
+
+#include "GpioBackend.h"
+
+namespace addons {
+
+// Direct register access through the pigpio C library. Requires root.
+class PigpioBackend : public GpioBackend {
+public:
+    PigpioBackend();
+    virtual ~PigpioBackend();
+
+    const char* name() const override;
+
+    int initialise() override;
+    void terminate() override;
+
+    int setMode(unsigned uiPin, unsigned uiMode) override;
+    int setPullUpDown(unsigned uiPin, unsigned uiPud) override;
+    int read(unsigned uiPin) override;
+    int write(unsigned uiPin, unsigned uiLevel) override;
+    uint32_t readBank() override;
+    int writeBank(uint32_t uiSet, uint32_t uiClear) override;
+
+    uint32_t tick() override;
+    uint32_t delay(uint32_t uiMicros) override;
+
+    int setAlertFunc(unsigned uiPin, AlertFunc fAlert, void* pUserData) override;
+    int setGlitchFilter(unsigned uiPin, uint32_t uiSteadyUs) override;
+
+    bool supportsWaves() const override;
+    int waveCreate(const std::vector<Pulse>& vPulses) override;
+    int waveSend(unsigned uiWaveId) override;
+    bool waveBusy() override;
+    int waveDelete(unsigned uiWaveId) override;
+
+private:
+    bool m_bInitialised = false;
+};
+
+}
+
+#endif  // PIGPIO_BACKEND_H_
@@ -0,0 +1,95 @@
+#ifndef PIGPIOD_BACKEND_H_
+#define PIGPIOD_BACKEND_H_
+
+#include <array>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "GpioBackend.h"
+#include "PigpiodProtocol.h"
+
+namespace addons {
+
+// Client of a running pigpiod, over its TCP socket: no root, no DMA setup and
+// several processes can share the GPIOs. Every call is a round trip, except
+// inside a batch where writes, modes and delays are queued and sent in one
+// request; the daemon runs them in order, delays included, and the replies
+// are collected when the batch is flushed. Edges are reported on a second,
+// notification socket and only for GPIO 0-31.
+class PigpiodBackend : public GpioBackend {
+public:
+    // An empty host and a zero port are taken from PIGPIO_ADDR and PIGPIO_PORT
+    // like pigpio's own clients do, then default to localhost:8888.
+    explicit PigpiodBackend(const std::string& sHost = "", uint16_t uiPort = 0);
+    virtual ~PigpiodBackend();
+
+    const char* name() const override;
+
+    int initialise() override;
+    void terminate() override;
+
+    int setMode(unsigned uiPin, unsigned uiMode) override;
+    int setPullUpDown(unsigned uiPin, unsigned uiPud) override;
+    int read(unsigned uiPin) override;
+    int write(unsigned uiPin, unsigned uiLevel) override;
+    uint32_t readBank() override;
+    int writeBank(uint32_t uiSet, uint32_t uiClear) override;
+
+    uint32_t tick() override;
+    uint32_t delay(uint32_t uiMicros) override;
+
+    int setAlertFunc(unsigned uiPin, AlertFunc fAlert, void* pUserData) override;
+    int setGlitchFilter(unsigned uiPin, uint32_t uiSteadyUs) override;
+
+    bool supportsWaves() const override;
+    int waveCreate(const std::vector<Pulse>& vPulses) override;
+    int waveSend(unsigned uiWaveId) override;
+    bool waveBusy() override;
+    int waveDelete(unsigned uiWaveId) override;
+
+    void beginBatch() override;
+    void endBatch() override;
+
+private:
+    // Queued commands are sent once this many are waiting, keeping the
+    // requests and replies in flight well below the socket buffers.
+    static constexpr size_t MAX_QUEUED = 256;
+
+    int connectDaemon();
+    // Sends one command after whatever is queued and waits for its result.
+    int command(uint32_t uiCmd, uint32_t uiP1 = 0, uint32_t uiP2 = 0,
+                const void* pExt = nullptr, uint32_t uiExtLength = 0);
+    // Runs the command now, or queues it inside a batch.
+    int submit(uint32_t uiCmd, uint32_t uiP1, uint32_t uiP2);
+    // With m_mutex held
+    int transact(uint32_t uiCmd, uint32_t uiP1, uint32_t uiP2, const void* pExt, uint32_t uiExtLength);
+    int flush();
+
+    int openNotifications();
+    int updateNotifications();
+    void notifyLoop(int iFd);
+
+    std::string m_sHost;
+    uint16_t m_uiPort;
+
+    std::mutex m_mutex;  // command socket and queue
+    int m_iCmdFd = -1;
+    int m_iBatchDepth = 0;
+    std::vector<pigpiod::Header> m_vQueue;
+
+    // Alerts, dispatched from the notification thread
+    std::mutex m_alertMutex;
+    int m_iNotifyFd = -1;
+    int m_iNotifyHandle = -1;
+    std::thread m_notifyThread;
+    uint32_t m_uiAlertMask = 0;
+    uint32_t m_uiLevels = 0;
+    std::array<AlertFunc, 32> m_aAlerts {};
+    std::array<void*, 32> m_aAlertData {};
+};
+
+}
+
+#endif  // PIGPIOD_BACKEND_H_
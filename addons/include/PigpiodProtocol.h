@@ -0,0 +1,67 @@
+#ifndef PIGPIOD_PROTOCOL_H_
+#define PIGPIOD_PROTOCOL_H_
+
+#include <cstdint>
+
+namespace addons {
+
+// The subset of the pigpiod socket protocol used by PigpiodBackend, values
+// from pigpio.h. Every request is a Header, followed by p3 bytes of extension;
+// every reply is a Header whose p3 holds the (signed) result.
+namespace pigpiod {
+
+enum Command : uint32_t {
+    CMD_MODES = 0,
+    CMD_PUD   = 2,
+    CMD_READ  = 3,
+    CMD_WRITE = 4,
+    CMD_BR1   = 10,
+    CMD_BC1   = 12,
+    CMD_BS1   = 14,
+    CMD_TICK  = 16,
+    CMD_HWVER = 17,
+    CMD_NB    = 19,
+    CMD_NC    = 21,
+    CMD_WVCLR = 27,
+    CMD_WVAG  = 28,
+    CMD_WVBSY = 32,
+    CMD_MICS  = 46,
+    CMD_MILS  = 47,
+    CMD_WVCRE = 49,
+    CMD_WVDEL = 50,
+    CMD_WVTX  = 51,
+    CMD_WVNEW = 53,
+    CMD_FG    = 97,
+    CMD_NOIB  = 99,
+};
+
+struct Header {
+    uint32_t uiCmd;
+    uint32_t uiP1;
+    uint32_t uiP2;
+    uint32_t uiP3;
+};
+
+// Sent on a notification socket opened with CMD_NOIB, for every change of
+// the GPIOs selected with CMD_NB.
+struct Report {
+    uint16_t uiSeq;
+    uint16_t uiFlags;
+    uint32_t uiTick;
+    uint32_t uiLevels;  // GPIO 0-31
+};
+
+constexpr uint16_t NTFY_FLAGS_WDOG = 1 << 5;   // watchdog timeout, GPIO in the low bits
+constexpr uint16_t NTFY_FLAGS_ALIVE = 1 << 6;  // keep-alive, levels unchanged
+constexpr uint16_t NTFY_FLAGS_GPIO = 31;
+
+constexpr uint32_t MAX_MICS_DELAY = 1000000;
+constexpr uint32_t MAX_MILS_DELAY = 60000;
+
+constexpr uint16_t DEFAULT_PORT = 8888;
+
+}
+
+}
+
+#endif  // PIGPIOD_PROTOCOL_H_
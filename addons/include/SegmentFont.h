@@ -0,0 +1,139 @@
+#ifndef SEGMENT_FONT_H_
+#define SEGMENT_FONT_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace addons {
+
+namespace segments {
+
+ //    - A -
+ //   F     B
+ //    - G -
+ //   E     C
+ //    - D -
+
+enum Segment : uint8_t {
+    SegA  = 0x01, //0b00000001
+    SegB  = 0x02, //0b00000010
+    SegC  = 0x04, //0b00000100
+    SegD  = 0x08, //0b00001000
+    SegE  = 0x10, //0b00010000
+    SegF  = 0x20, //0b00100000
+    SegG  = 0x40, //0b01000000
+    SegDP = 0x80, //0b10000000
+};
+
+struct Glyph {
+    char cChar;
+    uint8_t uiSegments;
+};
+
+constexpr Glyph GLYPHS[] = {
+    { '0', SegA | SegB | SegC | SegD | SegE | SegF },
+    { '1', SegB | SegC },
+    { '2', SegA | SegB | SegG | SegE | SegD },
+    { '3', SegA | SegB | SegG | SegC | SegD },
+    { '4', SegF | SegG | SegB | SegC },
+    { '5', SegA | SegF | SegG | SegC | SegD },
+    { '6', SegF | SegE | SegG | SegC | SegD },
+    { '7', SegA | SegB | SegC },
+    { '8', SegA | SegB | SegC | SegD | SegE | SegF | SegG },
+    { '9', SegA | SegB | SegC | SegF | SegG },
+    { 'A', SegA | SegB | SegC | SegE | SegF | SegG },
+    { 'B', SegF | SegE | SegG | SegC | SegD },
+    { 'C', SegA | SegF | SegE | SegD },
+    { 'D', SegB | SegC | SegG | SegE | SegD },
+    { 'E', SegA | SegF | SegG | SegE | SegD },
+    { 'G', SegA | SegF | SegE | SegD | SegC | SegG },
+    { 'F', SegA | SegF | SegG | SegE },
+    { 'H', SegF | SegG | SegE | SegB | SegC },
+    { 'I', SegE },
+    { 'J', SegB | SegC | SegD | SegE },
+    { 'L', SegF | SegE | SegD },
+    { 'N', SegE | SegG | SegC },
+    { 'O', SegE | SegG | SegC | SegD },
+    { 'P', SegA | SegB | SegF | SegG | SegE },
+    { 'R', SegG | SegE },
+    { 'S', SegA | SegF | SegG | SegC | SegD },
+    { 'T', SegF | SegG | SegE | SegD },
+    { 'U', SegF | SegE|SegD|SegB|SegC },
+    { 'Y', SegF | SegG | SegB | SegC | SegD },
+    { 'Z', SegA | SegB | SegG | SegE | SegD },
+    { '-', SegG },
+    { '_', SegD },
+    { '.', SegD },
+    { ',', SegD },
+    { '\'', SegB },
+    { '"', SegF | SegB },
+    { char(0xB0), SegF | SegA | SegB | SegG }, // Degree sign (ISO/IEC 8859-1)
+    { '*', SegF | SegA | SegB | SegG },        // Degree sign replacement
+    { '\\', SegF | SegG | SegC },
+    { '/', SegE | SegG | SegB },
+    { '^', SegF | SegA | SegB }
+};
+
+// Segments of every byte value, letters in either case. Characters without
+// a glyph, space and NUL are blank.
+constexpr std::array<uint8_t, 256> makeFont() {
+    std::array<uint8_t, 256> aFont {};
+    for (const Glyph& oGlyph : GLYPHS) {
+        uint8_t uiChar = static_cast<uint8_t>(oGlyph.cChar);
+        aFont[uiChar] = oGlyph.uiSegments;
+        if (uiChar >= 'A' && uiChar <= 'Z') {
+            aFont[uiChar - 'A' + 'a'] = oGlyph.uiSegments;
+        }
+    }
+    return aFont;
+}
+
+inline constexpr std::array<uint8_t, 256> FONT = makeFont();
+
+constexpr uint8_t glyph(char cChar) {
+    return FONT[static_cast<uint8_t>(cChar)];
+}
+
+constexpr bool known(char cChar) {
+    return glyph(cChar) != 0 || cChar == ' ' || cChar == '\0';
+}
+
+// Converts text to per-digit segments in one pass, unused digits blank.
+// With FOLD_DOTS a '.' lights the decimal point of the previous digit
+// instead of taking a digit of its own. Returns the number of digits the
+// text needs; anything past DIGITS is dropped.
+template <size_t DIGITS, bool FOLD_DOTS>
+constexpr size_t encode(const char* pText, size_t uiLength, std::array<uint8_t, DIGITS>& aOut) {
+    for (size_t i = 0; i < DIGITS; ++i) {
+        aOut[i] = 0;
+    }
+
+    size_t uiDigit = 0;
+    bool bDotFolded = false;
+    for (size_t i = 0; i < uiLength; ++i) {
+        char cChar = pText[i];
+        if (FOLD_DOTS && cChar == '.' && uiDigit > 0 && !bDotFolded) {
+            if (uiDigit <= DIGITS) {
+                aOut[uiDigit - 1] |= SegDP;
+            }
+            bDotFolded = true;
+            continue;
+        }
+        if (uiDigit < DIGITS) {
+            aOut[uiDigit] = glyph(cChar);
+        }
+        ++uiDigit;
+        bDotFolded = false;
+    }
+    return uiDigit;
+}
+
+static_assert(glyph('e') == glyph('E') && glyph('E') != 0, "letters are case-insensitive");
+static_assert(!known('@') && known(' '), "unknown characters are blank");
+
+}
+
+}
+
+#endif  // SEGMENT_FONT_H_
@@ -0,0 +1,151 @@
+#ifndef SIM_DEVICES_H_
+#define SIM_DEVICES_H_
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "SimGpioBackend.h"
+
+namespace addons {
+
+// DHT11 on a single data line. Answers a start pulse (host LOW for at least
+// uiMinStartUs, then released) with the datasheet response and 40 data bits.
+class SimDHT11 : public SimDevice {
+public:
+    struct Timing {
+        uint32_t uiGoUs = 30;         // release -> sensor pulls low
+        uint32_t uiRespLowUs = 80;
+        uint32_t uiRespHighUs = 80;
+        uint32_t uiBitLowUs = 50;
+        uint32_t uiZeroHighUs = 26;
+        uint32_t uiOneHighUs = 70;
+        uint32_t uiEndLowUs = 50;
+        uint32_t uiMinStartUs = 18000;
+    };
+
+    // Chances of a frame being corrupted, one fault at most per frame. Drawn
+    // from a seeded generator, so a run can be replayed.
+    struct Faults {
+        double dMissingEdge = 0;     // a pulse is left out, the frame is short
+        double dStretchedPulse = 0;  // a pulse lasts uiStretchUs longer
+        uint32_t uiStretchUs = 50;
+        double dBadChecksum = 0;     // the checksum byte is off by one
+    };
+
+    explicit SimDHT11(unsigned uiPin);
+    virtual ~SimDHT11();
+
+    void setReading(uint8_t uiTemp, uint8_t uiHum);
+    void setTiming(const Timing& oTiming);
+    void setFaults(const Faults& oFaults, uint32_t uiSeed = 1);
+
+    uint64_t frames() const;
+    uint64_t faultyFrames() const;
+
+    void onLineChange(unsigned uiPin, int iLevel, uint64_t ullNowNs) override;
+    int drive(unsigned uiPin, uint64_t ullNowNs) override;
+    bool nextToggle(unsigned uiPin, uint64_t ullAfterNs, uint64_t& ullAtNs) override;
+
+private:
+    void startResponse(uint64_t ullNowNs);
+
+    unsigned m_uiPin;
+    Timing m_oTiming;
+    Faults m_oFaults;
+    std::mt19937 m_oRng;
+    uint64_t m_ullFaultyFrames = 0;
+    uint8_t m_uiTemp = 22;
+    uint8_t m_uiHum = 45;
+
+    int m_iLast = 1;
+    uint64_t m_ullLowSinceNs = 0;
+    // Absolute times at which the sensor toggles its output, first one pulls low.
+    std::vector<uint64_t> m_vToggles;
+    uint64_t m_ullFrames = 0;
+};
+
+// Light sensor module with a digital output: HIGH in light, LOW in the dark.
+// Switches every uiPeriodMs of simulated time, each switch bouncing uiBounces
+// times 1 ms apart before it settles.
+class SimLightSensor : public SimDevice {
+public:
+    SimLightSensor(unsigned uiPin, uint32_t uiPeriodMs = 30000, unsigned uiBounces = 2);
+    virtual ~SimLightSensor();
+
+    // Holds the output at iLevel whatever the light, -1 lets it switch again.
+    void setStuck(int iLevel);
+
+    void onLineChange(unsigned uiPin, int iLevel, uint64_t ullNowNs) override;
+    int drive(unsigned uiPin, uint64_t ullNowNs) override;
+    bool nextToggle(unsigned uiPin, uint64_t ullAfterNs, uint64_t& ullAtNs) override;
+
+private:
+    static constexpr uint64_t BOUNCE_NS = 1000000;
+
+    unsigned m_uiPin;
+    uint64_t m_ullPeriodNs;
+    uint64_t m_ullTogglesPerSwitch;  // odd, the level ends up flipped
+    int m_iStuck = -1;
+};
+
+// TM1637 on a CLK/DIO pair. Decodes start/stop conditions and LSB first bytes,
+// ACKs every byte by pulling DIO low for the ninth clock and latches data,
+// address and display control commands on stop.
+class SimTM1637 : public SimDevice {
+public:
+    SimTM1637(unsigned uiClkPin, unsigned uiDioPin);
+    virtual ~SimTM1637();
+
+    const std::array<uint8_t, 6>& segments() const;
+    int brightness() const;
+    bool displayOn() const;
+
+    // Transactions that carried an address command with segment data.
+    uint64_t frames() const;
+    uint64_t bytes() const;
+
+    // A clock phase shorter than this makes the module lose the transaction:
+    // it stops ACKing until the next start condition. 0 keeps up with any speed.
+    void setMinClockPhaseNs(uint64_t ullNs);
+    // Chance of a transaction being ignored: no ACKs and nothing latched.
+    void setNackRate(double dRate, uint32_t uiSeed = 1);
+    uint64_t nacked() const;
+
+    void onLineChange(unsigned uiPin, int iLevel, uint64_t ullNowNs) override;
+    int drive(unsigned uiPin, uint64_t ullNowNs) override;
+
+private:
+    void onClock(int iLevel);
+    void onData(int iLevel);
+    void latch();
+
+    unsigned m_uiClkPin;
+    unsigned m_uiDioPin;
+    int m_iClk = 1;
+    int m_iDio = 1;
+    uint64_t m_ullMinPhaseNs = 0;
+    uint64_t m_ullClkChangeNs = 0;
+    double m_dNackRate = 0;
+    std::mt19937 m_oRng;
+    bool m_bIgnoring = false;  // current transaction
+    uint64_t m_ullNacked = 0;
+
+    bool m_bReceiving = false;
+    int m_iBit = 0;   // 0..7 data bits, 8 waiting for ACK clock, 9 in ACK clock
+    uint8_t m_uiByte = 0;
+    bool m_bAck = false;
+    std::vector<uint8_t> m_vBytes;
+
+    bool m_bAutoIncrement = true;
+    std::array<uint8_t, 6> m_aSegments {0, 0, 0, 0, 0, 0};
+    int m_iBrightness = 0;
+    bool m_bOn = false;
+    uint64_t m_ullFrames = 0;
+    uint64_t m_ullBytes = 0;
+};
+
+}
+
+#endif  // SIM_DEVICES_H_
@@ -0,0 +1,107 @@
+#ifndef SIM_GPIO_BACKEND_H_
+#define SIM_GPIO_BACKEND_H_
+
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "GpioBackend.h"
+
+namespace addons {
+
+// A peripheral attached to one or more pins of the simulated bus.
+class SimDevice {
+public:
+    virtual ~SimDevice();
+
+    // Called when the host changes what it drives on one of the device pins.
+    // iLevel is the resulting wire level (host and device wired-AND).
+    virtual void onLineChange(unsigned uiPin, int iLevel, uint64_t ullNowNs) = 0;
+
+    // Level the device drives: 0 pulls the line low, 1 leaves it to the pull-up.
+    virtual int drive(unsigned uiPin, uint64_t ullNowNs) = 0;
+
+    // Earliest time after ullAfterNs at which drive() changes on its own.
+    virtual bool nextToggle(unsigned uiPin, uint64_t ullAfterNs, uint64_t& ullAtNs);
+};
+
+// In-process GPIO bus with a virtual clock. Delays advance the clock instantly
+// and every other call costs a fixed number of nanoseconds, so busy-polling
+// drivers observe deterministic pulse widths and always terminate.
+// Undriven lines read HIGH (external pull-up) unless a pull-down is selected.
+// Waves play out synchronously inside waveSend(), advancing the clock.
+// Alerts are dispatched synchronously, from whichever call advances the clock
+// past an edge, with the bus lock held: callbacks must not call back into it.
+class SimGpioBackend : public GpioBackend {
+public:
+    static constexpr unsigned PIN_COUNT = 54;  // fits the alert pin mask
+
+    SimGpioBackend();
+    virtual ~SimGpioBackend();
+
+    const char* name() const override;
+
+    int initialise() override;
+    void terminate() override;
+
+    int setMode(unsigned uiPin, unsigned uiMode) override;
+    int setPullUpDown(unsigned uiPin, unsigned uiPud) override;
+    int read(unsigned uiPin) override;
+    int write(unsigned uiPin, unsigned uiLevel) override;
+    uint32_t readBank() override;
+    int writeBank(uint32_t uiSet, uint32_t uiClear) override;
+
+    uint32_t tick() override;
+    uint32_t delay(uint32_t uiMicros) override;
+
+    int setAlertFunc(unsigned uiPin, AlertFunc fAlert, void* pUserData) override;
+
+    bool supportsWaves() const override;
+    int waveCreate(const std::vector<Pulse>& vPulses) override;
+    int waveSend(unsigned uiWaveId) override;
+    bool waveBusy() override;
+    int waveDelete(unsigned uiWaveId) override;
+
+    // Devices sharing a pin see the same wire, each can pull it low.
+    void attach(std::shared_ptr<SimDevice> pDevice, std::initializer_list<unsigned> lPins);
+
+    void setCallCostNs(uint32_t uiNs);
+    uint64_t nowNs() const;
+    void advanceNs(uint64_t ullNs);
+
+private:
+    struct PinState {
+        unsigned uiMode = MODE_INPUT;
+        unsigned uiLatch = 0;
+        unsigned uiPud = PUD_OFF;
+        std::vector<std::shared_ptr<SimDevice>> vDevices;
+        AlertFunc fAlert = nullptr;
+        void* pAlertData = nullptr;
+        int iAlertLevel = 1;
+    };
+
+    bool validPin(unsigned uiPin) const;
+    int hostLevel(const PinState& oPin) const;
+    int lineLevel(unsigned uiPin);
+    int driveLevel(const PinState& oPin, unsigned uiPin, uint64_t ullAtNs) const;
+    void latch(unsigned uiPin, unsigned uiLevel);
+    void updateHost(unsigned uiPin, int iPrevHost);
+    void advance(uint64_t ullNs);
+    void alert(unsigned uiPin, uint64_t ullAtNs);
+
+    mutable std::mutex m_mutex;
+    std::array<PinState, PIN_COUNT> m_aPins;
+    uint64_t m_ullNowNs = 0;
+    uint32_t m_uiCallCostNs = 250;
+    uint64_t m_ullAlertPins = 0;  // bit per pin with an alert function
+    std::map<unsigned, std::vector<Pulse>> m_mWaves;
+    unsigned m_uiNextWaveId = 0;
+};
+
+}
+
+#endif  // SIM_GPIO_BACKEND_H_
@@ -1,16 +1,57 @@
 #ifndef TM1637_H_
 #define TM1637_H_
 
+#include <array>
+#include <cstdint>
+#include <deque>
 #include <map>
 #include <string>
+#include <vector>
+
+#include "GpioBackend.h"
+#include "SegmentFont.h"
+#include "TM1637Timing.h"
 
 namespace addons {
 
-class TM1637 {
+// Clock modules: the colon is wired to the decimal point of the 2nd digit.
+struct ColonLayout {
+    static constexpr unsigned POINTS = 0x2;  // digits lit by switchPoints()
+    static constexpr bool FOLD_DOTS = false;
+};
+
+// Decimal modules: every digit has its own point, set by a '.' in the text.
+struct DecimalLayout {
+    static constexpr unsigned POINTS = 0;
+    static constexpr bool FOLD_DOTS = true;
+};
+
+template <size_t DIGITS, typename Layout>
+class BasicTM1637 {
+
+    static_assert(DIGITS >= 1 && DIGITS <= 6, "TM1637 drives up to 6 digits");
 
 public:
-    TM1637(int iIOPin, int iClkPin);
-    virtual ~TM1637();
+    typedef std::array<uint8_t, DIGITS> Frame;
+
+    // Outcome of display() calls. Skipped frames matched what the module already
+    // shows, partial ones only rewrote changed digits, control ones only the
+    // brightness.
+    struct FrameStats {
+        uint64_t ullFull = 0;
+        uint64_t ullPartial = 0;
+        uint64_t ullControl = 0;
+        uint64_t ullSkipped = 0;
+        uint64_t ullFailed = 0;
+    };
+
+    enum TransmitMode {
+        TRANSMIT_BITBANG,  // every edge written by the calling thread
+        TRANSMIT_WAVE,     // frame data compiled into a cached hardware wave
+    };
+
+    BasicTM1637(int iIOPin, int iClkPin, GpioBackend& oGpio = GpioBackend::instance());
+    virtual ~BasicTM1637();
 
     void setBrightness(int iBr);
 
@@ -18,21 +59,31 @@ public:
     void display(char cData, int iPos);
     void display(int iData, bool bDots);
     void display(const std::string& sData, bool bDots);
+    // Segments already rendered, e.g. by PageFrames.h: copies nothing else
+    // and allocates nothing.
+    void display(const Frame& aGlyphs, bool bDots);
     void switchPoints(bool bPoints);
 
     void clear();
-private:
-    enum Segment {
-        SegA  = 0x01, //0b00000001
-        SegB  = 0x02, //0b00000010
-        SegC  = 0x04, //0b00000100
-        SegD  = 0x08, //0b00001000
-        SegE  = 0x10, //0b00010000
-        SegF  = 0x20, //0b00100000
-        SegG  = 0x40, //0b01000000
-        SegDP = 0x80, //0b10000000
-    };
 
+    // Forget the last latched frame, e.g. after the module lost power.
+    void invalidate();
+    const FrameStats& frameStats() const;
+
+    // Returns false if the backend can't play waves, mode is unchanged then.
+    bool setTransmitMode(TransmitMode eMode);
+
+    // Bus delays, e.g. from a TM1637TimingProfile. A display attempt missing an
+    // ACK slows them down step by step, back to the defaults at most.
+    void setTiming(const TM1637Timing& oTiming);
+    const TM1637Timing& timing() const;
+
+    // Searches each delay for the shortest value at which iFrames trial frames
+    // are all ACKed, then doubles them as a safety margin. The timing in use
+    // is unchanged; false if even the result misses ACKs.
+    bool calibrate(int iFrames, TM1637Timing& oResult);
+
+private:
     enum Mode {
         FIXED_ADDRESS_MODE  = 0x44,
         AUTO_ADDRESS_MODE   = 0x40,
@@ -41,22 +92,48 @@ private:
     const char ADDRESS_OF_FIRST = 0xC0;
     const char DISPLAY_ON = 0x88;
 
-    static std::map<char, char> CHARS_TO_SIGNAL;
+    static constexpr size_t MAX_CACHED_WAVES = 16;
 
     void startTransmission();
     void stopTransmission();
     bool writeByte(char cByte);
-    char charToSignal(int pos, char ch);
+    bool writeFrame(const Frame& aFrame);
+    bool writeDigits(const Frame& aFrame);
+    bool writeDisplayControl();
+    bool transmitWave(const Frame& aFrame);
+    int compileWave(const Frame& aFrame);
+    void clearWaves();
+    int probe(const TM1637Timing& oTiming, int iFrames);
 
     int m_iIOPin;
     int m_iClkPin;
+    GpioBackend& m_oGpio;
     int m_iBrightness=7;
+    TM1637Timing m_oTiming;
     bool m_bPoints = false;
 
-    char m_data[5] {0,0,0,0, '\0'};
+    // Segments of the text, without the switchPoints() points
+    Frame m_aGlyphs {};
+
+    // Last frame and brightness the module ACKed
+    bool m_bSentValid = false;
+    Frame m_aSentFrame {};
+    int m_iSentBrightness = -1;
+    FrameStats m_oStats;
+
+    TransmitMode m_eTransmitMode = TRANSMIT_BITBANG;
+    // Wave ids keyed by the packed frame, oldest first in m_dWaveOrder
+    std::map<uint64_t, int> m_mWaves;
+    std::deque<uint64_t> m_dWaveOrder;
 
 };
 
+typedef BasicTM1637<4, ColonLayout> TM1637;
+typedef BasicTM1637<6, DecimalLayout> TM1637x6;
+
+extern template class BasicTM1637<4, ColonLayout>;
+extern template class BasicTM1637<6, DecimalLayout>;
+
 }
 
-#endif // TM1637_H_
\ No newline at end of file
+#endif // TM1637_H_
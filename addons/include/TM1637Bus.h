@@ -0,0 +1,104 @@
+#ifndef TM1637_BUS_H_
+#define TM1637_BUS_H_
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "GpioBackend.h"
+#include "SegmentFont.h"
+#include "TM1637.h"
+#include "TM1637Timing.h"
+
+namespace addons {
+
+// TM1637 modules sharing one CLK line, each on its own DIO. Every bit period
+// is written to all modules with bank writes and every ACK clock is sampled
+// for all of them with one bank read, so N modules refresh in the time of
+// one. Modules that are not sent to keep DIO high and ignore the clock.
+// All pins must be GPIO 0-31.
+template <size_t DIGITS, typename Layout>
+class BasicTM1637Bus {
+
+    static_assert(DIGITS >= 1 && DIGITS <= 6, "TM1637 drives up to 6 digits");
+
+public:
+    typedef std::array<uint8_t, DIGITS> Frame;
+
+    BasicTM1637Bus(int iClkPin, const std::vector<int>& vIOPins, GpioBackend& oGpio = GpioBackend::instance());
+    virtual ~BasicTM1637Bus();
+
+    // False if a pin is not in GPIO 0-31 or used twice, nothing is sent then.
+    bool valid() const;
+    size_t size() const;
+
+    // Staged per module, sent by the next display()
+    void setBrightness(size_t uiModule, int iBr);
+    void setFrame(size_t uiModule, const Frame& aGlyphs, bool bDots);
+    void setText(size_t uiModule, const std::string& sData, bool bDots);
+
+    // Sends every module whose frame or brightness changed, all at once, and
+    // retries the ones that missed an ACK. False if any of them failed.
+    bool display();
+    // Whether the module ACKed every byte of the last display() it was part of.
+    bool acked(size_t uiModule) const;
+
+    // Forget the latched frames, e.g. after the modules lost power.
+    void invalidate();
+
+    // Shared by all modules, slowed down like TM1637's on missed ACKs.
+    void setTiming(const TM1637Timing& oTiming);
+    const TM1637Timing& timing() const;
+
+private:
+    enum Command {
+        AUTO_ADDRESS_MODE  = 0x40,
+        ADDRESS_OF_FIRST   = 0xC0,
+        DISPLAY_ON         = 0x88,
+    };
+
+    struct Module {
+        uint32_t uiDio;  // bit of the DIO pin
+        Frame aGlyphs {};
+        bool bPoints = false;
+        int iBrightness = 7;
+
+        // Last frame and brightness the module ACKed
+        bool bSentValid = false;
+        Frame aSentFrame {};
+        int iSentBrightness = -1;
+        bool bAcked = true;
+
+        Frame frame() const;
+    };
+
+    // Bytes of a full transmission, per module: data command, address and
+    // digits, then display control, each command in its own start/stop group.
+    static constexpr size_t BYTES = DIGITS + 3;
+
+    // DIO masks of the modules to send digits and display control to,
+    // returns the ones that ACKed every byte they were sent.
+    uint32_t transmit(uint32_t uiFrames, uint32_t uiControls);
+    void startTransmission(uint32_t uiDios);
+    void stopTransmission(uint32_t uiDios);
+    uint32_t writeByte(uint32_t uiDios, size_t uiByte);
+    void setModes(uint32_t uiDios, unsigned uiMode);
+    uint8_t byteOf(const Module& oModule, size_t uiByte) const;
+
+    uint32_t m_uiClk = 0;
+    GpioBackend& m_oGpio;
+    bool m_bValid = true;
+    TM1637Timing m_oTiming;
+    std::vector<Module> m_vModules;
+};
+
+typedef BasicTM1637Bus<4, ColonLayout> TM1637Bus;
+typedef BasicTM1637Bus<6, DecimalLayout> TM1637x6Bus;
+
+extern template class BasicTM1637Bus<4, ColonLayout>;
+extern template class BasicTM1637Bus<6, DecimalLayout>;
+
+}
+
+#endif // TM1637_BUS_H_
@@ -0,0 +1,47 @@
+#ifndef TM1637_TIMING_H_
+#define TM1637_TIMING_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+
+namespace addons {
+
+// Delays of the TM1637 bit-banging in microseconds. The defaults are the
+// conservative datasheet-safe values every module copes with.
+struct TM1637Timing {
+    uint32_t uiEdgeUs = 10;      // setup and hold of start/stop conditions
+    uint32_t uiHalfBitUs = 50;   // each of the three phases of a bit clock
+    uint32_t uiAckPollUs = 20;   // between ACK samples
+    uint32_t uiAckPolls = 50;    // samples before a byte counts as not ACKed
+    uint32_t uiDigitGapUs = 20;  // after each digit of a frame
+
+    // Every delay doubled, none beyond the defaults. False if all are there.
+    bool slower(TM1637Timing& oSlower) const;
+    // Every delay scaled by uiFactor, none beyond the defaults.
+    TM1637Timing withMargin(uint32_t uiFactor) const;
+    // Bus time of a full frame of uiDigits with every byte ACKed at once.
+    uint32_t frameUs(size_t uiDigits) const;
+
+    bool operator==(const TM1637Timing& oOther) const;
+    bool operator!=(const TM1637Timing& oOther) const;
+};
+
+// Calibrated timings per CLK/DIO pin pair, one "CLK,DIO=edge,halfbit,ackpoll,
+// ackpolls,digitgap" line each.
+class TM1637TimingProfile {
+public:
+    bool load(const std::string& sPath);
+    bool save(const std::string& sPath) const;
+
+    bool find(int iClkPin, int iIOPin, TM1637Timing& oTiming) const;
+    void set(int iClkPin, int iIOPin, const TM1637Timing& oTiming);
+
+private:
+    std::map<std::pair<int, int>, TM1637Timing> m_mTimings;
+};
+
+}
+
+#endif  // TM1637_TIMING_H_
@@ -1,6 +1,5 @@
 #include "BoolReader.h"
 
-#include <pigpio.h>
 #include <string>
 #include <sys/syslog.h>
 
@@ -8,20 +7,84 @@
 
 using namespace addons;
 
-BoolReader::BoolReader(int iPin) : m_iPin(iPin) {}
+BoolReader::BoolReader(int iPin, GpioBackend& oGpio) : m_iPin(iPin), m_oGpio(oGpio) {}
 
-BoolReader::~BoolReader() {}
+BoolReader::~BoolReader() {
+    unwatch();
+}
 
 bool BoolReader::read(bool& bValue) {
+    int iLevel = m_iLevel.load(std::memory_order_acquire);
+    if (iLevel >= 0) {
+        bValue = iLevel;
+        return true;
+    }
+
     try {
-        gpioSetMode(m_iPin, PI_INPUT);
-        gpioDelay(10);
-        int iData =  gpioRead(m_iPin);
-        Logger::log(LOG_DEBUG, "BoolReader| Get data [" + std::to_string(iData) +"]");
+        // The pin only needs to settle after switching to input
+        if (!m_bInput) {
+            m_oGpio.setMode(m_iPin, GpioBackend::MODE_INPUT);
+            m_oGpio.delay(10);
+            m_bInput = true;
+        }
+        int iData =  m_oGpio.read(m_iPin);
+        LOGGER_LOG(LOG_DEBUG, "BoolReader| Get data [", iData, "]");
+        if (iData < 0) {
+            return false;
+        }
         bValue = iData;
     } catch (const std::exception& e) {
-        Logger::log(LOG_ERR, "BoolReader| Failed to get data from the sensor: [" + std::string(e.what()) + "]");
+        LOGGER_LOG(LOG_ERR, "BoolReader| Failed to get data from the sensor: [", e.what(), "]");
         return false;
     }
     return true;
-}
\ No newline at end of file
+}
+
+bool BoolReader::watch(uint32_t uiGlitchUs, ChangeFunc fChange, void* pUserData) {
+    unwatch();
+
+    bool bValue = false;
+    if (m_iPin < 0 || !read(bValue)) {
+        return false;
+    }
+    if (uiGlitchUs && m_oGpio.setGlitchFilter(m_iPin, uiGlitchUs) < 0) {
+        LOGGER_LOG(LOG_INFO, "BoolReader| No glitch filter in the [", m_oGpio.name(), "] backend");
+    }
+
+    m_fChange = fChange;
+    m_pChangeData = pUserData;
+    m_iLevel.store(bValue, std::memory_order_release);
+    if (m_oGpio.setAlertFunc(m_iPin, onAlert, this) < 0) {
+        LOGGER_LOG(LOG_WARNING, "BoolReader| Edge notification is not supported by the [",
+                   m_oGpio.name(), "] backend");
+        m_iLevel.store(-1, std::memory_order_release);
+        m_fChange = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void BoolReader::unwatch() {
+    if (!watching()) {
+        return;
+    }
+    m_oGpio.setAlertFunc(m_iPin, nullptr, nullptr);
+    m_oGpio.setGlitchFilter(m_iPin, 0);
+    m_iLevel.store(-1, std::memory_order_release);
+    m_fChange = nullptr;
+}
+
+bool BoolReader::watching() const {
+    return m_iLevel.load(std::memory_order_acquire) >= 0;
+}
+
+void BoolReader::onAlert(int /*iPin*/, int iLevel, uint32_t uiTick, void* pUserData) {
+    BoolReader& oReader = *static_cast<BoolReader*>(pUserData);
+    // Level 2 is a watchdog timeout, not a change
+    if (iLevel > 1 || oReader.m_iLevel.exchange(iLevel, std::memory_order_acq_rel) == iLevel) {
+        return;
+    }
+    if (oReader.m_fChange) {
+        oReader.m_fChange(iLevel, uiTick, oReader.m_pChangeData);
+    }
+}
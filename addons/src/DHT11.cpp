@@ -1,29 +1,55 @@
 #include "DHT11.h"
 #include <cstdint>
+#include <ctime>
 #include <exception>
-#include <pigpio.h>
 #include <stdexcept>
 #include <string>
 #include <sys/syslog.h>
 #include <unistd.h>
 
+#include "EdgeLog.h"
 #include "logger.h"
+#include "metrics.h"
 
-addons::DHT11::DHT11(int iPin) : m_iPin(iPin) {}
+namespace {
 
-addons::DHT11::~DHT11() {}
+metrics::Histogram g_oReadDuration("dht11_read_duration_seconds", "DHT11 read duration including the start pulse",
+                                   {0.07, 0.072, 0.074, 0.076, 0.08, 0.09, 0.1, 0.25, 1});
+
+metrics::Counter g_oReadsOk("dht11_reads_total", "DHT11 reads by outcome", "outcome=\"ok\"");
+metrics::Counter g_oReadsChecksum("dht11_reads_total", "DHT11 reads by outcome", "outcome=\"checksum\"");
+metrics::Counter g_oReadsInvalidPin("dht11_reads_total", "DHT11 reads by outcome", "outcome=\"invalid_pin\"");
+
+// Indexed by DHT11::Stage
+metrics::Counter g_aReadsTimeout[] = {
+    {"dht11_reads_total", "DHT11 reads by outcome", "outcome=\"timeout\",stage=\"response\""},
+    {"dht11_reads_total", "DHT11 reads by outcome", "outcome=\"timeout\",stage=\"response_low\""},
+    {"dht11_reads_total", "DHT11 reads by outcome", "outcome=\"timeout\",stage=\"response_high\""},
+    {"dht11_reads_total", "DHT11 reads by outcome", "outcome=\"timeout\",stage=\"bit_low\""},
+    {"dht11_reads_total", "DHT11 reads by outcome", "outcome=\"timeout\",stage=\"bit_high\""},
+    {"dht11_reads_total", "DHT11 reads by outcome", "outcome=\"timeout\",stage=\"end\""},
+};
+
+}
+
+addons::DHT11::DHT11(int iPin, GpioBackend& oGpio) : m_iPin(iPin), m_oGpio(oGpio) {}
+
+addons::DHT11::~DHT11() {
+    setCaptureMode(CAPTURE_POLL);
+}
 
 bool addons::DHT11::read(float& fTemp, float& fHum) {
-    Logger::log(LOG_DEBUG, "HDT11| Reading info from the gpio [" + 
-                                               std::to_string(m_iPin) + "]");
+    LOGGER_LOG(LOG_DEBUG, "HDT11| Reading info from the gpio [", m_iPin, "]");
 
     if (m_iPin < 0) {
-        Logger::log(LOG_ERR, "HDT11| Invalid GPIO pin [" + 
-                                                 std::to_string(m_iPin) + "]");
+        LOGGER_LOG(LOG_ERR, "HDT11| Invalid GPIO pin [", m_iPin, "]");
+        m_eLastStatus = STATUS_INVALID_PIN;
+        g_oReadsInvalidPin.inc();
         return false;
     }
 
     uint64_t data = 0;
+    uint32_t uiStartTick = m_oGpio.tick();
 
     // Send start signal
     sendRequest();
@@ -31,26 +57,97 @@ bool addons::DHT11::read(float& fTemp, float& fHum) {
     // Switch to input mode to read data
 
     try {
-        waitLow(420);
-        waitHigh(900);
-        waitLow(1000);
-        for (int i = 0; i < 40; ++i) {
-            data <<= 1;
-            int LowTime = waitHigh(1000);
-            int HighTime = waitLow(1000);
-            if (LowTime < HighTime) {
-                data |= 0x1;
-            }
+        if (m_eCaptureMode == CAPTURE_ALERT) {
+            data = captureAlert();
+        } else {
+            data = capturePoll();
         }
-        // end state
-        waitHigh(1000);
     } catch (const std::exception& e) {
-        gpioSetMode(m_iPin, PI_OUTPUT);
-        gpioWrite(m_iPin, 1);
-        Logger::log(LOG_ERR, "DHT11| Failed to get data from the sensor: [" + std::string(e.what()) + "]");
+        m_oGpio.setMode(m_iPin, GpioBackend::MODE_OUTPUT);
+        m_oGpio.write(m_iPin, 1);
+        LOGGER_LOG(LOG_ERR, "DHT11| Failed to get data from the sensor: [", e.what(), "]");
+        m_eLastStatus = STATUS_TIMEOUT;
+        g_oReadDuration.observe(static_cast<uint64_t>(m_oGpio.tick() - uiStartTick) * 1000);
+        g_aReadsTimeout[m_eStage].inc();
+        record();
         return false;
     }
+    g_oReadDuration.observe(static_cast<uint64_t>(m_oGpio.tick() - uiStartTick) * 1000);
+
+    m_eLastStatus = parseFrame(data, fTemp, fHum);
+    record();
+    if (m_eLastStatus != STATUS_OK) {
+        LOGGER_LOG(LOG_ERR, "DHT11| Failed to read data from sensor: incorrect checksum");
+        g_oReadsChecksum.inc();
+        return false;
+    }
+
+    g_oReadsOk.inc();
+
+    return true;
+}
+
+bool addons::DHT11::setCaptureMode(CaptureMode eMode) {
+    if (eMode == m_eCaptureMode) {
+        return true;
+    }
+
+    if (eMode == CAPTURE_ALERT) {
+        if (m_iPin < 0 || m_oGpio.setAlertFunc(m_iPin, onEdge, &m_oCapture) < 0) {
+            LOGGER_LOG(LOG_WARNING, "DHT11| Edge capture is not supported by the [",
+                       m_oGpio.name(), "] backend");
+            return false;
+        }
+    } else {
+        m_oGpio.setAlertFunc(m_iPin, nullptr, nullptr);
+    }
+
+    m_eCaptureMode = eMode;
+    return true;
+}
+
+addons::DHT11::Status addons::DHT11::lastStatus() const {
+    return m_eLastStatus;
+}
+
+addons::DHT11::CaptureMode addons::DHT11::captureMode() const {
+    return m_eCaptureMode;
+}
+
+void addons::DHT11::setEdgeLog(EdgeLogWriter* pLog) {
+    m_pEdgeLog = pLog;
+}
+
+uint32_t addons::DHT11::bitThreshold(uint32_t uiResponseUs) {
+    // Beyond half or twice the nominal timing the preamble is a glitch, not a
+    // slow clock: fall back to the datasheet midpoint
+    if (uiResponseUs < 80 || uiResponseUs > 320) {
+        return 48;
+    }
+    return uiResponseUs * 3 / 10;
+}
+
+uint64_t addons::DHT11::decodeEdges(const uint32_t* aTicks, int iCount, uint32_t uiThresholdUs) {
+    if (iCount < FRAME_EDGES) {
+        throw std::runtime_error("Short frame: " + std::to_string(iCount) + " of " +
+                                 std::to_string(FRAME_EDGES) + " edges");
+    }
+
+    if (uiThresholdUs == 0) {
+        uiThresholdUs = bitThreshold(aTicks[2] - aTicks[0]);
+    }
+
+    // Even indexes are falling edges. Bit i is LOW from 2i+2 to 2i+3, HIGH until 2i+4.
+    uint64_t data = 0;
+    for (int i = 0; i < 40; ++i) {
+        const uint32_t* pBit = aTicks + 2 * i + 3;
+        uint32_t uiHighTime = pBit[1] - pBit[0];
+        data = (data << 1) | (uiHighTime >= uiThresholdUs);
+    }
+    return data;
+}
 
+addons::DHT11::Status addons::DHT11::parseFrame(uint64_t data, float& fTemp, float& fHum) {
     uint8_t humHigh = (data >> 32) & 0xFF;
     uint8_t humLow = (data >> 24) & 0xFF;
     uint8_t tempHigh = (data >> 16) & 0xFF;
@@ -58,50 +155,157 @@ bool addons::DHT11::read(float& fTemp, float& fHum) {
     uint8_t checksum = data & 0xFF;
 
     if (checksum != static_cast<uint8_t> (humHigh + humLow + tempHigh + tempLow)) {
-        Logger::log(LOG_ERR, "DHT11| Failed to read data from sensor: incorrect checksum");
-        return false;
+        return STATUS_CHECKSUM;
     }
 
     fTemp = tempHigh;
     fHum = humHigh;
+    return STATUS_OK;
+}
 
-    return true;
+void addons::DHT11::countRead(Status eStatus, int iEdges, uint32_t uiDurationUs) {
+    g_oReadDuration.observe(static_cast<uint64_t>(uiDurationUs) * 1000);
+    switch (eStatus) {
+        case STATUS_OK:
+            g_oReadsOk.inc();
+            break;
+        case STATUS_CHECKSUM:
+            g_oReadsChecksum.inc();
+            break;
+        case STATUS_INVALID_PIN:
+            g_oReadsInvalidPin.inc();
+            break;
+        default:
+            g_aReadsTimeout[stageOf(iEdges)].inc();
+            break;
+    }
+}
+
+addons::DHT11::Stage addons::DHT11::stageOf(int iEdges) {
+    // Name the pulse of the first missing edge, as capturePoll would
+    if (iEdges < 3) {
+        return static_cast<Stage>(STAGE_RESPONSE + iEdges);
+    }
+    return (iEdges & 1) ? STAGE_BIT_LOW : STAGE_BIT_HIGH;
+}
+
+void addons::DHT11::onEdge(int /*iPin*/, int iLevel, uint32_t uiTick, void* pUserData) {
+    captureEdge(*static_cast<EdgeCapture*>(pUserData), iLevel, uiTick);
+}
+
+void addons::DHT11::captureEdge(EdgeCapture& oCapture, int iLevel, uint32_t uiTick) {
+    if (!oCapture.bArmed.load(std::memory_order_acquire) || iLevel > 1) {
+        return;
+    }
+
+    int iCount = oCapture.iCount.load(std::memory_order_relaxed);
+    // Alerts may be delivered late: skip edges from before the line was released
+    // and the release itself, the frame starts with the sensor pulling LOW.
+    if (static_cast<int32_t>(uiTick - oCapture.uiArmTick) < 0 || (iCount == 0 && iLevel)) {
+        return;
+    }
+    if (iCount >= FRAME_EDGES || iLevel != (iCount & 1)) {
+        return;
+    }
+
+    oCapture.aTicks[iCount] = uiTick;
+    oCapture.iCount.store(iCount + 1, std::memory_order_release);
+}
+
+uint64_t addons::DHT11::capturePoll() {
+    uint64_t data = 0;
+
+    m_eStage = STAGE_RESPONSE;
+    waitLow(420);
+    m_eStage = STAGE_RESPONSE_LOW;
+    int ResponseTime = waitHigh(900);
+    m_eStage = STAGE_RESPONSE_HIGH;
+    ResponseTime += waitLow(1000);
+    int Threshold = bitThreshold(ResponseTime);
+    for (int i = 0; i < 40; ++i) {
+        data <<= 1;
+        m_eStage = STAGE_BIT_LOW;
+        waitHigh(1000);
+        m_eStage = STAGE_BIT_HIGH;
+        int HighTime = waitLow(1000);
+        if (HighTime >= Threshold) {
+            data |= 0x1;
+        }
+    }
+    // end state
+    m_eStage = STAGE_END;
+    waitHigh(1000);
+
+    return data;
+}
+
+uint64_t addons::DHT11::captureAlert() {
+    // A full frame of ones lasts ~5.1 ms; sleep instead of polling the line
+    for (int i = 0; i < 10; ++i) {
+        m_oGpio.delay(1000);
+        if (m_oCapture.iCount.load(std::memory_order_acquire) >= FRAME_EDGES) {
+            break;
+        }
+    }
+    m_oCapture.bArmed.store(false, std::memory_order_release);
+
+    int iCount = m_oCapture.iCount.load(std::memory_order_acquire);
+    m_eStage = stageOf(iCount);
+
+    return decodeEdges(m_oCapture.aTicks, iCount);
 }
 
 int addons::DHT11::waitLow(uint32_t uiTimeoutMs) {
-    auto StartTime = gpioTick();
-    while (gpioRead(m_iPin)) {
-        if (uiTimeoutMs < gpioTick() - StartTime) {
+    auto StartTime = m_oGpio.tick();
+    while (m_oGpio.read(m_iPin)) {
+        if (uiTimeoutMs < m_oGpio.tick() - StartTime) {
             throw std::runtime_error("Time out waiting for LOW: " + std::to_string(uiTimeoutMs));
         }
     }
-    return gpioTick() - StartTime;
+    return m_oGpio.tick() - StartTime;
 }
 
 int addons::DHT11::waitHigh(uint32_t uiTimeoutMs) {
-    auto StartTime = gpioTick();
-    while (!gpioRead(m_iPin)) {
-        if (uiTimeoutMs < gpioTick() - StartTime) {
+    auto StartTime = m_oGpio.tick();
+    while (!m_oGpio.read(m_iPin)) {
+        if (uiTimeoutMs < m_oGpio.tick() - StartTime) {
             throw std::runtime_error("Time out waiting for HIGH: " + std::to_string(uiTimeoutMs));
         }
     }
-    return gpioTick() - StartTime;
+    return m_oGpio.tick() - StartTime;
+}
+
+void addons::DHT11::record() {
+    // Polled frames leave no timestamps behind
+    if (!m_pEdgeLog || m_eCaptureMode != CAPTURE_ALERT) {
+        return;
+    }
+    m_pEdgeLog->append(std::time(nullptr), m_iPin, m_eLastStatus, m_oCapture.aTicks,
+                       m_oCapture.iCount.load(std::memory_order_acquire));
 }
 
 bool addons::DHT11::sendRequest() {
+    GpioBackend::Batch oBatch(m_oGpio);
+
     // Ensure line is HIGH under pull-up
-    gpioSetMode(m_iPin, PI_OUTPUT);
-    gpioWrite(m_iPin, 1);
-    gpioDelay(50000);
+    m_oGpio.setMode(m_iPin, GpioBackend::MODE_OUTPUT);
+    m_oGpio.write(m_iPin, 1);
+    m_oGpio.delay(50000);
 
     // Send start pulse (18 ms LOW)
-    gpioWrite(m_iPin, 0);
-    gpioDelay(18000);
+    m_oGpio.write(m_iPin, 0);
+    m_oGpio.delay(18000);
+
+    if (m_eCaptureMode == CAPTURE_ALERT) {
+        m_oCapture.iCount.store(0, std::memory_order_relaxed);
+        m_oCapture.uiArmTick = m_oGpio.tick();
+        m_oCapture.bArmed.store(true, std::memory_order_release);
+    }
 
     // Release line, switch to input with pull-up
-    gpioWrite(m_iPin, 1);
-    gpioSetMode(m_iPin, PI_INPUT);
-    gpioSetPullUpDown(m_iPin, PI_PUD_UP);
+    m_oGpio.write(m_iPin, 1);
+    m_oGpio.setMode(m_iPin, GpioBackend::MODE_INPUT);
+    m_oGpio.setPullUpDown(m_iPin, GpioBackend::PUD_UP);
 
     return true;
 }
@@ -0,0 +1,183 @@
+#include "DHT11Array.h"
+
+#include <ctime>
+#include <exception>
+#include <sys/syslog.h>
+
+#include "EdgeLog.h"
+#include "logger.h"
+
+addons::DHT11Array::DHT11Array(const std::vector<int>& vPins, GpioBackend& oGpio)
+    : m_vPins(vPins), m_oGpio(oGpio), m_pCaptures(new DHT11::EdgeCapture[vPins.size()]) {
+    m_aSlots.fill(-1);
+
+    m_bAlert = true;
+    for (size_t i = 0; i < m_vPins.size(); ++i) {
+        int iPin = m_vPins[i];
+        if (iPin < 0 || iPin >= static_cast<int>(MAX_PIN) || m_aSlots[iPin] >= 0) {
+            LOGGER_LOG(LOG_ERR, "DHT11Array| Invalid or duplicate GPIO pin [", iPin, "]");
+            continue;
+        }
+        m_aSlots[iPin] = i;
+        if (m_oGpio.setAlertFunc(iPin, onEdge, this) < 0) {
+            m_bAlert = false;
+        }
+    }
+
+    if (!m_bAlert) {
+        LOGGER_LOG(LOG_WARNING, "DHT11Array| Edge capture is not supported by the [",
+                   m_oGpio.name(), "] backend, sensors are polled one by one");
+        for (int iPin : m_vPins) {
+            if (iPin >= 0 && iPin < static_cast<int>(MAX_PIN)) {
+                m_oGpio.setAlertFunc(iPin, nullptr, nullptr);
+            }
+            m_vFallback.emplace_back(new DHT11(iPin, m_oGpio));
+        }
+    }
+}
+
+addons::DHT11Array::~DHT11Array() {
+    if (m_bAlert) {
+        for (size_t uiPin = 0; uiPin < MAX_PIN; ++uiPin) {
+            if (m_aSlots[uiPin] >= 0) {
+                m_oGpio.setAlertFunc(uiPin, nullptr, nullptr);
+            }
+        }
+    }
+}
+
+size_t addons::DHT11Array::size() const {
+    return m_vPins.size();
+}
+
+size_t addons::DHT11Array::read(std::vector<Reading>& vReadings) {
+    vReadings.resize(m_vPins.size());
+    for (size_t i = 0; i < m_vPins.size(); ++i) {
+        vReadings[i] = Reading{m_vPins[i], DHT11::STATUS_INVALID_PIN, 0, 0};
+    }
+
+    if (!m_bAlert) {
+        return readSequential(vReadings);
+    }
+
+    uint32_t uiStartTick = m_oGpio.tick();
+    captureAll();
+    uint32_t uiDurationUs = m_oGpio.tick() - uiStartTick;
+    uint32_t uiTime = std::time(nullptr);
+
+    size_t uiOk = 0;
+    for (size_t i = 0; i < m_vPins.size(); ++i) {
+        Reading& oReading = vReadings[i];
+        if (oReading.iPin < 0 || oReading.iPin >= static_cast<int>(MAX_PIN) ||
+            m_aSlots[oReading.iPin] != static_cast<int>(i)) {
+            continue;
+        }
+
+        const DHT11::EdgeCapture& oCapture = m_pCaptures[i];
+        int iEdges = oCapture.iCount.load(std::memory_order_acquire);
+        try {
+            uint64_t data = DHT11::decodeEdges(oCapture.aTicks, iEdges);
+            oReading.eStatus = DHT11::parseFrame(data, oReading.fTemp, oReading.fHum);
+        } catch (const std::exception& e) {
+            LOGGER_LOG(LOG_ERR, "DHT11Array| Failed to get data from the gpio [", oReading.iPin, "]: [",
+                       e.what(), "]");
+            oReading.eStatus = DHT11::STATUS_TIMEOUT;
+        }
+        DHT11::countRead(oReading.eStatus, iEdges, uiDurationUs);
+        if (m_pEdgeLog) {
+            m_pEdgeLog->append(uiTime, oReading.iPin, oReading.eStatus, oCapture.aTicks, iEdges);
+        }
+
+        if (oReading.eStatus == DHT11::STATUS_OK) {
+            ++uiOk;
+        } else if (oReading.eStatus == DHT11::STATUS_CHECKSUM) {
+            LOGGER_LOG(LOG_ERR, "DHT11Array| Incorrect checksum from the gpio [", oReading.iPin, "]");
+        }
+    }
+
+    return uiOk;
+}
+
+void addons::DHT11Array::setEdgeLog(EdgeLogWriter* pLog) {
+    m_pEdgeLog = pLog;
+    for (auto& pSensor : m_vFallback) {
+        pSensor->setEdgeLog(pLog);
+    }
+}
+
+void addons::DHT11Array::onEdge(int iPin, int iLevel, uint32_t uiTick, void* pUserData) {
+    DHT11Array& oArray = *static_cast<DHT11Array*>(pUserData);
+    if (iPin < 0 || iPin >= static_cast<int>(MAX_PIN) || oArray.m_aSlots[iPin] < 0) {
+        return;
+    }
+    DHT11::captureEdge(oArray.m_pCaptures[oArray.m_aSlots[iPin]], iLevel, uiTick);
+}
+
+void addons::DHT11Array::captureAll() {
+    std::vector<int> vPins;
+    for (size_t uiPin = 0; uiPin < MAX_PIN; ++uiPin) {
+        if (m_aSlots[uiPin] >= 0) {
+            vPins.push_back(uiPin);
+        }
+    }
+
+    {
+        GpioBackend::Batch oBatch(m_oGpio);
+
+        // Ensure lines are HIGH under pull-up
+        for (int iPin : vPins) {
+            m_oGpio.setMode(iPin, GpioBackend::MODE_OUTPUT);
+            m_oGpio.write(iPin, 1);
+        }
+        m_oGpio.delay(50000);
+
+        // Start pulses overlap, each line stays LOW for at least 18 ms
+        for (int iPin : vPins) {
+            m_oGpio.write(iPin, 0);
+        }
+        m_oGpio.delay(18000);
+
+        // Staggered releases keep the frames' edges apart
+        for (size_t i = 0; i < vPins.size(); ++i) {
+            DHT11::EdgeCapture& oCapture = m_pCaptures[m_aSlots[vPins[i]]];
+            oCapture.iCount.store(0, std::memory_order_relaxed);
+            oCapture.uiArmTick = m_oGpio.tick();
+            oCapture.bArmed.store(true, std::memory_order_release);
+
+            m_oGpio.write(vPins[i], 1);
+            m_oGpio.setMode(vPins[i], GpioBackend::MODE_INPUT);
+            m_oGpio.setPullUpDown(vPins[i], GpioBackend::PUD_UP);
+            if (i + 1 < vPins.size()) {
+                m_oGpio.delay(STAGGER_US);
+            }
+        }
+    }
+
+    // A full frame of ones lasts ~5.1 ms after the last release
+    for (int i = 0; i < 10; ++i) {
+        m_oGpio.delay(1000);
+        bool bDone = true;
+        for (int iPin : vPins) {
+            bDone &= m_pCaptures[m_aSlots[iPin]].iCount.load(std::memory_order_acquire) >= DHT11::FRAME_EDGES;
+        }
+        if (bDone) {
+            break;
+        }
+    }
+
+    for (int iPin : vPins) {
+        m_pCaptures[m_aSlots[iPin]].bArmed.store(false, std::memory_order_release);
+    }
+}
+
+size_t addons::DHT11Array::readSequential(std::vector<Reading>& vReadings) {
+    size_t uiOk = 0;
+    for (size_t i = 0; i < m_vFallback.size(); ++i) {
+        Reading& oReading = vReadings[i];
+        if (m_vFallback[i]->read(oReading.fTemp, oReading.fHum)) {
+            ++uiOk;
+        }
+        oReading.eStatus = m_vFallback[i]->lastStatus();
+    }
+    return uiOk;
+}
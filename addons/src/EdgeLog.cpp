@@ -0,0 +1,184 @@
+#include "EdgeLog.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syslog.h>
+#include <unistd.h>
+
+#include "logger.h"
+
+namespace {
+
+const char MAGIC[8] = {'T', 'H', 'C', 'E', 'D', 'G', 'E', '1'};
+
+size_t putVarint(uint8_t* pOut, uint32_t uiValue) {
+    size_t uiLen = 0;
+    while (uiValue >= 0x80) {
+        pOut[uiLen++] = static_cast<uint8_t>(uiValue | 0x80);
+        uiValue >>= 7;
+    }
+    pOut[uiLen++] = static_cast<uint8_t>(uiValue);
+    return uiLen;
+}
+
+}
+
+addons::EdgeLogWriter::EdgeLogWriter() {}
+
+addons::EdgeLogWriter::~EdgeLogWriter() {
+    close();
+}
+
+bool addons::EdgeLogWriter::open(const std::string& sPath) {
+    close();
+
+    m_pFile = std::fopen(sPath.c_str(), "ab");
+    if (!m_pFile) {
+        LOGGER_LOG(LOG_ERR, "EdgeLog| Failed to open [", sPath, "]: ", std::strerror(errno));
+        return false;
+    }
+    if (std::ftell(m_pFile) == 0) {
+        std::fwrite(MAGIC, sizeof(MAGIC), 1, m_pFile);
+    }
+    return true;
+}
+
+void addons::EdgeLogWriter::close() {
+    if (m_pFile) {
+        std::fclose(m_pFile);
+        m_pFile = nullptr;
+    }
+}
+
+bool addons::EdgeLogWriter::isOpen() const {
+    return m_pFile != nullptr;
+}
+
+bool addons::EdgeLogWriter::append(uint32_t uiTime, int iPin, DHT11::Status eStatus,
+                                     const uint32_t* aTicks, int iCount) {
+    if (!m_pFile) {
+        return false;
+    }
+
+    iCount = std::max(0, std::min(iCount, static_cast<int>(DHT11::FRAME_EDGES)));
+    uint8_t aBuf[5 * (4 + DHT11::FRAME_EDGES)];
+    size_t uiLen = 0;
+    uiLen += putVarint(aBuf + uiLen, uiTime);
+    uiLen += putVarint(aBuf + uiLen, static_cast<uint32_t>(iPin));
+    uiLen += putVarint(aBuf + uiLen, eStatus);
+    uiLen += putVarint(aBuf + uiLen, iCount);
+    for (int i = 0; i < iCount; ++i) {
+        uiLen += putVarint(aBuf + uiLen, i ? aTicks[i] - aTicks[i - 1] : aTicks[0]);
+    }
+
+    // One frame every few seconds: flushing keeps the log whole across a crash
+    bool bRes = std::fwrite(aBuf, uiLen, 1, m_pFile) == 1;
+    return std::fflush(m_pFile) == 0 && bRes;
+}
+
+addons::EdgeLogReader::EdgeLogReader() {}
+
+addons::EdgeLogReader::~EdgeLogReader() {
+    close();
+}
+
+bool addons::EdgeLogReader::open(const std::string& sPath) {
+    close();
+
+    int iFd = ::open(sPath.c_str(), O_RDONLY);
+    if (iFd < 0) {
+        LOGGER_LOG(LOG_ERR, "EdgeLog| Failed to open [", sPath, "]: ", std::strerror(errno));
+        return false;
+    }
+
+    struct stat oStat;
+    if (fstat(iFd, &oStat) < 0 || oStat.st_size < static_cast<off_t>(sizeof(MAGIC))) {
+        LOGGER_LOG(LOG_ERR, "EdgeLog| Not an edge log: [", sPath, "]");
+        ::close(iFd);
+        return false;
+    }
+
+    m_uiSize = oStat.st_size;
+    m_pMap = mmap(nullptr, m_uiSize, PROT_READ, MAP_PRIVATE, iFd, 0);
+    ::close(iFd);
+    if (m_pMap == MAP_FAILED) {
+        m_pMap = nullptr;
+        LOGGER_LOG(LOG_ERR, "EdgeLog| Failed to map [", sPath, "]: ", std::strerror(errno));
+        return false;
+    }
+    madvise(m_pMap, m_uiSize, MADV_SEQUENTIAL);
+
+    if (std::memcmp(m_pMap, MAGIC, sizeof(MAGIC)) != 0) {
+        LOGGER_LOG(LOG_ERR, "EdgeLog| Not an edge log: [", sPath, "]");
+        close();
+        return false;
+    }
+    rewind();
+    return true;
+}
+
+void addons::EdgeLogReader::rewind() {
+    if (m_pMap) {
+        m_pPos = static_cast<const uint8_t*>(m_pMap) + sizeof(MAGIC);
+        m_pEnd = static_cast<const uint8_t*>(m_pMap) + m_uiSize;
+    }
+}
+
+void addons::EdgeLogReader::close() {
+    if (m_pMap) {
+        munmap(m_pMap, m_uiSize);
+        m_pMap = nullptr;
+    }
+    m_uiSize = 0;
+    m_pPos = m_pEnd = nullptr;
+}
+
+bool addons::EdgeLogReader::next(EdgeFrame& oFrame) {
+    uint32_t uiPin = 0;
+    uint32_t uiStatus = 0;
+    uint32_t uiCount = 0;
+    if (!varint(oFrame.uiTime) || !varint(uiPin) || !varint(uiStatus) || !varint(uiCount) ||
+        uiCount > DHT11::FRAME_EDGES) {
+        return false;
+    }
+    oFrame.iPin = static_cast<int>(uiPin);
+    oFrame.eStatus = static_cast<DHT11::Status>(uiStatus);
+    oFrame.iCount = uiCount;
+
+    uint32_t uiTick = 0;
+    for (uint32_t i = 0; i < uiCount; ++i) {
+        uint32_t uiDelta;
+        if (!varint(uiDelta)) {
+            return false;
+        }
+        uiTick += uiDelta;
+        oFrame.aTicks[i] = uiTick;
+    }
+    return true;
+}
+
+size_t addons::EdgeLogReader::size() const {
+    return m_uiSize;
+}
+
+bool addons::EdgeLogReader::varint(uint32_t& uiValue) {
+    // Deltas are below 128 us, so nearly every value is a single byte
+    if (m_pPos < m_pEnd && *m_pPos < 0x80) {
+        uiValue = *m_pPos++;
+        return true;
+    }
+
+    uiValue = 0;
+    for (int iShift = 0; iShift < 35 && m_pPos < m_pEnd; iShift += 7) {
+        uint8_t uiByte = *m_pPos++;
+        uiValue |= static_cast<uint32_t>(uiByte & 0x7F) << iShift;
+        if (!(uiByte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
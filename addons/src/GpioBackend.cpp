@@ -0,0 +1,110 @@
+#include "GpioBackend.h"
+
+#include <stdexcept>
+
+#include "PigpiodBackend.h"
+#include "SimGpioBackend.h"
+#ifdef HAVE_PIGPIO
+#include "PigpioBackend.h"
+#endif
+
+addons::GpioBackend* addons::GpioBackend::s_pInstance = nullptr;
+
+addons::GpioBackend::~GpioBackend() {}
+
+uint32_t addons::GpioBackend::readBank() {
+    uint32_t uiLevels = 0;
+    for (unsigned uiPin = 0; uiPin < 32; ++uiPin) {
+        uiLevels |= (read(uiPin) > 0 ? 1u : 0u) << uiPin;
+    }
+    return uiLevels;
+}
+
+int addons::GpioBackend::writeBank(uint32_t uiSet, uint32_t uiClear) {
+    int iRes = 0;
+    for (unsigned uiPin = 0; uiPin < 32; ++uiPin) {
+        if (uiSet & (1u << uiPin)) {
+            iRes |= write(uiPin, 1);
+        }
+    }
+    for (unsigned uiPin = 0; uiPin < 32; ++uiPin) {
+        if (uiClear & (1u << uiPin)) {
+            iRes |= write(uiPin, 0);
+        }
+    }
+    return iRes < 0 ? -1 : 0;
+}
+
+int addons::GpioBackend::setAlertFunc(unsigned /*uiPin*/, AlertFunc /*fAlert*/, void* /*pUserData*/) {
+    return -1;
+}
+
+int addons::GpioBackend::setGlitchFilter(unsigned /*uiPin*/, uint32_t /*uiSteadyUs*/) {
+    return -1;
+}
+
+bool addons::GpioBackend::supportsWaves() const {
+    return false;
+}
+
+int addons::GpioBackend::waveCreate(const std::vector<Pulse>& /*vPulses*/) {
+    return -1;
+}
+
+int addons::GpioBackend::waveSend(unsigned /*uiWaveId*/) {
+    return -1;
+}
+
+bool addons::GpioBackend::waveBusy() {
+    return false;
+}
+
+int addons::GpioBackend::waveDelete(unsigned /*uiWaveId*/) {
+    return -1;
+}
+
+void addons::GpioBackend::beginBatch() {}
+
+void addons::GpioBackend::endBatch() {}
+
+addons::GpioBackend::Batch::Batch(GpioBackend& oGpio) : m_oGpio(oGpio) {
+    m_oGpio.beginBatch();
+}
+
+addons::GpioBackend::Batch::~Batch() {
+    m_oGpio.endBatch();
+}
+
+std::unique_ptr<addons::GpioBackend> addons::GpioBackend::create(const std::string& sName) {
+#ifdef HAVE_PIGPIO
+    if (sName == "pigpio") {
+        return std::make_unique<PigpioBackend>();
+    }
+#endif
+    if (sName == "pigpiod") {
+        return std::make_unique<PigpiodBackend>();
+    }
+    if (sName == "sim") {
+        return std::make_unique<SimGpioBackend>();
+    }
+    return nullptr;
+}
+
+const char* addons::GpioBackend::defaultName() {
+#ifdef HAVE_PIGPIO
+    return "pigpio";
+#else
+    return "sim";
+#endif
+}
+
+void addons::GpioBackend::setInstance(GpioBackend* pBackend) {
+    s_pInstance = pBackend;
+}
+
+addons::GpioBackend& addons::GpioBackend::instance() {
+    if (!s_pInstance) {
+        throw std::logic_error("GPIO backend is not set");
+    }
+    return *s_pInstance;
+}
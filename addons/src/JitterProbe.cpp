@@ -0,0 +1,44 @@
+#include "JitterProbe.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+
+addons::JitterProbe::JitterProbe(GpioBackend& oGpio) : m_oGpio(oGpio) {}
+
+std::vector<addons::JitterProbe::Result> addons::JitterProbe::run(const std::vector<uint32_t>& vRequestedUs,
+                                                                  int iSamples) {
+    std::vector<Result> vResults;
+    std::vector<double> vOvershoot(std::max(iSamples, 1));
+
+    for (uint32_t uiRequested : vRequestedUs) {
+        for (double& dOvershoot : vOvershoot) {
+            auto oStart = std::chrono::steady_clock::now();
+            m_oGpio.delay(uiRequested);
+            auto oEnd = std::chrono::steady_clock::now();
+            dOvershoot = std::chrono::duration<double, std::micro>(oEnd - oStart).count() - uiRequested;
+        }
+
+        std::sort(vOvershoot.begin(), vOvershoot.end());
+        auto quantile = [&](double dQ) {
+            return vOvershoot[static_cast<size_t>(dQ * (vOvershoot.size() - 1))];
+        };
+        vResults.push_back(Result{uiRequested, static_cast<int>(vOvershoot.size()), vOvershoot.front(),
+                                  quantile(0.5), quantile(0.99), quantile(0.999), vOvershoot.back()});
+    }
+
+    return vResults;
+}
+
+void addons::JitterProbe::print(std::ostream& oOut, const std::vector<Result>& vResults) {
+    oOut << "Overshoot of delay() in us (actual - requested)\n"
+         << std::setw(10) << "requested" << std::setw(9) << "samples"
+         << std::setw(10) << "min" << std::setw(10) << "median" << std::setw(10) << "p99"
+         << std::setw(10) << "p99.9" << std::setw(10) << "max" << "\n";
+    oOut << std::fixed << std::setprecision(1);
+    for (const Result& oResult : vResults) {
+        oOut << std::setw(10) << oResult.uiRequestedUs << std::setw(9) << oResult.iSamples
+             << std::setw(10) << oResult.dMin << std::setw(10) << oResult.dMedian << std::setw(10) << oResult.dP99
+             << std::setw(10) << oResult.dP999 << std::setw(10) << oResult.dMax << "\n";
+    }
+}
@@ -0,0 +1,104 @@
+#include "PigpioBackend.h"
+
+#include <pigpio.h>
+
+addons::PigpioBackend::PigpioBackend() {}
+
+addons::PigpioBackend::~PigpioBackend() {
+    terminate();
+}
+
+const char* addons::PigpioBackend::name() const {
+    return "pigpio";
+}
+
+int addons::PigpioBackend::initialise() {
+    int iRes = gpioInitialise();
+    m_bInitialised = iRes >= 0;
+    return iRes;
+}
+
+void addons::PigpioBackend::terminate() {
+    if (m_bInitialised) {
+        gpioTerminate();
+        m_bInitialised = false;
+    }
+}
+
+int addons::PigpioBackend::setMode(unsigned uiPin, unsigned uiMode) {
+    return gpioSetMode(uiPin, uiMode);
+}
+
+int addons::PigpioBackend::setPullUpDown(unsigned uiPin, unsigned uiPud) {
+    return gpioSetPullUpDown(uiPin, uiPud);
+}
+
+int addons::PigpioBackend::read(unsigned uiPin) {
+    return gpioRead(uiPin);
+}
+
+int addons::PigpioBackend::write(unsigned uiPin, unsigned uiLevel) {
+    return gpioWrite(uiPin, uiLevel);
+}
+
+uint32_t addons::PigpioBackend::readBank() {
+    return gpioRead_Bits_0_31();
+}
+
+int addons::PigpioBackend::writeBank(uint32_t uiSet, uint32_t uiClear) {
+    int iRes = 0;
+    if (uiSet) {
+        iRes |= gpioWrite_Bits_0_31_Set(uiSet);
+    }
+    if (uiClear) {
+        iRes |= gpioWrite_Bits_0_31_Clear(uiClear);
+    }
+    return iRes < 0 ? -1 : 0;
+}
+
+uint32_t addons::PigpioBackend::tick() {
+    return gpioTick();
+}
+
+uint32_t addons::PigpioBackend::delay(uint32_t uiMicros) {
+    return gpioDelay(uiMicros);
+}
+
+int addons::PigpioBackend::setAlertFunc(unsigned uiPin, AlertFunc fAlert, void* pUserData) {
+    return gpioSetAlertFuncEx(uiPin, fAlert, pUserData);
+}
+
+int addons::PigpioBackend::setGlitchFilter(unsigned uiPin, uint32_t uiSteadyUs) {
+    return gpioGlitchFilter(uiPin, uiSteadyUs);
+}
+
+bool addons::PigpioBackend::supportsWaves() const {
+    return true;
+}
+
+int addons::PigpioBackend::waveCreate(const std::vector<Pulse>& vPulses) {
+    std::vector<gpioPulse_t> vRaw(vPulses.size());
+    for (size_t i = 0; i < vPulses.size(); ++i) {
+        vRaw[i].gpioOn = vPulses[i].uiOn;
+        vRaw[i].gpioOff = vPulses[i].uiOff;
+        vRaw[i].usDelay = vPulses[i].uiDelayUs;
+    }
+
+    gpioWaveAddNew();
+    if (gpioWaveAddGeneric(vRaw.size(), vRaw.data()) < 0) {
+        return -1;
+    }
+    return gpioWaveCreate();
+}
+
+int addons::PigpioBackend::waveSend(unsigned uiWaveId) {
+    return gpioWaveTxSend(uiWaveId, PI_WAVE_MODE_ONE_SHOT);
+}
+
+bool addons::PigpioBackend::waveBusy() {
+    return gpioWaveTxBusy() == 1;
+}
+
+int addons::PigpioBackend::waveDelete(unsigned uiWaveId) {
+    return gpioWaveDelete(uiWaveId);
+}
@@ -0,0 +1,434 @@
+#include "PigpiodBackend.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/syslog.h>
+#include <unistd.h>
+
+#include "logger.h"
+#include "metrics.h"
+
+namespace {
+
+metrics::Counter g_oRequests("pigpiod_requests_total", "Requests sent to pigpiod, a batch counts once");
+metrics::Counter g_oCommands("pigpiod_commands_total", "Commands sent to pigpiod");
+metrics::Counter g_oErrors("pigpiod_command_errors_total", "pigpiod commands that returned an error");
+
+bool sendAll(int iFd, const void* pData, size_t uiLength) {
+    const char* pPos = static_cast<const char*>(pData);
+    while (uiLength > 0) {
+        ssize_t iSent = ::send(iFd, pPos, uiLength, MSG_NOSIGNAL);
+        if (iSent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (iSent <= 0) {
+            return false;
+        }
+        pPos += iSent;
+        uiLength -= iSent;
+    }
+    return true;
+}
+
+bool recvAll(int iFd, void* pData, size_t uiLength) {
+    char* pPos = static_cast<char*>(pData);
+    while (uiLength > 0) {
+        ssize_t iRead = ::recv(iFd, pPos, uiLength, 0);
+        if (iRead < 0 && errno == EINTR) {
+            continue;
+        }
+        if (iRead <= 0) {
+            return false;
+        }
+        pPos += iRead;
+        uiLength -= iRead;
+    }
+    return true;
+}
+
+}
+
+addons::PigpiodBackend::PigpiodBackend(const std::string& sHost, uint16_t uiPort)
+    : m_sHost(sHost), m_uiPort(uiPort) {
+    if (m_sHost.empty()) {
+        const char* pAddr = std::getenv("PIGPIO_ADDR");
+        m_sHost = pAddr && *pAddr ? pAddr : "localhost";
+    }
+    if (m_uiPort == 0) {
+        const char* pPort = std::getenv("PIGPIO_PORT");
+        m_uiPort = pPort && *pPort ? std::atoi(pPort) : pigpiod::DEFAULT_PORT;
+    }
+}
+
+addons::PigpiodBackend::~PigpiodBackend() {
+    terminate();
+}
+
+const char* addons::PigpiodBackend::name() const {
+    return "pigpiod";
+}
+
+int addons::PigpiodBackend::initialise() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_iCmdFd = connectDaemon();
+        if (m_iCmdFd < 0) {
+            return -1;
+        }
+    }
+
+    int iRevision = command(pigpiod::CMD_HWVER);
+    LOGGER_LOG(LOG_INFO, "PigpiodBackend| Connected to pigpiod at [", m_sHost, ":", m_uiPort,
+               "], hardware revision [", iRevision, "]");
+
+    // Started here, before the caller may switch to SCHED_FIFO, so the
+    // notification thread keeps the default scheduling
+    if (openNotifications() < 0) {
+        LOGGER_LOG(LOG_WARNING, "PigpiodBackend| Alerts are unavailable");
+    }
+    return 0;
+}
+
+void addons::PigpiodBackend::terminate() {
+    int iHandle = -1;
+    int iNotifyFd = -1;
+    {
+        // After any updateNotifications() under way
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::lock_guard<std::mutex> alertLock(m_alertMutex);
+        iHandle = m_iNotifyHandle;
+        iNotifyFd = m_iNotifyFd;
+        m_iNotifyHandle = -1;
+        m_iNotifyFd = -1;
+        m_uiAlertMask = 0;
+    }
+    if (iHandle >= 0) {
+        command(pigpiod::CMD_NC, iHandle);
+    }
+    if (iNotifyFd >= 0) {
+        // Wakes the notification thread up
+        ::shutdown(iNotifyFd, SHUT_RDWR);
+    }
+    if (m_notifyThread.joinable()) {
+        m_notifyThread.join();
+    }
+    if (iNotifyFd >= 0) {
+        ::close(iNotifyFd);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_iCmdFd >= 0) {
+        flush();
+        ::close(m_iCmdFd);
+        m_iCmdFd = -1;
+    }
+}
+
+int addons::PigpiodBackend::setMode(unsigned uiPin, unsigned uiMode) {
+    return submit(pigpiod::CMD_MODES, uiPin, uiMode);
+}
+
+int addons::PigpiodBackend::setPullUpDown(unsigned uiPin, unsigned uiPud) {
+    return submit(pigpiod::CMD_PUD, uiPin, uiPud);
+}
+
+int addons::PigpiodBackend::read(unsigned uiPin) {
+    return command(pigpiod::CMD_READ, uiPin);
+}
+
+int addons::PigpiodBackend::write(unsigned uiPin, unsigned uiLevel) {
+    return submit(pigpiod::CMD_WRITE, uiPin, uiLevel);
+}
+
+uint32_t addons::PigpiodBackend::readBank() {
+    return static_cast<uint32_t>(command(pigpiod::CMD_BR1));
+}
+
+int addons::PigpiodBackend::writeBank(uint32_t uiSet, uint32_t uiClear) {
+    int iRes = 0;
+    if (uiSet) {
+        iRes |= submit(pigpiod::CMD_BS1, uiSet, 0);
+    }
+    if (uiClear) {
+        iRes |= submit(pigpiod::CMD_BC1, uiClear, 0);
+    }
+    return iRes < 0 ? -1 : 0;
+}
+
+uint32_t addons::PigpiodBackend::tick() {
+    return static_cast<uint32_t>(command(pigpiod::CMD_TICK));
+}
+
+uint32_t addons::PigpiodBackend::delay(uint32_t uiMicros) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_iBatchDepth > 0) {
+            // The daemon sleeps between the queued commands
+            for (uint32_t uiLeft = uiMicros; uiLeft > 0;) {
+                uint32_t uiChunk = std::min(uiLeft, pigpiod::MAX_MICS_DELAY);
+                m_vQueue.push_back({pigpiod::CMD_MICS, uiChunk, 0, 0});
+                uiLeft -= uiChunk;
+            }
+            if (m_vQueue.size() >= MAX_QUEUED) {
+                flush();
+            }
+            return uiMicros;
+        }
+    }
+
+    // Nothing in flight: a round trip would only add to the delay
+    std::this_thread::sleep_for(std::chrono::microseconds(uiMicros));
+    return uiMicros;
+}
+
+int addons::PigpiodBackend::setAlertFunc(unsigned uiPin, AlertFunc fAlert, void* pUserData) {
+    if (uiPin >= 32) {
+        return -1;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_alertMutex);
+        m_aAlerts[uiPin] = fAlert;
+        m_aAlertData[uiPin] = pUserData;
+        if (fAlert) {
+            m_uiAlertMask |= 1u << uiPin;
+        } else {
+            m_uiAlertMask &= ~(1u << uiPin);
+        }
+    }
+    return updateNotifications();
+}
+
+int addons::PigpiodBackend::setGlitchFilter(unsigned uiPin, uint32_t uiSteadyUs) {
+    return command(pigpiod::CMD_FG, uiPin, uiSteadyUs);
+}
+
+bool addons::PigpiodBackend::supportsWaves() const {
+    return true;
+}
+
+int addons::PigpiodBackend::waveCreate(const std::vector<Pulse>& vPulses) {
+    static_assert(sizeof(Pulse) == 12, "Pulse has the gpioPulse_t wire layout");
+
+    if (command(pigpiod::CMD_WVNEW) < 0) {
+        return -1;
+    }
+    if (command(pigpiod::CMD_WVAG, 0, 0, vPulses.data(), vPulses.size() * sizeof(Pulse)) < 0) {
+        return -1;
+    }
+    return command(pigpiod::CMD_WVCRE);
+}
+
+int addons::PigpiodBackend::waveSend(unsigned uiWaveId) {
+    return command(pigpiod::CMD_WVTX, uiWaveId);
+}
+
+bool addons::PigpiodBackend::waveBusy() {
+    return command(pigpiod::CMD_WVBSY) == 1;
+}
+
+int addons::PigpiodBackend::waveDelete(unsigned uiWaveId) {
+    return command(pigpiod::CMD_WVDEL, uiWaveId);
+}
+
+void addons::PigpiodBackend::beginBatch() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_iBatchDepth;
+}
+
+void addons::PigpiodBackend::endBatch() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_iBatchDepth > 0 && --m_iBatchDepth == 0) {
+        flush();
+    }
+}
+
+int addons::PigpiodBackend::connectDaemon() {
+    addrinfo oHints {};
+    oHints.ai_family = AF_UNSPEC;
+    oHints.ai_socktype = SOCK_STREAM;
+
+    addrinfo* pAddrs = nullptr;
+    int iErr = getaddrinfo(m_sHost.c_str(), std::to_string(m_uiPort).c_str(), &oHints, &pAddrs);
+    if (iErr != 0) {
+        LOGGER_LOG(LOG_ERR, "PigpiodBackend| Failed to resolve [", m_sHost, "]: ", gai_strerror(iErr));
+        return -1;
+    }
+
+    int iFd = -1;
+    for (addrinfo* pAddr = pAddrs; pAddr && iFd < 0; pAddr = pAddr->ai_next) {
+        iFd = ::socket(pAddr->ai_family, pAddr->ai_socktype | SOCK_CLOEXEC, pAddr->ai_protocol);
+        if (iFd >= 0 && ::connect(iFd, pAddr->ai_addr, pAddr->ai_addrlen) < 0) {
+            ::close(iFd);
+            iFd = -1;
+        }
+    }
+    freeaddrinfo(pAddrs);
+
+    if (iFd < 0) {
+        LOGGER_LOG(LOG_ERR, "PigpiodBackend| Failed to connect to pigpiod at [", m_sHost, ":", m_uiPort,
+                   "]: ", std::strerror(errno));
+        return -1;
+    }
+
+    int iOne = 1;
+    setsockopt(iFd, IPPROTO_TCP, TCP_NODELAY, &iOne, sizeof(iOne));
+    return iFd;
+}
+
+int addons::PigpiodBackend::command(uint32_t uiCmd, uint32_t uiP1, uint32_t uiP2,
+                                    const void* pExt, uint32_t uiExtLength) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return transact(uiCmd, uiP1, uiP2, pExt, uiExtLength);
+}
+
+int addons::PigpiodBackend::submit(uint32_t uiCmd, uint32_t uiP1, uint32_t uiP2) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_iBatchDepth == 0) {
+        return transact(uiCmd, uiP1, uiP2, nullptr, 0);
+    }
+
+    m_vQueue.push_back({uiCmd, uiP1, uiP2, 0});
+    if (m_vQueue.size() >= MAX_QUEUED) {
+        return flush();
+    }
+    return 0;
+}
+
+int addons::PigpiodBackend::transact(uint32_t uiCmd, uint32_t uiP1, uint32_t uiP2,
+                                     const void* pExt, uint32_t uiExtLength) {
+    if (m_iCmdFd < 0) {
+        return -1;
+    }
+
+    // The queued commands and this one leave in the same request
+    m_vQueue.push_back({uiCmd, uiP1, uiP2, uiExtLength});
+    size_t uiHeaders = m_vQueue.size() * sizeof(pigpiod::Header);
+    bool bSent;
+    if (uiExtLength) {
+        const char* pHeaders = reinterpret_cast<const char*>(m_vQueue.data());
+        const char* pExtBytes = static_cast<const char*>(pExt);
+        std::vector<char> vRequest;
+        vRequest.reserve(uiHeaders + uiExtLength);
+        vRequest.insert(vRequest.end(), pHeaders, pHeaders + uiHeaders);
+        vRequest.insert(vRequest.end(), pExtBytes, pExtBytes + uiExtLength);
+        bSent = sendAll(m_iCmdFd, vRequest.data(), vRequest.size());
+    } else {
+        bSent = sendAll(m_iCmdFd, m_vQueue.data(), uiHeaders);
+    }
+    g_oRequests.inc();
+
+    int iRes = -1;
+    for (size_t i = 0; i < m_vQueue.size() && bSent; ++i) {
+        pigpiod::Header oReply;
+        if (!recvAll(m_iCmdFd, &oReply, sizeof(oReply))) {
+            bSent = false;
+            break;
+        }
+        g_oCommands.inc();
+        iRes = static_cast<int32_t>(oReply.uiP3);
+        // The last result goes to the caller, ticks and levels may look negative
+        if (iRes < 0 && i + 1 < m_vQueue.size()) {
+            g_oErrors.inc();
+            LOGGER_LOG(LOG_WARNING, "PigpiodBackend| Command [", m_vQueue[i].uiCmd, "] failed: ", iRes);
+        }
+    }
+    m_vQueue.clear();
+
+    if (!bSent) {
+        LOGGER_LOG(LOG_ERR, "PigpiodBackend| Lost the connection to pigpiod: ", std::strerror(errno));
+        ::close(m_iCmdFd);
+        m_iCmdFd = -1;
+        return -1;
+    }
+    return iRes;
+}
+
+int addons::PigpiodBackend::flush() {
+    if (m_vQueue.empty()) {
+        return 0;
+    }
+
+    // The last queued command goes out as the request's own
+    pigpiod::Header oLast = m_vQueue.back();
+    m_vQueue.pop_back();
+    return transact(oLast.uiCmd, oLast.uiP1, oLast.uiP2, nullptr, 0);
+}
+
+int addons::PigpiodBackend::openNotifications() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_iCmdFd < 0) {
+        return -1;
+    }
+    int iFd = connectDaemon();
+    if (iFd < 0) {
+        return -1;
+    }
+    // The reply to NOIB comes on the socket that then carries the reports
+    pigpiod::Header oOpen {pigpiod::CMD_NOIB, 0, 0, 0};
+    pigpiod::Header oReply;
+    if (!sendAll(iFd, &oOpen, sizeof(oOpen)) || !recvAll(iFd, &oReply, sizeof(oReply)) ||
+        static_cast<int32_t>(oReply.uiP3) < 0) {
+        LOGGER_LOG(LOG_ERR, "PigpiodBackend| Failed to open a notification handle");
+        ::close(iFd);
+        return -1;
+    }
+
+    std::lock_guard<std::mutex> alertLock(m_alertMutex);
+    m_iNotifyFd = iFd;
+    m_iNotifyHandle = oReply.uiP3;
+    m_uiLevels = static_cast<uint32_t>(transact(pigpiod::CMD_BR1, 0, 0, nullptr, 0));
+    m_notifyThread = std::thread(&PigpiodBackend::notifyLoop, this, iFd);
+    return 0;
+}
+
+int addons::PigpiodBackend::updateNotifications() {
+    // Keeps concurrent setAlertFunc() calls in order with their masks
+    std::lock_guard<std::mutex> lock(m_mutex);
+    uint32_t uiMask;
+    int iHandle;
+    {
+        std::lock_guard<std::mutex> alertLock(m_alertMutex);
+        uiMask = m_uiAlertMask;
+        iHandle = m_iNotifyHandle;
+    }
+
+    if (iHandle < 0) {
+        return uiMask ? -1 : 0;
+    }
+    return transact(pigpiod::CMD_NB, iHandle, uiMask, nullptr, 0) < 0 ? -1 : 0;
+}
+
+void addons::PigpiodBackend::notifyLoop(int iFd) {
+    pigpiod::Report oReport;
+    while (recvAll(iFd, &oReport, sizeof(oReport))) {
+        // Held while calling back, so a removed alert is never called afterwards
+        std::lock_guard<std::mutex> lock(m_alertMutex);
+
+        if (oReport.uiFlags & pigpiod::NTFY_FLAGS_WDOG) {
+            unsigned uiPin = oReport.uiFlags & pigpiod::NTFY_FLAGS_GPIO;
+            if (m_uiAlertMask & (1u << uiPin)) {
+                m_aAlerts[uiPin](uiPin, 2, oReport.uiTick, m_aAlertData[uiPin]);
+            }
+            continue;
+        }
+        if (oReport.uiFlags) {
+            continue;
+        }
+
+        uint32_t uiChanged = (oReport.uiLevels ^ m_uiLevels) & m_uiAlertMask;
+        m_uiLevels = oReport.uiLevels;
+        for (unsigned uiPin = 0; uiChanged; ++uiPin, uiChanged >>= 1) {
+            if (uiChanged & 1) {
+                m_aAlerts[uiPin](uiPin, (oReport.uiLevels >> uiPin) & 1, oReport.uiTick, m_aAlertData[uiPin]);
+            }
+        }
+    }
+}
@@ -0,0 +1,304 @@
+#include "SimDevices.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <sys/syslog.h>
+
+#include "logger.h"
+
+addons::SimDHT11::SimDHT11(unsigned uiPin) : m_uiPin(uiPin) {}
+
+addons::SimDHT11::~SimDHT11() {}
+
+void addons::SimDHT11::setReading(uint8_t uiTemp, uint8_t uiHum) {
+    m_uiTemp = uiTemp;
+    m_uiHum = uiHum;
+}
+
+void addons::SimDHT11::setTiming(const Timing& oTiming) {
+    m_oTiming = oTiming;
+}
+
+void addons::SimDHT11::setFaults(const Faults& oFaults, uint32_t uiSeed) {
+    m_oFaults = oFaults;
+    m_oRng.seed(uiSeed);
+}
+
+uint64_t addons::SimDHT11::frames() const {
+    return m_ullFrames;
+}
+
+uint64_t addons::SimDHT11::faultyFrames() const {
+    return m_ullFaultyFrames;
+}
+
+void addons::SimDHT11::onLineChange(unsigned uiPin, int iLevel, uint64_t ullNowNs) {
+    if (uiPin != m_uiPin || iLevel == m_iLast) {
+        return;
+    }
+    m_iLast = iLevel;
+
+    if (iLevel == 0) {
+        // Host pulls the line: any response in flight is abandoned
+        m_ullLowSinceNs = ullNowNs;
+        m_vToggles.clear();
+    } else if (ullNowNs - m_ullLowSinceNs >= static_cast<uint64_t>(m_oTiming.uiMinStartUs) * 1000) {
+        startResponse(ullNowNs);
+    }
+}
+
+int addons::SimDHT11::drive(unsigned uiPin, uint64_t ullNowNs) {
+    if (uiPin != m_uiPin || m_vToggles.empty()) {
+        return 1;
+    }
+    // Each toggle passed flips the output, it starts HIGH (released)
+    auto it = std::upper_bound(m_vToggles.begin(), m_vToggles.end(), ullNowNs);
+    return (it - m_vToggles.begin()) % 2 ? 0 : 1;
+}
+
+bool addons::SimDHT11::nextToggle(unsigned uiPin, uint64_t ullAfterNs, uint64_t& ullAtNs) {
+    if (uiPin != m_uiPin) {
+        return false;
+    }
+    auto it = std::upper_bound(m_vToggles.begin(), m_vToggles.end(), ullAfterNs);
+    if (it == m_vToggles.end()) {
+        return false;
+    }
+    ullAtNs = *it;
+    return true;
+}
+
+void addons::SimDHT11::startResponse(uint64_t ullNowNs) {
+    // One draw per frame picks the fault, if any
+    double dDraw = std::uniform_real_distribution<double>(0, 1)(m_oRng);
+    bool bBadChecksum = dDraw < m_oFaults.dBadChecksum;
+
+    uint8_t aData[5] = {m_uiHum, 0, m_uiTemp, 0, 0};
+    aData[4] = static_cast<uint8_t>(aData[0] + aData[1] + aData[2] + aData[3] + (bBadChecksum ? 1 : 0));
+
+    m_vToggles.clear();
+    uint64_t ullAt = ullNowNs + static_cast<uint64_t>(m_oTiming.uiGoUs) * 1000;
+    auto toggleAfter = [&](uint32_t uiUs) {
+        m_vToggles.push_back(ullAt);
+        ullAt += static_cast<uint64_t>(uiUs) * 1000;
+    };
+
+    toggleAfter(m_oTiming.uiRespLowUs);
+    toggleAfter(m_oTiming.uiRespHighUs);
+    for (int i = 0; i < 40; ++i) {
+        bool bOne = aData[i / 8] & (0x80 >> (i % 8));
+        toggleAfter(m_oTiming.uiBitLowUs);
+        toggleAfter(bOne ? m_oTiming.uiOneHighUs : m_oTiming.uiZeroHighUs);
+    }
+    toggleAfter(m_oTiming.uiEndLowUs);
+    m_vToggles.push_back(ullAt);
+
+    ++m_ullFrames;
+    dDraw -= m_oFaults.dBadChecksum;
+    if (bBadChecksum) {
+        ++m_ullFaultyFrames;
+    } else if (dDraw >= 0 && dDraw < m_oFaults.dMissingEdge + m_oFaults.dStretchedPulse) {
+        bool bMissing = dDraw < m_oFaults.dMissingEdge;
+        // A data pulse, the response ones are what the reader syncs on
+        size_t uiPulse = std::uniform_int_distribution<size_t>(2, m_vToggles.size() - 2)(m_oRng);
+        if (bMissing) {
+            // Both edges of the pulse go, it merges with its neighbours
+            m_vToggles.erase(m_vToggles.begin() + uiPulse, m_vToggles.begin() + uiPulse + 2);
+        } else {
+            for (size_t i = uiPulse + 1; i < m_vToggles.size(); ++i) {
+                m_vToggles[i] += static_cast<uint64_t>(m_oFaults.uiStretchUs) * 1000;
+            }
+        }
+        ++m_ullFaultyFrames;
+    }
+}
+
+addons::SimLightSensor::SimLightSensor(unsigned uiPin, uint32_t uiPeriodMs, unsigned uiBounces)
+    : m_uiPin(uiPin), m_ullPeriodNs(static_cast<uint64_t>(uiPeriodMs) * 1000000),
+      m_ullTogglesPerSwitch(2 * static_cast<uint64_t>(uiBounces) + 1) {
+    // The bounces of a switch must be over before the next one
+    if (m_ullPeriodNs <= m_ullTogglesPerSwitch * BOUNCE_NS) {
+        m_ullPeriodNs = (m_ullTogglesPerSwitch + 1) * BOUNCE_NS;
+    }
+}
+
+addons::SimLightSensor::~SimLightSensor() {}
+
+void addons::SimLightSensor::setStuck(int iLevel) {
+    m_iStuck = iLevel < 0 ? -1 : (iLevel ? 1 : 0);
+}
+
+void addons::SimLightSensor::onLineChange(unsigned /*uiPin*/, int /*iLevel*/, uint64_t /*ullNowNs*/) {}
+
+int addons::SimLightSensor::drive(unsigned uiPin, uint64_t ullNowNs) {
+    if (uiPin == m_uiPin && m_iStuck >= 0) {
+        return m_iStuck;
+    }
+    if (uiPin != m_uiPin || ullNowNs < m_ullPeriodNs) {
+        return 1;
+    }
+    // Toggles of the finished switches, then the ones of the current switch
+    uint64_t ullSwitch = ullNowNs / m_ullPeriodNs;
+    uint64_t ullOffset = ullNowNs - ullSwitch * m_ullPeriodNs;
+    uint64_t ullToggles = (ullSwitch - 1) * m_ullTogglesPerSwitch +
+                          std::min(m_ullTogglesPerSwitch, ullOffset / BOUNCE_NS + 1);
+    return ullToggles % 2 ? 0 : 1;
+}
+
+bool addons::SimLightSensor::nextToggle(unsigned uiPin, uint64_t ullAfterNs, uint64_t& ullAtNs) {
+    if (uiPin != m_uiPin || m_iStuck >= 0) {
+        return false;
+    }
+    uint64_t ullSwitch = ullAfterNs / m_ullPeriodNs;
+    if (ullSwitch > 0) {
+        uint64_t ullNext = (ullAfterNs - ullSwitch * m_ullPeriodNs) / BOUNCE_NS + 1;
+        if (ullNext < m_ullTogglesPerSwitch) {
+            ullAtNs = ullSwitch * m_ullPeriodNs + ullNext * BOUNCE_NS;
+            return true;
+        }
+    }
+    ullAtNs = (ullSwitch + 1) * m_ullPeriodNs;
+    return true;
+}
+
+addons::SimTM1637::SimTM1637(unsigned uiClkPin, unsigned uiDioPin)
+    : m_uiClkPin(uiClkPin), m_uiDioPin(uiDioPin) {}
+
+addons::SimTM1637::~SimTM1637() {}
+
+const std::array<uint8_t, 6>& addons::SimTM1637::segments() const {
+    return m_aSegments;
+}
+
+int addons::SimTM1637::brightness() const {
+    return m_iBrightness;
+}
+
+bool addons::SimTM1637::displayOn() const {
+    return m_bOn;
+}
+
+uint64_t addons::SimTM1637::frames() const {
+    return m_ullFrames;
+}
+
+uint64_t addons::SimTM1637::bytes() const {
+    return m_ullBytes;
+}
+
+void addons::SimTM1637::setMinClockPhaseNs(uint64_t ullNs) {
+    m_ullMinPhaseNs = ullNs;
+}
+
+void addons::SimTM1637::setNackRate(double dRate, uint32_t uiSeed) {
+    m_dNackRate = dRate;
+    m_oRng.seed(uiSeed);
+}
+
+uint64_t addons::SimTM1637::nacked() const {
+    return m_ullNacked;
+}
+
+void addons::SimTM1637::onLineChange(unsigned uiPin, int iLevel, uint64_t ullNowNs) {
+    if (uiPin == m_uiClkPin && iLevel != m_iClk) {
+        m_iClk = iLevel;
+        if (m_bReceiving && ullNowNs - m_ullClkChangeNs < m_ullMinPhaseNs) {
+            // Missed the edge, out of step with the host until the next start
+            m_bReceiving = false;
+            m_bAck = false;
+        }
+        m_ullClkChangeNs = ullNowNs;
+        onClock(iLevel);
+    } else if (uiPin == m_uiDioPin && iLevel != m_iDio) {
+        m_iDio = iLevel;
+        onData(iLevel);
+    }
+}
+
+int addons::SimTM1637::drive(unsigned uiPin, uint64_t /*ullNowNs*/) {
+    return (uiPin == m_uiDioPin && m_bAck) ? 0 : 1;
+}
+
+void addons::SimTM1637::onClock(int iLevel) {
+    if (!m_bReceiving) {
+        return;
+    }
+
+    if (iLevel) {
+        if (m_iBit < 8) {
+            m_uiByte |= (m_iDio ? 1 : 0) << m_iBit;
+            ++m_iBit;
+        } else if (m_iBit == 8) {
+            m_iBit = 9;
+        }
+    } else {
+        if (m_iBit == 8) {
+            m_bAck = !m_bIgnoring;
+        } else if (m_iBit == 9) {
+            m_bAck = false;
+            m_vBytes.push_back(m_uiByte);
+            ++m_ullBytes;
+            m_uiByte = 0;
+            m_iBit = 0;
+        }
+    }
+}
+
+void addons::SimTM1637::onData(int iLevel) {
+    // DIO only changes with CLK high on start/stop, except around the ACK clock
+    // where the host hands the line over.
+    if (!m_iClk || m_iBit >= 8) {
+        return;
+    }
+
+    if (!iLevel) {
+        m_bReceiving = true;
+        m_vBytes.clear();
+        m_bIgnoring = m_dNackRate > 0 && std::uniform_real_distribution<double>(0, 1)(m_oRng) < m_dNackRate;
+        m_ullNacked += m_bIgnoring;
+    } else if (m_bReceiving) {
+        if (!m_bIgnoring) {
+            latch();
+        }
+        m_bReceiving = false;
+    }
+    m_uiByte = 0;
+    m_iBit = 0;
+}
+
+void addons::SimTM1637::latch() {
+    if (m_vBytes.empty()) {
+        return;
+    }
+
+    uint8_t uiCmd = m_vBytes[0];
+    switch (uiCmd & 0xC0) {
+        case 0x40:
+            m_bAutoIncrement = !(uiCmd & 0x04);
+            break;
+        case 0x80:
+            m_bOn = uiCmd & 0x08;
+            m_iBrightness = uiCmd & 0x07;
+            break;
+        case 0xC0: {
+            size_t uiAddr = uiCmd & 0x07;
+            for (size_t i = 1; i < m_vBytes.size() && uiAddr < m_aSegments.size(); ++i) {
+                m_aSegments[uiAddr] = m_vBytes[i];
+                if (m_bAutoIncrement) {
+                    ++uiAddr;
+                }
+            }
+            ++m_ullFrames;
+
+            if (Logger::enabled(LOG_DEBUG)) {
+                char sBuf[32];
+                std::snprintf(sBuf, sizeof(sBuf), "%02X %02X %02X %02X",
+                              m_aSegments[0], m_aSegments[1], m_aSegments[2], m_aSegments[3]);
+                LOGGER_LOG(LOG_DEBUG, "SimTM1637| Latched segments [", sBuf, "]");
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
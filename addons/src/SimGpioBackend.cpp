@@ -0,0 +1,279 @@
+#include "SimGpioBackend.h"
+
+addons::SimDevice::~SimDevice() {}
+
+bool addons::SimDevice::nextToggle(unsigned /*uiPin*/, uint64_t /*ullAfterNs*/, uint64_t& /*ullAtNs*/) {
+    return false;
+}
+
+addons::SimGpioBackend::SimGpioBackend() {}
+
+addons::SimGpioBackend::~SimGpioBackend() {}
+
+const char* addons::SimGpioBackend::name() const {
+    return "sim";
+}
+
+int addons::SimGpioBackend::initialise() {
+    return 0;
+}
+
+void addons::SimGpioBackend::terminate() {}
+
+int addons::SimGpioBackend::setMode(unsigned uiPin, unsigned uiMode) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!validPin(uiPin) || uiMode > MODE_OUTPUT) {
+        return -1;
+    }
+    advance(m_uiCallCostNs);
+
+    int iPrev = hostLevel(m_aPins[uiPin]);
+    m_aPins[uiPin].uiMode = uiMode;
+    updateHost(uiPin, iPrev);
+    return 0;
+}
+
+int addons::SimGpioBackend::setPullUpDown(unsigned uiPin, unsigned uiPud) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!validPin(uiPin) || uiPud > PUD_UP) {
+        return -1;
+    }
+    advance(m_uiCallCostNs);
+
+    int iPrev = hostLevel(m_aPins[uiPin]);
+    m_aPins[uiPin].uiPud = uiPud;
+    updateHost(uiPin, iPrev);
+    return 0;
+}
+
+int addons::SimGpioBackend::read(unsigned uiPin) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!validPin(uiPin)) {
+        return -1;
+    }
+    advance(m_uiCallCostNs);
+    return lineLevel(uiPin);
+}
+
+int addons::SimGpioBackend::write(unsigned uiPin, unsigned uiLevel) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!validPin(uiPin)) {
+        return -1;
+    }
+    advance(m_uiCallCostNs);
+    latch(uiPin, uiLevel);
+    return 0;
+}
+
+uint32_t addons::SimGpioBackend::readBank() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    advance(m_uiCallCostNs);
+
+    uint32_t uiLevels = 0;
+    for (unsigned uiPin = 0; uiPin < 32; ++uiPin) {
+        uiLevels |= static_cast<uint32_t>(lineLevel(uiPin)) << uiPin;
+    }
+    return uiLevels;
+}
+
+int addons::SimGpioBackend::writeBank(uint32_t uiSet, uint32_t uiClear) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    advance(m_uiCallCostNs);
+
+    for (unsigned uiPin = 0; uiPin < 32; ++uiPin) {
+        uint32_t uiBit = 1u << uiPin;
+        if (uiSet & uiBit) {
+            latch(uiPin, 1);
+        }
+    }
+    for (unsigned uiPin = 0; uiPin < 32; ++uiPin) {
+        uint32_t uiBit = 1u << uiPin;
+        if (uiClear & uiBit) {
+            latch(uiPin, 0);
+        }
+    }
+    return 0;
+}
+
+uint32_t addons::SimGpioBackend::tick() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    advance(m_uiCallCostNs);
+    return static_cast<uint32_t>(m_ullNowNs / 1000);
+}
+
+uint32_t addons::SimGpioBackend::delay(uint32_t uiMicros) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    advance(static_cast<uint64_t>(uiMicros) * 1000);
+    return uiMicros;
+}
+
+int addons::SimGpioBackend::setAlertFunc(unsigned uiPin, AlertFunc fAlert, void* pUserData) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!validPin(uiPin)) {
+        return -1;
+    }
+
+    PinState& oPin = m_aPins[uiPin];
+    if (fAlert) {
+        m_ullAlertPins |= 1ull << uiPin;
+    } else {
+        m_ullAlertPins &= ~(1ull << uiPin);
+    }
+    oPin.fAlert = fAlert;
+    oPin.pAlertData = pUserData;
+    oPin.iAlertLevel = lineLevel(uiPin);
+    return 0;
+}
+
+bool addons::SimGpioBackend::supportsWaves() const {
+    return true;
+}
+
+int addons::SimGpioBackend::waveCreate(const std::vector<Pulse>& vPulses) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_mWaves[m_uiNextWaveId] = vPulses;
+    return m_uiNextWaveId++;
+}
+
+int addons::SimGpioBackend::waveSend(unsigned uiWaveId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_mWaves.find(uiWaveId);
+    if (it == m_mWaves.end()) {
+        return -1;
+    }
+
+    for (const Pulse& oPulse : it->second) {
+        for (unsigned uiPin = 0; uiPin < 32; ++uiPin) {
+            uint32_t uiBit = 1u << uiPin;
+            PinState& oPin = m_aPins[uiPin];
+            if (!((oPulse.uiOn | oPulse.uiOff) & uiBit) || oPin.uiMode != MODE_OUTPUT) {
+                continue;
+            }
+            int iPrev = hostLevel(oPin);
+            oPin.uiLatch = (oPulse.uiOn & uiBit) ? 1 : 0;
+            updateHost(uiPin, iPrev);
+        }
+        advance(static_cast<uint64_t>(oPulse.uiDelayUs) * 1000);
+    }
+    return 0;
+}
+
+bool addons::SimGpioBackend::waveBusy() {
+    return false;
+}
+
+int addons::SimGpioBackend::waveDelete(unsigned uiWaveId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_mWaves.erase(uiWaveId) ? 0 : -1;
+}
+
+void addons::SimGpioBackend::attach(std::shared_ptr<SimDevice> pDevice, std::initializer_list<unsigned> lPins) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (unsigned uiPin : lPins) {
+        if (validPin(uiPin)) {
+            m_aPins[uiPin].vDevices.push_back(pDevice);
+        }
+    }
+}
+
+void addons::SimGpioBackend::setCallCostNs(uint32_t uiNs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_uiCallCostNs = uiNs;
+}
+
+uint64_t addons::SimGpioBackend::nowNs() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_ullNowNs;
+}
+
+void addons::SimGpioBackend::advanceNs(uint64_t ullNs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    advance(ullNs);
+}
+
+bool addons::SimGpioBackend::validPin(unsigned uiPin) const {
+    return uiPin < PIN_COUNT;
+}
+
+int addons::SimGpioBackend::hostLevel(const PinState& oPin) const {
+    if (oPin.uiMode == MODE_OUTPUT) {
+        return oPin.uiLatch;
+    }
+    return oPin.uiPud == PUD_DOWN ? 0 : 1;
+}
+
+int addons::SimGpioBackend::lineLevel(unsigned uiPin) {
+    return driveLevel(m_aPins[uiPin], uiPin, m_ullNowNs);
+}
+
+int addons::SimGpioBackend::driveLevel(const PinState& oPin, unsigned uiPin, uint64_t ullAtNs) const {
+    int iLevel = hostLevel(oPin);
+    for (const auto& pDevice : oPin.vDevices) {
+        iLevel &= pDevice->drive(uiPin, ullAtNs);
+    }
+    return iLevel;
+}
+
+void addons::SimGpioBackend::latch(unsigned uiPin, unsigned uiLevel) {
+    int iPrev = hostLevel(m_aPins[uiPin]);
+    m_aPins[uiPin].uiLatch = uiLevel ? 1 : 0;
+    updateHost(uiPin, iPrev);
+}
+
+void addons::SimGpioBackend::updateHost(unsigned uiPin, int iPrevHost) {
+    PinState& oPin = m_aPins[uiPin];
+    if (hostLevel(oPin) == iPrevHost) {
+        return;
+    }
+    if (!oPin.vDevices.empty()) {
+        int iLevel = lineLevel(uiPin);
+        for (const auto& pDevice : oPin.vDevices) {
+            pDevice->onLineChange(uiPin, iLevel, m_ullNowNs);
+        }
+    }
+    alert(uiPin, m_ullNowNs);
+}
+
+void addons::SimGpioBackend::advance(uint64_t ullNs) {
+    uint64_t ullTarget = m_ullNowNs + ullNs;
+
+    // Replay device driven edges in the skipped interval, pin by pin
+    for (uint64_t ullPins = m_ullAlertPins; ullPins; ullPins &= ullPins - 1) {
+        unsigned uiPin = static_cast<unsigned>(__builtin_ctzll(ullPins));
+        PinState& oPin = m_aPins[uiPin];
+        if (oPin.vDevices.empty()) {
+            continue;
+        }
+        // Earliest toggle of any device on the pin, in time order
+        uint64_t ullFrom = m_ullNowNs;
+        for (;;) {
+            uint64_t ullNext = UINT64_MAX;
+            for (const auto& pDevice : oPin.vDevices) {
+                uint64_t ullAt = 0;
+                if (pDevice->nextToggle(uiPin, ullFrom, ullAt) && ullAt < ullNext) {
+                    ullNext = ullAt;
+                }
+            }
+            if (ullNext > ullTarget) {
+                break;
+            }
+            alert(uiPin, ullNext);
+            ullFrom = ullNext;
+        }
+    }
+
+    m_ullNowNs = ullTarget;
+}
+
+void addons::SimGpioBackend::alert(unsigned uiPin, uint64_t ullAtNs) {
+    PinState& oPin = m_aPins[uiPin];
+    if (!oPin.fAlert) {
+        return;
+    }
+
+    int iLevel = driveLevel(oPin, uiPin, ullAtNs);
+    if (iLevel != oPin.iAlertLevel) {
+        oPin.iAlertLevel = iLevel;
+        oPin.fAlert(uiPin, iLevel, static_cast<uint32_t>(ullAtNs / 1000), oPin.pAlertData);
+    }
+}
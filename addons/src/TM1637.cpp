@@ -1,77 +1,48 @@
 #include "TM1637.h"
 #include "logger.h"
+#include "metrics.h"
 
-#include <cctype>
-#include <pigpio.h>
-#include <sstream>
+#include <algorithm>
 #include <string>
 #include <sys/syslog.h>
-#include <bitset>
-
- //    - A -
- //   F     B
- //    - G -
- //   E     C
- //    - D -
-
-std::map<char, char> addons::TM1637::CHARS_TO_SIGNAL = {
-    {'\0', 0x0},
-    { ' ', 0x0 },
-    { '0', SegA | SegB | SegC | SegD | SegE | SegF },
-    { '1', SegB | SegC },
-    { '2', SegA | SegB | SegG | SegE | SegD },
-    { '3', SegA | SegB | SegG | SegC | SegD },
-    { '4', SegF | SegG | SegB | SegC },
-    { '5', SegA | SegF | SegG | SegC | SegD },
-    { '6', SegF | SegE | SegG | SegC | SegD },
-    { '7', SegA | SegB | SegC },
-    { '8', SegA | SegB | SegC | SegD | SegE | SegF | SegG },
-    { '9', SegA | SegB | SegC | SegF | SegG },
-    { 'A', SegA | SegB | SegC | SegE | SegF | SegG },
-    { 'B', SegF | SegE | SegG | SegC | SegD },
-    { 'C', SegA | SegF | SegE | SegD },
-    { 'D', SegB | SegC | SegG | SegE | SegD },
-    { 'E', SegA | SegF | SegG | SegE | SegD },
-    { 'G', SegA | SegF | SegE | SegD | SegC | SegG },
-    { 'F', SegA | SegF | SegG | SegE },
-    { 'H', SegF | SegG | SegE | SegB | SegC },
-    { 'I', SegE },
-    { 'J', SegB | SegC | SegD | SegE },
-    { 'L', SegF | SegE | SegD },
-    { 'N', SegE | SegG | SegC },
-    { 'O', SegE | SegG | SegC | SegD },
-    { 'P', SegA | SegB | SegF | SegG | SegE },
-    { 'R', SegG | SegE },
-    { 'S', SegA | SegF | SegG | SegC | SegD },
-    { 'T', SegF | SegG | SegE | SegD },
-    { 'U', SegF | SegE|SegD|SegB|SegC },
-    { 'Y', SegF | SegG | SegB | SegC | SegD },
-    { 'Z', SegA | SegB | SegG | SegE | SegD },
-    { '-', SegG },
-    { '_', SegD },
-    { '.', SegD },
-    { ',', SegD },
-    { '\'', SegB },
-    { '"', SegF | SegB },
-    { char(0xB0), SegF | SegA | SegB | SegG }, // Degree sign (ISO/IEC 8859-1)
-    { '*', SegF | SegA | SegB | SegG },        // Degree sign replacement
-    { '\\', SegF | SegG | SegC },
-    { '/', SegE | SegG | SegB },
-    { '^', SegF | SegA | SegB }
-};
-
-addons::TM1637::TM1637(int iIOPin, int iClkPin) : m_iIOPin(iIOPin), m_iClkPin(iClkPin) {
-    gpioSetMode(m_iIOPin, PI_OUTPUT);
-    gpioSetMode(m_iClkPin, PI_OUTPUT);
-}
-
-addons::TM1637::~TM1637() {}
-
-void addons::TM1637::setBrightness(int iBr) {
+
+namespace {
+
+metrics::Histogram g_oDisplayDuration("tm1637_display_duration_seconds", "TM1637 transmission time of a frame",
+                                      {0.0005, 0.001, 0.002, 0.004, 0.008, 0.016, 0.032, 0.064});
+
+metrics::Counter g_oFramesFull("tm1637_frames_total", "TM1637 display() calls by result", "result=\"full\"");
+metrics::Counter g_oFramesPartial("tm1637_frames_total", "TM1637 display() calls by result", "result=\"partial\"");
+metrics::Counter g_oFramesControl("tm1637_frames_total", "TM1637 display() calls by result", "result=\"control\"");
+metrics::Counter g_oFramesSkipped("tm1637_frames_total", "TM1637 display() calls by result", "result=\"skipped\"");
+metrics::Counter g_oFramesFailed("tm1637_frames_total", "TM1637 display() calls by result", "result=\"failed\"");
+
+metrics::Counter g_oAttempts("tm1637_display_attempts_total", "TM1637 transmission attempts including retries");
+metrics::Counter g_oAckFailures("tm1637_ack_failures_total", "TM1637 bytes the module did not ACK");
+metrics::Counter g_oTimingFallbacks("tm1637_timing_fallbacks_total", "TM1637 bus slow downs after missed ACKs");
+
+// Delays tried by calibrate(), shortest first
+const uint32_t CALIBRATION_STEPS[] = {1, 2, 3, 4, 6, 8, 12, 16, 24, 32, 50};
+const uint32_t CALIBRATION_MARGIN = 2;
+
+}
+
+template <size_t DIGITS, typename Layout>
+addons::BasicTM1637<DIGITS, Layout>::BasicTM1637(int iIOPin, int iClkPin, GpioBackend& oGpio)
+    : m_iIOPin(iIOPin), m_iClkPin(iClkPin), m_oGpio(oGpio) {
+    m_oGpio.setMode(m_iIOPin, GpioBackend::MODE_OUTPUT);
+    m_oGpio.setMode(m_iClkPin, GpioBackend::MODE_OUTPUT);
+}
+
+template <size_t DIGITS, typename Layout>
+addons::BasicTM1637<DIGITS, Layout>::~BasicTM1637() {
+    clearWaves();
+}
+
+template <size_t DIGITS, typename Layout>
+void addons::BasicTM1637<DIGITS, Layout>::setBrightness(int iBr) {
     if(iBr < 0 || iBr > 7) {
-        std::stringstream ss;
-        ss << "TM1637| Invalid brightness level: " << iBr;
-        Logger::log(LOG_ERR, ss.str());
+        LOGGER_LOG(LOG_ERR, "TM1637| Invalid brightness level: ", iBr);
         return;
     }
 
@@ -80,147 +51,452 @@ void addons::TM1637::setBrightness(int iBr) {
     display();
 }
 
-void addons::TM1637::display() {
-    std::stringstream ss;
-    ss << "TM1637| Displaying: [" << m_data << "]";
-    Logger::log(LOG_DEBUG, ss.str());
+template <size_t DIGITS, typename Layout>
+void addons::BasicTM1637<DIGITS, Layout>::display() {
+    Frame aFrame = m_aGlyphs;
+    size_t uiChanged = 0;
+    for (size_t i = 0; i < DIGITS; i++) {
+        if (m_bPoints && (Layout::POINTS >> i & 1)) {
+            aFrame[i] |= segments::SegDP;
+        }
+        if (!m_bSentValid || aFrame[i] != m_aSentFrame[i]) {
+            ++uiChanged;
+        }
+    }
+    bool bControl = !m_bSentValid || m_iSentBrightness != m_iBrightness;
+
+    // The module keeps showing the last latched frame, nothing to send
+    if (!uiChanged && !bControl) {
+        ++m_oStats.ullSkipped;
+        g_oFramesSkipped.inc();
+        return;
+    }
+
+    // Fixed address writes cost two bytes per digit plus the data command,
+    // a full auto-increment frame costs two bytes plus one per digit.
+    bool bFull = !m_bSentValid || 2 * uiChanged + 1 > DIGITS + 2;
+    if (m_eTransmitMode == TRANSMIT_WAVE && uiChanged) {
+        // Waves can't release DIO for the ACK: the bit-banged display control
+        // byte after the wave is what confirms the module is still in sync.
+        bFull = true;
+        bControl = true;
+    }
 
     int iAtt = 3;
     bool bRes = true;
+    uint32_t uiStartTick = m_oGpio.tick();
 
     do {
-        ss.str("");
-        ss << "TM1637| Display attempt: [" << iAtt << "]";
-        Logger::log(LOG_DEBUG, ss.str());
-        startTransmission();
-        writeByte(AUTO_ADDRESS_MODE);
-        stopTransmission();
-
-        startTransmission();
-        writeByte(ADDRESS_OF_FIRST);
-        for (int i = 0; i < 4; i++) {
-            bRes &= writeByte(charToSignal(i, m_data[i]));
-            gpioDelay(20);
+        LOGGER_LOG(LOG_DEBUG, "TM1637| Display attempt: [", iAtt, "]");
+        GpioBackend::Batch oBatch(m_oGpio);
+
+        if (bFull && m_eTransmitMode == TRANSMIT_WAVE) {
+            bRes = transmitWave(aFrame);
+        } else if (bFull) {
+            bRes = writeFrame(aFrame);
+        } else if (uiChanged) {
+            bRes = writeDigits(aFrame);
+        }
+        if (bControl) {
+            bRes &= writeDisplayControl();
         }
-        stopTransmission();
-    
-        startTransmission();
-        writeByte(DISPLAY_ON + m_iBrightness);
-        stopTransmission();
         --iAtt;
+        g_oAttempts.inc();
+
+        TM1637Timing oSlower;
+        if (!bRes && m_oTiming.slower(oSlower)) {
+            LOGGER_LOG(LOG_WARNING, "TM1637| Missed ACKs, slowing the bus down to a half bit of [",
+                       oSlower.uiHalfBitUs, "] us");
+            setTiming(oSlower);
+            g_oTimingFallbacks.inc();
+        }
 
     } while(!bRes && iAtt > 0);
 
+    g_oDisplayDuration.observe(static_cast<uint64_t>(m_oGpio.tick() - uiStartTick) * 1000);
+
+    if (!bRes) {
+        // Unknown what the module latched, resend everything next time
+        m_bSentValid = false;
+        ++m_oStats.ullFailed;
+        g_oFramesFailed.inc();
+        return;
+    }
+
+    m_aSentFrame = aFrame;
+    m_iSentBrightness = m_iBrightness;
+    m_bSentValid = true;
+    if (bFull) {
+        ++m_oStats.ullFull;
+        g_oFramesFull.inc();
+    } else if (uiChanged) {
+        ++m_oStats.ullPartial;
+        g_oFramesPartial.inc();
+    } else {
+        // Brightness only, the display control command alone
+        ++m_oStats.ullControl;
+        g_oFramesControl.inc();
+    }
+}
+
+template <size_t DIGITS, typename Layout>
+void addons::BasicTM1637<DIGITS, Layout>::invalidate() {
+    m_bSentValid = false;
+}
+
+template <size_t DIGITS, typename Layout>
+const typename addons::BasicTM1637<DIGITS, Layout>::FrameStats& addons::BasicTM1637<DIGITS, Layout>::frameStats() const {
+    return m_oStats;
+}
+
+template <size_t DIGITS, typename Layout>
+bool addons::BasicTM1637<DIGITS, Layout>::setTransmitMode(TransmitMode eMode) {
+    if (eMode == TRANSMIT_WAVE && (!m_oGpio.supportsWaves() || m_iIOPin > 31 || m_iClkPin > 31)) {
+        LOGGER_LOG(LOG_WARNING, "TM1637| Wave transmission is not supported by the [",
+                   m_oGpio.name(), "] backend");
+        return false;
+    }
+
+    if (eMode != TRANSMIT_WAVE) {
+        clearWaves();
+    }
+    m_eTransmitMode = eMode;
+    return true;
+}
+
+template <size_t DIGITS, typename Layout>
+void addons::BasicTM1637<DIGITS, Layout>::setTiming(const TM1637Timing& oTiming) {
+    if (oTiming != m_oTiming) {
+        // Cached waves carry the old delays
+        clearWaves();
+        m_oTiming = oTiming;
+    }
+}
+
+template <size_t DIGITS, typename Layout>
+const addons::TM1637Timing& addons::BasicTM1637<DIGITS, Layout>::timing() const {
+    return m_oTiming;
+}
+
+template <size_t DIGITS, typename Layout>
+bool addons::BasicTM1637<DIGITS, Layout>::calibrate(int iFrames, TM1637Timing& oResult) {
+    TM1637Timing oSaved = m_oTiming;
+    TM1637Timing oBest;
+
+    // One delay at a time, the others at their best so far
+    for (uint32_t TM1637Timing::*pField : {&TM1637Timing::uiHalfBitUs, &TM1637Timing::uiEdgeUs,
+                                            &TM1637Timing::uiDigitGapUs, &TM1637Timing::uiAckPolls}) {
+        uint32_t uiLimit = oBest.*pField;
+        for (uint32_t uiStep : CALIBRATION_STEPS) {
+            if (uiStep >= uiLimit) {
+                break;
+            }
+            TM1637Timing oTrial = oBest;
+            oTrial.*pField = uiStep;
+            if (probe(oTrial, iFrames) == iFrames) {
+                oBest = oTrial;
+                break;
+            }
+        }
+    }
+
+    oResult = oBest.withMargin(CALIBRATION_MARGIN);
+    int iAcked = probe(oResult, iFrames);
+    LOGGER_LOG(LOG_INFO, "TM1637| Calibrated half bit: [", oResult.uiHalfBitUs, "] us, ACK window: [",
+               oResult.uiAckPolls * oResult.uiAckPollUs, "] us, frame: [", oResult.frameUs(DIGITS),
+               "] us, ACKed: [", iAcked, "/", iFrames, "]");
+
+    setTiming(oSaved);
+    // The trial frames replaced whatever the module showed
+    m_bSentValid = false;
+    return iAcked == iFrames;
 }
 
-void addons::TM1637::display(char cData, int iPos) {
-    if (iPos < 0 || iPos > 3) {
-        std::stringstream ss;
-        ss << "TM1637| Display error. Invalid position: " << iPos;
-        Logger::log(LOG_ERR, ss.str());
+template <size_t DIGITS, typename Layout>
+int addons::BasicTM1637<DIGITS, Layout>::probe(const TM1637Timing& oTiming, int iFrames) {
+    TM1637Timing oSaved = m_oTiming;
+    m_oTiming = oTiming;
+
+    // All segments on and off in turn, every bit flips between frames
+    int iAcked = 0;
+    for (int i = 0; i < iFrames; i++) {
+        Frame aFrame;
+        aFrame.fill(i % 2 ? 0x00 : 0xFF);
+        GpioBackend::Batch oBatch(m_oGpio);
+        bool bRes = writeFrame(aFrame);
+        bRes &= writeDisplayControl();
+        iAcked += bRes;
     }
 
-    m_data[iPos] = cData;
+    m_oTiming = oSaved;
+    return iAcked;
+}
+
+template <size_t DIGITS, typename Layout>
+void addons::BasicTM1637<DIGITS, Layout>::display(char cData, int iPos) {
+    if (iPos < 0 || iPos >= static_cast<int>(DIGITS)) {
+        LOGGER_LOG(LOG_ERR, "TM1637| Display error. Invalid position: ", iPos);
+        return;
+    }
+    if (!segments::known(cData)) {
+        LOGGER_LOG(LOG_WARNING, "TM1637| Char is not in list: [", cData, "]");
+    }
+
+    m_aGlyphs[iPos] = segments::glyph(cData);
 
     display();
 }
 
-void addons::TM1637::display(int iData, bool bDots) {
+template <size_t DIGITS, typename Layout>
+void addons::BasicTM1637<DIGITS, Layout>::display(int iData, bool bDots) {
     display(std::to_string(iData), bDots);
 }
-void addons::TM1637::display(const std::string& sData, bool bDots) {
-    if (sData.size() > 4) {
-        std::stringstream ss;
-        ss << "TM1637| Invalid data to display: [" << sData << "], length: [" << sData.size() << "]";
-        Logger::log(LOG_ERR, ss.str());
+template <size_t DIGITS, typename Layout>
+void addons::BasicTM1637<DIGITS, Layout>::display(const std::string& sData, bool bDots) {
+    Frame aGlyphs;
+    size_t uiDigits = segments::encode<DIGITS, Layout::FOLD_DOTS>(sData.data(), sData.size(), aGlyphs);
+    if (uiDigits > DIGITS) {
+        LOGGER_LOG(LOG_ERR, "TM1637| Invalid data to display: [", sData, "], length: [", sData.size(), "]");
         return;
     }
 
-    for (auto i = 0; i < 4; i++ ) {
-        m_data[i] = 0;
+    if (Logger::enabled(LOG_WARNING)) {
+        for (char cData : sData) {
+            if (!segments::known(cData)) {
+                LOGGER_LOG(LOG_WARNING, "TM1637| Char is not in list: [", cData, "]");
+            }
+        }
     }
+    LOGGER_LOG(LOG_DEBUG, "TM1637| Displaying: [", sData, "]");
+
+    m_aGlyphs = aGlyphs;
+    m_bPoints = bDots;
 
-    std::copy(sData.begin(), sData.end(), m_data);
+    display();
+}
 
+template <size_t DIGITS, typename Layout>
+void addons::BasicTM1637<DIGITS, Layout>::display(const Frame& aGlyphs, bool bDots) {
+    m_aGlyphs = aGlyphs;
     m_bPoints = bDots;
 
     display();
 }
 
-void addons::TM1637::switchPoints(bool bPoints) {
+template <size_t DIGITS, typename Layout>
+void addons::BasicTM1637<DIGITS, Layout>::switchPoints(bool bPoints) {
     m_bPoints = bPoints;
     display();
 }
 
-void addons::TM1637::startTransmission() {
-    gpioSetMode(m_iIOPin, PI_OUTPUT);
-    gpioWrite(m_iIOPin, 1);
-    gpioWrite(m_iClkPin, 1);
-    gpioDelay(10);
-    gpioWrite(m_iIOPin, 0);
-    gpioDelay(10);
-    gpioWrite(m_iClkPin, 0);
+template <size_t DIGITS, typename Layout>
+void addons::BasicTM1637<DIGITS, Layout>::clear() {
+    m_aGlyphs.fill(0);
+    m_bPoints = false;
+    display();
+}
+
+template <size_t DIGITS, typename Layout>
+void addons::BasicTM1637<DIGITS, Layout>::startTransmission() {
+    m_oGpio.setMode(m_iIOPin, GpioBackend::MODE_OUTPUT);
+    m_oGpio.write(m_iIOPin, 1);
+    m_oGpio.write(m_iClkPin, 1);
+    m_oGpio.delay(m_oTiming.uiEdgeUs);
+    m_oGpio.write(m_iIOPin, 0);
+    m_oGpio.delay(m_oTiming.uiEdgeUs);
+    m_oGpio.write(m_iClkPin, 0);
+}
+
+template <size_t DIGITS, typename Layout>
+void addons::BasicTM1637<DIGITS, Layout>::stopTransmission() {
+    m_oGpio.setMode(m_iIOPin, GpioBackend::MODE_OUTPUT);
+    m_oGpio.write(m_iClkPin, 0);
+    m_oGpio.write(m_iIOPin, 0);
+    m_oGpio.delay(m_oTiming.uiEdgeUs);
+    m_oGpio.write(m_iClkPin, 1);
+    m_oGpio.delay(m_oTiming.uiEdgeUs);
+    m_oGpio.write(m_iIOPin, 1);
+}
+
+template <size_t DIGITS, typename Layout>
+bool addons::BasicTM1637<DIGITS, Layout>::writeFrame(const Frame& aFrame) {
+    bool bRes = true;
+
+    startTransmission();
+    bRes &= writeByte(AUTO_ADDRESS_MODE);
+    stopTransmission();
+
+    startTransmission();
+    bRes &= writeByte(ADDRESS_OF_FIRST);
+    for (size_t i = 0; i < DIGITS; i++) {
+        bRes &= writeByte(aFrame[i]);
+        m_oGpio.delay(m_oTiming.uiDigitGapUs);
+    }
+    stopTransmission();
+
+    return bRes;
+}
+
+template <size_t DIGITS, typename Layout>
+bool addons::BasicTM1637<DIGITS, Layout>::writeDigits(const Frame& aFrame) {
+    bool bRes = true;
+
+    startTransmission();
+    bRes &= writeByte(FIXED_ADDRESS_MODE);
+    stopTransmission();
+
+    for (size_t i = 0; i < DIGITS; i++) {
+        if (aFrame[i] == m_aSentFrame[i]) {
+            continue;
+        }
+        startTransmission();
+        bRes &= writeByte(ADDRESS_OF_FIRST + i);
+        bRes &= writeByte(aFrame[i]);
+        stopTransmission();
+    }
+
+    return bRes;
+}
+
+template <size_t DIGITS, typename Layout>
+bool addons::BasicTM1637<DIGITS, Layout>::writeDisplayControl() {
+    startTransmission();
+    bool bRes = writeByte(DISPLAY_ON + m_iBrightness);
+    stopTransmission();
+    return bRes;
+}
+
+template <size_t DIGITS, typename Layout>
+bool addons::BasicTM1637<DIGITS, Layout>::transmitWave(const Frame& aFrame) {
+    uint64_t ullKey = 0;
+    for (size_t i = 0; i < DIGITS; i++) {
+        ullKey = (ullKey << 8) | aFrame[i];
+    }
+
+    int iWave = -1;
+    auto it = m_mWaves.find(ullKey);
+    if (it != m_mWaves.end()) {
+        iWave = it->second;
+    } else {
+        if (m_dWaveOrder.size() >= MAX_CACHED_WAVES) {
+            m_oGpio.waveDelete(m_mWaves[m_dWaveOrder.front()]);
+            m_mWaves.erase(m_dWaveOrder.front());
+            m_dWaveOrder.pop_front();
+        }
+        iWave = compileWave(aFrame);
+        if (iWave < 0) {
+            LOGGER_LOG(LOG_WARNING, "TM1637| Failed to create a wave, falling back to bit-banging");
+            return writeFrame(aFrame);
+        }
+        m_mWaves[ullKey] = iWave;
+        m_dWaveOrder.push_back(ullKey);
+    }
+
+    m_oGpio.setMode(m_iIOPin, GpioBackend::MODE_OUTPUT);
+    m_oGpio.setMode(m_iClkPin, GpioBackend::MODE_OUTPUT);
+    if (m_oGpio.waveSend(iWave) < 0) {
+        return false;
+    }
+    // ~8 ms on the wire, sleep rather than spin until DMA is done
+    while (m_oGpio.waveBusy()) {
+        m_oGpio.delay(1000);
+    }
+    return true;
+}
+
+template <size_t DIGITS, typename Layout>
+int addons::BasicTM1637<DIGITS, Layout>::compileWave(const Frame& aFrame) {
+    const uint32_t uiClk = 1u << m_iClkPin;
+    const uint32_t uiDio = 1u << m_iIOPin;
+    std::vector<GpioBackend::Pulse> vPulses;
+
+    // Same edges and delays as startTransmission/writeByte/stopTransmission
+    const uint32_t uiEdge = m_oTiming.uiEdgeUs;
+    const uint32_t uiHalf = m_oTiming.uiHalfBitUs;
+    auto start = [&]() {
+        vPulses.push_back({uiClk | uiDio, 0, uiEdge});
+        vPulses.push_back({0, uiDio, uiEdge});
+        vPulses.push_back({0, uiClk, 0});
+    };
+    auto stop = [&]() {
+        vPulses.push_back({0, uiClk | uiDio, uiEdge});
+        vPulses.push_back({uiClk, 0, uiEdge});
+        vPulses.push_back({uiDio, 0, 0});
+    };
+    auto byte = [&](char cByte) {
+        for (int i = 0; i < 8; i++) {
+            bool bBit = cByte & (1 << i);
+            vPulses.push_back({0, uiClk, uiHalf});
+            vPulses.push_back({bBit ? uiDio : 0, bBit ? 0 : uiDio, uiHalf});
+            vPulses.push_back({uiClk, 0, uiHalf});
+        }
+        // ACK clock: hold DIO LOW so the output never fights the module's ACK
+        vPulses.push_back({0, uiClk | uiDio, uiHalf});
+        vPulses.push_back({uiClk, 0, uiHalf});
+        vPulses.push_back({0, uiClk, uiHalf});
+    };
+
+    start();
+    byte(AUTO_ADDRESS_MODE);
+    stop();
+
+    start();
+    byte(ADDRESS_OF_FIRST);
+    for (size_t i = 0; i < DIGITS; i++) {
+        byte(aFrame[i]);
+    }
+    stop();
+
+    return m_oGpio.waveCreate(vPulses);
 }
 
-void addons::TM1637::stopTransmission() {
-    gpioSetMode(m_iIOPin, PI_OUTPUT);
-    gpioWrite(m_iClkPin, 0);
-    gpioWrite(m_iIOPin, 0);
-    gpioDelay(10);
-    gpioWrite(m_iClkPin, 1);
-    gpioDelay(10);
-    gpioWrite(m_iIOPin, 1);
+template <size_t DIGITS, typename Layout>
+void addons::BasicTM1637<DIGITS, Layout>::clearWaves() {
+    for (const auto& oWave : m_mWaves) {
+        m_oGpio.waveDelete(oWave.second);
+    }
+    m_mWaves.clear();
+    m_dWaveOrder.clear();
 }
 
-bool addons::TM1637::writeByte(char cByte) {
+template <size_t DIGITS, typename Layout>
+bool addons::BasicTM1637<DIGITS, Layout>::writeByte(char cByte) {
     char cMask = 0x01;
     for (int i = 0; i < 8; i++) {
-        gpioWrite(m_iClkPin, 0);
-        gpioDelay(50);
+        m_oGpio.write(m_iClkPin, 0);
+        m_oGpio.delay(m_oTiming.uiHalfBitUs);
 
-        gpioWrite(m_iIOPin, (cByte & cMask)? 1: 0);
+        m_oGpio.write(m_iIOPin, (cByte & cMask)? 1: 0);
 
         cMask <<= 1;
-        gpioDelay(50);
-        gpioWrite(m_iClkPin, 1);
-        gpioDelay(50);
+        m_oGpio.delay(m_oTiming.uiHalfBitUs);
+        m_oGpio.write(m_iClkPin, 1);
+        m_oGpio.delay(m_oTiming.uiHalfBitUs);
     }
 
     bool bAck = false;
-    gpioSetMode(m_iIOPin, PI_INPUT);
-    gpioWrite(m_iClkPin, 0);
-    gpioWrite(m_iIOPin, 0);
-    gpioDelay(50);
-    for (int i=1; i<=50; i++) {
-        if (0==gpioRead(m_iIOPin)) {
+    m_oGpio.setMode(m_iIOPin, GpioBackend::MODE_INPUT);
+    m_oGpio.write(m_iClkPin, 0);
+    m_oGpio.write(m_iIOPin, 0);
+    m_oGpio.delay(m_oTiming.uiHalfBitUs);
+    for (uint32_t i = 1; i <= m_oTiming.uiAckPolls; i++) {
+        if (0==m_oGpio.read(m_iIOPin)) {
             bAck = true;
             break;
         }
-        gpioDelay(20);
+        m_oGpio.delay(m_oTiming.uiAckPollUs);
     }
 
-    gpioWrite(m_iClkPin, 1);
-    gpioSetMode(m_iIOPin, PI_OUTPUT);
-    gpioDelay(50);
-    gpioWrite(m_iClkPin, 0);
-    gpioDelay(50);
+    m_oGpio.write(m_iClkPin, 1);
+    m_oGpio.setMode(m_iIOPin, GpioBackend::MODE_OUTPUT);
+    m_oGpio.delay(m_oTiming.uiHalfBitUs);
+    m_oGpio.write(m_iClkPin, 0);
+    m_oGpio.delay(m_oTiming.uiHalfBitUs);
+    if (!bAck) {
+        g_oAckFailures.inc();
+    }
     return bAck;
 }
 
-char addons::TM1637::charToSignal(int iPos, char ch) {
-    char cSig = 0x0;
-    if (CHARS_TO_SIGNAL.count(std::toupper(ch))) {
-        cSig = CHARS_TO_SIGNAL[std::toupper(ch)];
-    } else {
-        std::stringstream ss;
-        ss << "Char is not in list: " << ch << ".";
-        Logger::log(LOG_WARNING, ss.str());
-    }
-
-    if (1==iPos && m_bPoints) {
-        // DP ony supported at center
-        cSig |= SegDP;
-    }
-
-    return cSig;
-}
\ No newline at end of file
+template class addons::BasicTM1637<4, addons::ColonLayout>;
+template class addons::BasicTM1637<6, addons::DecimalLayout>;
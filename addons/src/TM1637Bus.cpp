@@ -0,0 +1,306 @@
+#include "TM1637Bus.h"
+#include "logger.h"
+#include "metrics.h"
+
+#include <sys/syslog.h>
+
+namespace {
+
+metrics::Histogram g_oBusDuration("tm1637_bus_display_duration_seconds",
+                                  "Transmission time of a refresh of the modules sharing a TM1637 clock",
+                                  {0.0005, 0.001, 0.002, 0.004, 0.008, 0.016, 0.032, 0.064});
+
+metrics::Counter g_oBusAckFailures("tm1637_bus_ack_failures_total",
+                                   "Transmissions a module on a shared TM1637 clock did not fully ACK");
+metrics::Counter g_oBusTimingFallbacks("tm1637_bus_timing_fallbacks_total",
+                                       "Shared TM1637 clock slow downs after missed ACKs");
+
+}
+
+template <size_t DIGITS, typename Layout>
+addons::BasicTM1637Bus<DIGITS, Layout>::BasicTM1637Bus(int iClkPin, const std::vector<int>& vIOPins,
+                                                       GpioBackend& oGpio)
+    : m_oGpio(oGpio) {
+    uint32_t uiUsed = 0;
+    m_bValid = iClkPin >= 0 && iClkPin < 32;
+    if (m_bValid) {
+        m_uiClk = 1u << iClkPin;
+        uiUsed = m_uiClk;
+    }
+    for (int iPin : vIOPins) {
+        if (iPin < 0 || iPin >= 32 || (uiUsed & (1u << iPin))) {
+            m_bValid = false;
+            continue;
+        }
+        uiUsed |= 1u << iPin;
+        Module oModule;
+        oModule.uiDio = 1u << iPin;
+        m_vModules.push_back(oModule);
+    }
+
+    if (!m_bValid) {
+        LOGGER_LOG(LOG_ERR, "TM1637Bus| Invalid pins, CLK: [", iClkPin, "], modules: [", vIOPins.size(), "]");
+        return;
+    }
+
+    // Idle: every DIO and the clock high
+    uint32_t uiDios = uiUsed & ~m_uiClk;
+    m_oGpio.writeBank(uiUsed, 0);
+    setModes(uiDios, GpioBackend::MODE_OUTPUT);
+    m_oGpio.setMode(iClkPin, GpioBackend::MODE_OUTPUT);
+}
+
+template <size_t DIGITS, typename Layout>
+addons::BasicTM1637Bus<DIGITS, Layout>::~BasicTM1637Bus() {}
+
+template <size_t DIGITS, typename Layout>
+bool addons::BasicTM1637Bus<DIGITS, Layout>::valid() const {
+    return m_bValid;
+}
+
+template <size_t DIGITS, typename Layout>
+size_t addons::BasicTM1637Bus<DIGITS, Layout>::size() const {
+    return m_vModules.size();
+}
+
+template <size_t DIGITS, typename Layout>
+void addons::BasicTM1637Bus<DIGITS, Layout>::setBrightness(size_t uiModule, int iBr) {
+    if (uiModule >= m_vModules.size() || iBr < 0 || iBr > 7) {
+        LOGGER_LOG(LOG_ERR, "TM1637Bus| Invalid brightness level: ", iBr, " of module: ", uiModule);
+        return;
+    }
+    m_vModules[uiModule].iBrightness = iBr;
+}
+
+template <size_t DIGITS, typename Layout>
+void addons::BasicTM1637Bus<DIGITS, Layout>::setFrame(size_t uiModule, const Frame& aGlyphs, bool bDots) {
+    if (uiModule >= m_vModules.size()) {
+        LOGGER_LOG(LOG_ERR, "TM1637Bus| Invalid module: ", uiModule);
+        return;
+    }
+    m_vModules[uiModule].aGlyphs = aGlyphs;
+    m_vModules[uiModule].bPoints = bDots;
+}
+
+template <size_t DIGITS, typename Layout>
+void addons::BasicTM1637Bus<DIGITS, Layout>::setText(size_t uiModule, const std::string& sData, bool bDots) {
+    Frame aGlyphs;
+    size_t uiDigits = segments::encode<DIGITS, Layout::FOLD_DOTS>(sData.data(), sData.size(), aGlyphs);
+    if (uiDigits > DIGITS) {
+        LOGGER_LOG(LOG_ERR, "TM1637Bus| Invalid data to display: [", sData, "], length: [", sData.size(), "]");
+        return;
+    }
+    setFrame(uiModule, aGlyphs, bDots);
+}
+
+template <size_t DIGITS, typename Layout>
+bool addons::BasicTM1637Bus<DIGITS, Layout>::display() {
+    if (!m_bValid) {
+        return false;
+    }
+
+    // Modules that need their digits, their display control or both
+    uint32_t uiFrames = 0;
+    uint32_t uiControls = 0;
+    for (Module& oModule : m_vModules) {
+        if (!oModule.bSentValid || oModule.frame() != oModule.aSentFrame) {
+            uiFrames |= oModule.uiDio;
+        }
+        if (!oModule.bSentValid || oModule.iSentBrightness != oModule.iBrightness) {
+            uiControls |= oModule.uiDio;
+        }
+    }
+    uint32_t uiPending = uiFrames | uiControls;
+    if (!uiPending) {
+        return true;
+    }
+
+    uint32_t uiStartTick = m_oGpio.tick();
+    uint32_t uiFailed = uiPending;
+    for (int iAtt = 3; iAtt > 0 && uiFailed; --iAtt) {
+        LOGGER_LOG(LOG_DEBUG, "TM1637Bus| Display attempt: [", iAtt, "]");
+        uiFailed &= ~transmit(uiFrames & uiFailed, uiControls & uiFailed);
+
+        TM1637Timing oSlower;
+        if (uiFailed && m_oTiming.slower(oSlower)) {
+            LOGGER_LOG(LOG_WARNING, "TM1637Bus| Missed ACKs, slowing the bus down to a half bit of [",
+                       oSlower.uiHalfBitUs, "] us");
+            m_oTiming = oSlower;
+            g_oBusTimingFallbacks.inc();
+        }
+    }
+    g_oBusDuration.observe(static_cast<uint64_t>(m_oGpio.tick() - uiStartTick) * 1000);
+
+    for (Module& oModule : m_vModules) {
+        if (!(uiPending & oModule.uiDio)) {
+            continue;
+        }
+        oModule.bAcked = !(uiFailed & oModule.uiDio);
+        if (oModule.bAcked) {
+            oModule.aSentFrame = oModule.frame();
+            oModule.iSentBrightness = oModule.iBrightness;
+            oModule.bSentValid = true;
+        } else {
+            // Unknown what the module latched, resend everything next time
+            oModule.bSentValid = false;
+            g_oBusAckFailures.inc();
+        }
+    }
+    return !uiFailed;
+}
+
+template <size_t DIGITS, typename Layout>
+bool addons::BasicTM1637Bus<DIGITS, Layout>::acked(size_t uiModule) const {
+    return uiModule < m_vModules.size() && m_vModules[uiModule].bAcked;
+}
+
+template <size_t DIGITS, typename Layout>
+void addons::BasicTM1637Bus<DIGITS, Layout>::invalidate() {
+    for (Module& oModule : m_vModules) {
+        oModule.bSentValid = false;
+    }
+}
+
+template <size_t DIGITS, typename Layout>
+void addons::BasicTM1637Bus<DIGITS, Layout>::setTiming(const TM1637Timing& oTiming) {
+    m_oTiming = oTiming;
+}
+
+template <size_t DIGITS, typename Layout>
+const addons::TM1637Timing& addons::BasicTM1637Bus<DIGITS, Layout>::timing() const {
+    return m_oTiming;
+}
+
+template <size_t DIGITS, typename Layout>
+typename addons::BasicTM1637Bus<DIGITS, Layout>::Frame addons::BasicTM1637Bus<DIGITS, Layout>::Module::frame() const {
+    Frame aFrame = aGlyphs;
+    for (size_t i = 0; i < DIGITS; i++) {
+        if (bPoints && (Layout::POINTS >> i & 1)) {
+            aFrame[i] |= segments::SegDP;
+        }
+    }
+    return aFrame;
+}
+
+template <size_t DIGITS, typename Layout>
+uint32_t addons::BasicTM1637Bus<DIGITS, Layout>::transmit(uint32_t uiFrames, uint32_t uiControls) {
+    GpioBackend::Batch oBatch(m_oGpio);
+    // A module missing any ACK drops out of the result
+    uint32_t uiAcked = uiFrames | uiControls;
+
+    if (uiFrames) {
+        startTransmission(uiFrames);
+        uiAcked &= writeByte(uiFrames, 0) | ~uiFrames;
+        stopTransmission(uiFrames);
+
+        startTransmission(uiFrames);
+        uiAcked &= writeByte(uiFrames, 1) | ~uiFrames;
+        for (size_t i = 0; i < DIGITS; i++) {
+            uiAcked &= writeByte(uiFrames, 2 + i) | ~uiFrames;
+            m_oGpio.delay(m_oTiming.uiDigitGapUs);
+        }
+        stopTransmission(uiFrames);
+    }
+
+    if (uiControls) {
+        startTransmission(uiControls);
+        uiAcked &= writeByte(uiControls, BYTES - 1) | ~uiControls;
+        stopTransmission(uiControls);
+    }
+
+    return uiAcked;
+}
+
+template <size_t DIGITS, typename Layout>
+void addons::BasicTM1637Bus<DIGITS, Layout>::startTransmission(uint32_t uiDios) {
+    setModes(uiDios, GpioBackend::MODE_OUTPUT);
+    m_oGpio.writeBank(uiDios | m_uiClk, 0);
+    m_oGpio.delay(m_oTiming.uiEdgeUs);
+    m_oGpio.writeBank(0, uiDios);
+    m_oGpio.delay(m_oTiming.uiEdgeUs);
+    m_oGpio.writeBank(0, m_uiClk);
+}
+
+template <size_t DIGITS, typename Layout>
+void addons::BasicTM1637Bus<DIGITS, Layout>::stopTransmission(uint32_t uiDios) {
+    setModes(uiDios, GpioBackend::MODE_OUTPUT);
+    // CLK first: DIO falling while CLK is high would be a start condition
+    m_oGpio.writeBank(0, m_uiClk);
+    m_oGpio.writeBank(0, uiDios);
+    m_oGpio.delay(m_oTiming.uiEdgeUs);
+    m_oGpio.writeBank(m_uiClk, 0);
+    m_oGpio.delay(m_oTiming.uiEdgeUs);
+    m_oGpio.writeBank(uiDios, 0);
+}
+
+template <size_t DIGITS, typename Layout>
+uint32_t addons::BasicTM1637Bus<DIGITS, Layout>::writeByte(uint32_t uiDios, size_t uiByte) {
+    // DIO bits to set for each bit of the byte, LSB first
+    std::array<uint32_t, 8> aOnes {};
+    for (const Module& oModule : m_vModules) {
+        if (!(uiDios & oModule.uiDio)) {
+            continue;
+        }
+        uint8_t uiValue = byteOf(oModule, uiByte);
+        for (int i = 0; i < 8; i++) {
+            if (uiValue & (1 << i)) {
+                aOnes[i] |= oModule.uiDio;
+            }
+        }
+    }
+
+    for (int i = 0; i < 8; i++) {
+        m_oGpio.writeBank(0, m_uiClk);
+        m_oGpio.delay(m_oTiming.uiHalfBitUs);
+
+        m_oGpio.writeBank(aOnes[i], uiDios & ~aOnes[i]);
+
+        m_oGpio.delay(m_oTiming.uiHalfBitUs);
+        m_oGpio.writeBank(m_uiClk, 0);
+        m_oGpio.delay(m_oTiming.uiHalfBitUs);
+    }
+
+    uint32_t uiAcked = 0;
+    // DIO is released to the modules, clearing its latch changes no line
+    setModes(uiDios, GpioBackend::MODE_INPUT);
+    m_oGpio.writeBank(0, m_uiClk | uiDios);
+    m_oGpio.delay(m_oTiming.uiHalfBitUs);
+    for (uint32_t i = 1; i <= m_oTiming.uiAckPolls; i++) {
+        uiAcked |= ~m_oGpio.readBank() & uiDios;
+        if (uiAcked == uiDios) {
+            break;
+        }
+        m_oGpio.delay(m_oTiming.uiAckPollUs);
+    }
+
+    m_oGpio.writeBank(m_uiClk, 0);
+    setModes(uiDios, GpioBackend::MODE_OUTPUT);
+    m_oGpio.delay(m_oTiming.uiHalfBitUs);
+    m_oGpio.writeBank(0, m_uiClk);
+    m_oGpio.delay(m_oTiming.uiHalfBitUs);
+    return uiAcked;
+}
+
+template <size_t DIGITS, typename Layout>
+void addons::BasicTM1637Bus<DIGITS, Layout>::setModes(uint32_t uiDios, unsigned uiMode) {
+    for (unsigned uiPin = 0; uiDios; ++uiPin, uiDios >>= 1) {
+        if (uiDios & 1) {
+            m_oGpio.setMode(uiPin, uiMode);
+        }
+    }
+}
+
+template <size_t DIGITS, typename Layout>
+uint8_t addons::BasicTM1637Bus<DIGITS, Layout>::byteOf(const Module& oModule, size_t uiByte) const {
+    if (uiByte == 0) {
+        return AUTO_ADDRESS_MODE;
+    } else if (uiByte == 1) {
+        return ADDRESS_OF_FIRST;
+    } else if (uiByte < BYTES - 1) {
+        return oModule.frame()[uiByte - 2];
+    }
+    return DISPLAY_ON + oModule.iBrightness;
+}
+
+template class addons::BasicTM1637Bus<4, addons::ColonLayout>;
+template class addons::BasicTM1637Bus<6, addons::DecimalLayout>;
@@ -0,0 +1,119 @@
+#include "TM1637Timing.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sys/syslog.h>
+
+#include "logger.h"
+
+namespace {
+
+const addons::TM1637Timing CONSERVATIVE;
+
+uint32_t scaled(uint32_t uiValue, uint32_t uiFactor, uint32_t uiLimit) {
+    return std::min(std::max<uint32_t>(uiValue, 1) * uiFactor, uiLimit);
+}
+
+}
+
+bool addons::TM1637Timing::slower(TM1637Timing& oSlower) const {
+    oSlower = withMargin(2);
+    return oSlower != *this;
+}
+
+addons::TM1637Timing addons::TM1637Timing::withMargin(uint32_t uiFactor) const {
+    TM1637Timing oTiming;
+    oTiming.uiEdgeUs = scaled(uiEdgeUs, uiFactor, CONSERVATIVE.uiEdgeUs);
+    oTiming.uiHalfBitUs = scaled(uiHalfBitUs, uiFactor, CONSERVATIVE.uiHalfBitUs);
+    oTiming.uiAckPollUs = scaled(uiAckPollUs, uiFactor, CONSERVATIVE.uiAckPollUs);
+    oTiming.uiAckPolls = scaled(uiAckPolls, uiFactor, CONSERVATIVE.uiAckPolls);
+    oTiming.uiDigitGapUs = scaled(uiDigitGapUs, uiFactor, CONSERVATIVE.uiDigitGapUs);
+    return oTiming;
+}
+
+uint32_t addons::TM1637Timing::frameUs(size_t uiDigits) const {
+    // Data command, then address and digits, each byte eight bit clocks and
+    // the ACK clock
+    uint32_t uiByteUs = 3 * 8 * uiHalfBitUs + 3 * uiHalfBitUs;
+    uint32_t uiGroupUs = 4 * uiEdgeUs;
+    return 2 * uiGroupUs + static_cast<uint32_t>(uiDigits + 2) * uiByteUs +
+           static_cast<uint32_t>(uiDigits) * uiDigitGapUs;
+}
+
+bool addons::TM1637Timing::operator==(const TM1637Timing& oOther) const {
+    return uiEdgeUs == oOther.uiEdgeUs && uiHalfBitUs == oOther.uiHalfBitUs &&
+           uiAckPollUs == oOther.uiAckPollUs && uiAckPolls == oOther.uiAckPolls &&
+           uiDigitGapUs == oOther.uiDigitGapUs;
+}
+
+bool addons::TM1637Timing::operator!=(const TM1637Timing& oOther) const {
+    return !(*this == oOther);
+}
+
+bool addons::TM1637TimingProfile::load(const std::string& sPath) {
+    std::ifstream oFile(sPath);
+    if (!oFile) {
+        return false;
+    }
+
+    m_mTimings.clear();
+    std::string sLine;
+    while (std::getline(oFile, sLine)) {
+        if (sLine.empty() || sLine[0] == '#') {
+            continue;
+        }
+        int iClkPin, iIOPin;
+        TM1637Timing oTiming;
+        if (std::sscanf(sLine.c_str(), "%d,%d=%u,%u,%u,%u,%u", &iClkPin, &iIOPin, &oTiming.uiEdgeUs,
+                        &oTiming.uiHalfBitUs, &oTiming.uiAckPollUs, &oTiming.uiAckPolls,
+                        &oTiming.uiDigitGapUs) != 7) {
+            LOGGER_LOG(LOG_WARNING, "TM1637Timing| Ignoring line of [", sPath, "]: [", sLine, "]");
+            continue;
+        }
+        // Never slower than the defaults, whatever the file says
+        m_mTimings[{iClkPin, iIOPin}] = oTiming.withMargin(1);
+    }
+    return true;
+}
+
+bool addons::TM1637TimingProfile::save(const std::string& sPath) const {
+    // Written aside and renamed, a crash never leaves half a profile
+    std::string sTmpPath = sPath + ".tmp";
+    std::ofstream oFile(sTmpPath, std::ios::trunc);
+    if (!oFile) {
+        LOGGER_LOG(LOG_ERR, "TM1637Timing| Failed to open [", sTmpPath, "]: ", std::strerror(errno));
+        return false;
+    }
+
+    oFile << "# CLK,DIO=edge_us,half_bit_us,ack_poll_us,ack_polls,digit_gap_us\n";
+    for (const auto& oEntry : m_mTimings) {
+        const TM1637Timing& oTiming = oEntry.second;
+        oFile << oEntry.first.first << ',' << oEntry.first.second << '='
+              << oTiming.uiEdgeUs << ',' << oTiming.uiHalfBitUs << ',' << oTiming.uiAckPollUs << ','
+              << oTiming.uiAckPolls << ',' << oTiming.uiDigitGapUs << '\n';
+    }
+    oFile.close();
+
+    if (!oFile || std::rename(sTmpPath.c_str(), sPath.c_str()) != 0) {
+        LOGGER_LOG(LOG_ERR, "TM1637Timing| Failed to write [", sPath, "]: ", std::strerror(errno));
+        std::remove(sTmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool addons::TM1637TimingProfile::find(int iClkPin, int iIOPin, TM1637Timing& oTiming) const {
+    auto it = m_mTimings.find({iClkPin, iIOPin});
+    if (it == m_mTimings.end()) {
+        return false;
+    }
+    oTiming = it->second;
+    return true;
+}
+
+void addons::TM1637TimingProfile::set(int iClkPin, int iIOPin, const TM1637Timing& oTiming) {
+    m_mTimings[{iClkPin, iIOPin}] = oTiming;
+}
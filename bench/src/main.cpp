@@ -0,0 +1,774 @@
+#include <algorithm>
+#include <atomic>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <getopt.h>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <sys/syslog.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#include "DHT11.h"
+#include "GpioBackend.h"
+#include "PageFrames.h"
+#include "SegmentFont.h"
+#include "SimDevices.h"
+#include "SimGpioBackend.h"
+#include "TM1637.h"
+#include "TM1637Bus.h"
+#include "logger.h"
+#include "reading_filter.h"
+#include "sample_bus.h"
+
+class BenchConfig {
+public:
+    std::string m_sOutputPath; // empty - stdout
+    std::string m_sFilter;     // empty - every benchmark
+    bool m_bAsyncLog = false;
+    double m_dBatchSeconds = 0.05;
+    int m_iLogRecords = 10000; // per thread
+};
+
+// Heap allocations of the whole process, for allocs_per_op. Every form of
+// new and delete is replaced, so arrays, nothrow and over-aligned allocations
+// count too. Out of line, so the compiler never pairs an inlined malloc with
+// an operator delete it can't see through.
+std::atomic<uint64_t> g_ullAllocations {0};
+
+namespace {
+
+__attribute__((noinline)) void* allocate(size_t uiSize, size_t uiAlign) noexcept {
+    g_ullAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (uiAlign <= alignof(std::max_align_t)) {
+        return std::malloc(uiSize ? uiSize : 1);
+    }
+    void* pMem = nullptr;
+    return posix_memalign(&pMem, uiAlign, uiSize ? uiSize : 1) == 0 ? pMem : nullptr;
+}
+
+__attribute__((noinline)) void* allocateOrThrow(size_t uiSize, size_t uiAlign) {
+    if (void* pMem = allocate(uiSize, uiAlign)) {
+        return pMem;
+    }
+    throw std::bad_alloc();
+}
+
+}
+
+__attribute__((noinline)) void* operator new(size_t uiSize) {
+    return allocateOrThrow(uiSize, 0);
+}
+
+__attribute__((noinline)) void* operator new[](size_t uiSize) {
+    return allocateOrThrow(uiSize, 0);
+}
+
+__attribute__((noinline)) void* operator new(size_t uiSize, std::align_val_t eAlign) {
+    return allocateOrThrow(uiSize, static_cast<size_t>(eAlign));
+}
+
+__attribute__((noinline)) void* operator new[](size_t uiSize, std::align_val_t eAlign) {
+    return allocateOrThrow(uiSize, static_cast<size_t>(eAlign));
+}
+
+__attribute__((noinline)) void* operator new(size_t uiSize, const std::nothrow_t&) noexcept {
+    return allocate(uiSize, 0);
+}
+
+__attribute__((noinline)) void* operator new[](size_t uiSize, const std::nothrow_t&) noexcept {
+    return allocate(uiSize, 0);
+}
+
+__attribute__((noinline)) void* operator new(size_t uiSize, std::align_val_t eAlign, const std::nothrow_t&) noexcept {
+    return allocate(uiSize, static_cast<size_t>(eAlign));
+}
+
+__attribute__((noinline)) void* operator new[](size_t uiSize, std::align_val_t eAlign, const std::nothrow_t&) noexcept {
+    return allocate(uiSize, static_cast<size_t>(eAlign));
+}
+
+// posix_memalign memory is released by free as well
+__attribute__((noinline)) void operator delete(void* pMem) noexcept {
+    std::free(pMem);
+}
+
+__attribute__((noinline)) void operator delete[](void* pMem) noexcept {
+    std::free(pMem);
+}
+
+__attribute__((noinline)) void operator delete(void* pMem, size_t) noexcept {
+    std::free(pMem);
+}
+
+__attribute__((noinline)) void operator delete[](void* pMem, size_t) noexcept {
+    std::free(pMem);
+}
+
+__attribute__((noinline)) void operator delete(void* pMem, std::align_val_t) noexcept {
+    std::free(pMem);
+}
+
+__attribute__((noinline)) void operator delete[](void* pMem, std::align_val_t) noexcept {
+    std::free(pMem);
+}
+
+__attribute__((noinline)) void operator delete(void* pMem, size_t, std::align_val_t) noexcept {
+    std::free(pMem);
+}
+
+__attribute__((noinline)) void operator delete[](void* pMem, size_t, std::align_val_t) noexcept {
+    std::free(pMem);
+}
+
+__attribute__((noinline)) void operator delete(void* pMem, const std::nothrow_t&) noexcept {
+    std::free(pMem);
+}
+
+__attribute__((noinline)) void operator delete[](void* pMem, const std::nothrow_t&) noexcept {
+    std::free(pMem);
+}
+
+__attribute__((noinline)) void operator delete(void* pMem, std::align_val_t, const std::nothrow_t&) noexcept {
+    std::free(pMem);
+}
+
+__attribute__((noinline)) void operator delete[](void* pMem, std::align_val_t, const std::nothrow_t&) noexcept {
+    std::free(pMem);
+}
+
+// Keeps the compiler from dropping a computation whose result is unused.
+template <typename T>
+inline void keep(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// One JSON object per benchmark: a name and numeric fields.
+class Results {
+public:
+    typedef std::vector<std::pair<std::string, double>> Fields;
+
+    void add(const std::string& sName, const Fields& vFields) {
+        m_vResults.emplace_back(sName, vFields);
+        std::cerr << sName;
+        for (const auto& oField : vFields) {
+            std::cerr << "  " << oField.first << "=" << oField.second;
+        }
+        std::cerr << "\n";
+    }
+
+    void write(FILE* pOut) const {
+        std::fprintf(pOut, "{\n  \"context\": {\"compiler\": \"%s\", \"cpus\": %u, \"time\": %lld},\n",
+                     __VERSION__, std::thread::hardware_concurrency(), static_cast<long long>(time(nullptr)));
+        std::fprintf(pOut, "  \"benchmarks\": [\n");
+        for (size_t i = 0; i < m_vResults.size(); ++i) {
+            std::fprintf(pOut, "    {\"name\": \"%s\"", m_vResults[i].first.c_str());
+            for (const auto& oField : m_vResults[i].second) {
+                std::fprintf(pOut, ", \"%s\": %.6g", oField.first.c_str(), oField.second);
+            }
+            std::fprintf(pOut, "}%s\n", i + 1 < m_vResults.size() ? "," : "");
+        }
+        std::fprintf(pOut, "  ]\n}\n");
+    }
+
+private:
+    std::vector<std::pair<std::string, Fields>> m_vResults;
+};
+
+// Median ns per call of fn over 5 batches of ~dBatchSeconds each. The timed
+// batches' heap allocations per call go to pAllocsPerOp.
+template <typename Fn>
+double nsPerOp(Fn&& fn, double dBatchSeconds, uint64_t& ullIterations, double* pAllocsPerOp = nullptr) {
+    typedef std::chrono::steady_clock Clock;
+
+    auto timeBatch = [&](uint64_t ullCount) {
+        auto start = Clock::now();
+        for (uint64_t i = 0; i < ullCount; ++i) {
+            fn();
+        }
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    };
+
+    fn();  // first calls may initialise locales, caches...
+
+    uint64_t ullCount = 1;
+    double dSeconds = timeBatch(ullCount);
+    while (dSeconds < dBatchSeconds / 10) {
+        ullCount *= 2;
+        dSeconds = timeBatch(ullCount);
+    }
+    ullCount = std::max<uint64_t>(1, ullCount * (dBatchSeconds / dSeconds));
+
+    std::array<double, 5> aNs;
+    uint64_t ullAllocations = g_ullAllocations.load(std::memory_order_relaxed);
+    for (double& dNs : aNs) {
+        dNs = timeBatch(ullCount) * 1e9 / ullCount;
+    }
+    std::sort(aNs.begin(), aNs.end());
+    ullIterations = ullCount * aNs.size();
+    if (pAllocsPerOp) {
+        *pAllocsPerOp = static_cast<double>(g_ullAllocations.load(std::memory_order_relaxed) - ullAllocations) /
+                        ullIterations;
+    }
+    return aNs[aNs.size() / 2];
+}
+
+// GPIO layer that only counts what the drivers ask for. Reads return LOW, so
+// every TM1637 byte is ACKed, and delays add to the would-be bus time.
+class CountingGpio : public addons::GpioBackend {
+public:
+    struct Counts {
+        uint64_t ullModes = 0;
+        uint64_t ullWrites = 0;
+        uint64_t ullReads = 0;
+        uint64_t ullDelays = 0;
+        uint64_t ullDelayUs = 0;
+
+        uint64_t ops() const {
+            return ullModes + ullWrites + ullReads + ullDelays;
+        }
+    };
+
+    const char* name() const override { return "counting"; }
+    int initialise() override { return 0; }
+    void terminate() override {}
+
+    int setMode(unsigned, unsigned) override { ++m_oCounts.ullModes; return 0; }
+    int setPullUpDown(unsigned, unsigned) override { ++m_oCounts.ullModes; return 0; }
+    int read(unsigned) override { ++m_oCounts.ullReads; return 0; }
+    int write(unsigned, unsigned) override { ++m_oCounts.ullWrites; return 0; }
+    uint32_t readBank() override { ++m_oCounts.ullReads; return 0; }
+    int writeBank(uint32_t, uint32_t) override { ++m_oCounts.ullWrites; return 0; }
+
+    uint32_t tick() override { return static_cast<uint32_t>(m_oCounts.ullDelayUs); }
+    uint32_t delay(uint32_t uiMicros) override {
+        ++m_oCounts.ullDelays;
+        m_oCounts.ullDelayUs += uiMicros;
+        return uiMicros;
+    }
+
+    Counts m_oCounts;
+};
+
+// Edge timestamps of a DHT11 frame carrying data, pulses jittered by +-iJitter us.
+std::array<uint32_t, addons::DHT11::FRAME_EDGES> makeFrame(uint64_t data, std::mt19937& oRng, int iJitter) {
+    std::uniform_int_distribution<int> oJitter(-iJitter, iJitter);
+    std::array<uint32_t, addons::DHT11::FRAME_EDGES> aTicks;
+    uint32_t uiTick = oRng();
+    size_t uiEdge = 0;
+    auto edge = [&](int iWidth) {
+        aTicks[uiEdge++] = uiTick;
+        uiTick += iWidth + oJitter(oRng);
+    };
+
+    edge(80);  // response LOW
+    edge(80);  // response HIGH
+    for (int i = 39; i >= 0; --i) {
+        edge(50);
+        edge((data >> i) & 1 ? 70 : 26);
+    }
+    edge(50);  // end of frame
+    return aTicks;
+}
+
+void benchDht11(const BenchConfig& oConf, Results& oResults) {
+    std::mt19937 oRng(11);
+    std::vector<std::array<uint32_t, addons::DHT11::FRAME_EDGES>> vFrames;
+    for (int i = 0; i < 64; ++i) {
+        uint8_t uiHum = 20 + i % 60;
+        uint8_t uiTemp = 10 + i % 25;
+        uint64_t data = (static_cast<uint64_t>(uiHum) << 32) | (static_cast<uint64_t>(uiTemp) << 16) |
+                        static_cast<uint8_t>(uiHum + uiTemp);
+        vFrames.push_back(makeFrame(data, oRng, 4));
+    }
+
+    uint64_t ullIterations = 0;
+    size_t uiNext = 0;
+    uint64_t ullOk = 0;
+    double dNs = nsPerOp([&] {
+        const auto& aTicks = vFrames[uiNext++ & 63];
+        float fTemp, fHum;
+        uint64_t data = addons::DHT11::decodeEdges(aTicks.data(), aTicks.size());
+        ullOk += addons::DHT11::parseFrame(data, fTemp, fHum) == addons::DHT11::STATUS_OK;
+        keep(fTemp);
+    }, oConf.m_dBatchSeconds, ullIterations);
+    oResults.add("dht11.decode_frame", {{"ns_per_op", dNs}, {"iterations", ullIterations},
+                                        {"ok_ratio", static_cast<double>(ullOk) / (uiNext ? uiNext : 1)}});
+
+    // Alert callback path: every edge of a frame through captureEdge()
+    addons::DHT11::EdgeCapture oCapture;
+    dNs = nsPerOp([&] {
+        const auto& aTicks = vFrames[uiNext++ & 63];
+        oCapture.iCount.store(0, std::memory_order_relaxed);
+        oCapture.uiArmTick = aTicks[0];
+        oCapture.bArmed.store(true, std::memory_order_release);
+        for (size_t i = 0; i < aTicks.size(); ++i) {
+            addons::DHT11::captureEdge(oCapture, i & 1, aTicks[i]);
+        }
+        keep(oCapture.iCount);
+    }, oConf.m_dBatchSeconds, ullIterations);
+    oResults.add("dht11.capture_frame", {{"ns_per_op", dNs}, {"iterations", ullIterations}});
+}
+
+void benchSegments(const BenchConfig& oConf, Results& oResults) {
+    const char* aTexts[] = {"1234", "23*C", "  45", "-5* ", "Run ", "0000", "1759", "99*C"};
+    uint64_t ullIterations = 0;
+    size_t uiNext = 0;
+
+    std::array<uint8_t, 4> aDigits;
+    double dNs = nsPerOp([&] {
+        const char* pText = aTexts[uiNext++ & 7];
+        keep(addons::segments::encode<4, false>(pText, 4, aDigits));
+        keep(aDigits);
+    }, oConf.m_dBatchSeconds, ullIterations);
+    oResults.add("tm1637.encode_4", {{"ns_per_op", dNs}, {"iterations", ullIterations}});
+
+    const char* aDecimals[] = {"12.3456", "0.5", "-12.50", "HELLO.", "1.2.3.4.5.6", "999999"};
+    std::array<uint8_t, 6> aDigits6;
+    dNs = nsPerOp([&] {
+        const char* pText = aDecimals[uiNext++ % 6];
+        keep(addons::segments::encode<6, true>(pText, std::strlen(pText), aDigits6));
+        keep(aDigits6);
+    }, oConf.m_dBatchSeconds, ullIterations);
+    oResults.add("tm1637x6.encode", {{"ns_per_op", dNs}, {"iterations", ullIterations}});
+}
+
+void benchDisplay(const BenchConfig& oConf, Results& oResults) {
+    // Every digit changes, one digit changes, nothing changes
+    const std::vector<std::pair<std::string, std::vector<std::string>>> vCases = {
+        {"tm1637.display_full", {"1234", "5678"}},
+        {"tm1637.display_partial", {"1234", "1235"}},
+        {"tm1637.display_skipped", {"1234"}},
+    };
+
+    for (const auto& oCase : vCases) {
+        CountingGpio oGpio;
+        addons::TM1637 oDisplay(23, 18, oGpio);
+        oDisplay.display(oCase.second[0], true);
+        oGpio.m_oCounts = CountingGpio::Counts();
+
+        uint64_t ullIterations = 0;
+        double dAllocs = 0;
+        size_t uiNext = 1;
+        double dNs = nsPerOp([&] {
+            oDisplay.display(oCase.second[uiNext++ % oCase.second.size()], true);
+        }, oConf.m_dBatchSeconds, ullIterations, &dAllocs);
+
+        // nsPerOp calibrates with extra calls, count per call of all of them
+        uint64_t ullFrames = uiNext - 1;
+        const CountingGpio::Counts& oCounts = oGpio.m_oCounts;
+        oResults.add(oCase.first, {
+            {"ns_per_op", dNs},
+            {"iterations", ullIterations},
+            {"allocs_per_op", dAllocs},
+            {"gpio_ops_per_frame", static_cast<double>(oCounts.ops()) / ullFrames},
+            {"gpio_writes_per_frame", static_cast<double>(oCounts.ullWrites) / ullFrames},
+            {"gpio_reads_per_frame", static_cast<double>(oCounts.ullReads) / ullFrames},
+            {"gpio_modes_per_frame", static_cast<double>(oCounts.ullModes) / ullFrames},
+            {"bus_us_per_frame", static_cast<double>(oCounts.ullDelayUs) / ullFrames},
+        });
+    }
+}
+
+// N modules refreshed one after the other, then together on a shared clock.
+// bus_us_per_refresh is time on the simulated wire, where every GPIO call
+// costs as much as on a Pi, and every module must have latched its frame.
+void benchDisplayBus(const BenchConfig& oConf, Results& oResults) {
+    const int CLK_PIN = 18;
+    const std::array<addons::TM1637::Frame, 2> aFrames = {{{0x06, 0x5B, 0x4F, 0x66}, {0x6D, 0x7D, 0x07, 0x7F}}};
+
+    for (size_t uiModules : {1, 2, 4, 8}) {
+        std::vector<int> vDioPins;
+        for (size_t i = 0; i < uiModules; ++i) {
+            vDioPins.push_back(static_cast<int>(2 + i));
+        }
+
+        for (bool bShared : {false, true}) {
+            addons::SimGpioBackend oSim;
+            std::vector<std::shared_ptr<addons::SimTM1637>> vSimModules;
+            for (int iDio : vDioPins) {
+                vSimModules.push_back(std::make_shared<addons::SimTM1637>(CLK_PIN, iDio));
+                oSim.attach(vSimModules.back(), {static_cast<unsigned>(CLK_PIN), static_cast<unsigned>(iDio)});
+            }
+
+            std::vector<std::unique_ptr<addons::TM1637>> vSingles;
+            std::unique_ptr<addons::TM1637Bus> pBus;
+            if (bShared) {
+                pBus = std::make_unique<addons::TM1637Bus>(CLK_PIN, vDioPins, oSim);
+            } else {
+                for (int iDio : vDioPins) {
+                    vSingles.push_back(std::make_unique<addons::TM1637>(iDio, CLK_PIN, oSim));
+                }
+            }
+
+            size_t uiNext = 0;
+            uint64_t ullFailed = 0;
+            auto refresh = [&] {
+                const addons::TM1637::Frame& aFrame = aFrames[uiNext++ % aFrames.size()];
+                if (pBus) {
+                    for (size_t i = 0; i < uiModules; ++i) {
+                        pBus->setFrame(i, aFrame, false);
+                    }
+                    ullFailed += !pBus->display();
+                } else {
+                    for (auto& pDisplay : vSingles) {
+                        pDisplay->display(aFrame, false);
+                    }
+                }
+            };
+            refresh();
+            uint64_t ullStartNs = oSim.nowNs();
+            size_t uiStart = uiNext;
+
+            uint64_t ullIterations = 0;
+            double dNs = nsPerOp(refresh, oConf.m_dBatchSeconds, ullIterations);
+
+            uint64_t ullRefreshes = uiNext - uiStart;
+            const addons::TM1637::Frame& aLast = aFrames[(uiNext - 1) % aFrames.size()];
+            uint64_t ullLatched = 0;
+            for (const auto& pModule : vSimModules) {
+                ullLatched += std::equal(aLast.begin(), aLast.end(), pModule->segments().begin());
+            }
+
+            oResults.add(std::string(bShared ? "tm1637_bus.shared_clk_" : "tm1637_bus.sequential_") +
+                         std::to_string(uiModules), {
+                {"ns_per_op", dNs},
+                {"iterations", ullIterations},
+                {"bus_us_per_refresh", static_cast<double>(oSim.nowNs() - ullStartNs) / 1000 / ullRefreshes},
+                {"modules_latched", static_cast<double>(ullLatched)},
+                {"failed_refreshes", static_cast<double>(ullFailed)},
+            });
+        }
+    }
+}
+
+void benchPages(const BenchConfig& oConf, Results& oResults) {
+    uint64_t ullIterations = 0;
+    double dAllocs = 0;
+    int iNext = 0;
+    addons::pages::Frame aFrame;
+
+    double dNs = nsPerOp([&] {
+        ++iNext;
+        keep(addons::pages::clockFrame(iNext % 24, iNext % 60));
+    }, oConf.m_dBatchSeconds, ullIterations, &dAllocs);
+    oResults.add("pages.clock", {{"ns_per_op", dNs}, {"iterations", ullIterations}, {"allocs_per_op", dAllocs}});
+
+    dNs = nsPerOp([&] {
+        ++iNext;
+        keep(addons::pages::temperature(static_cast<float>(iNext % 60 - 20), aFrame));
+        keep(aFrame);
+    }, oConf.m_dBatchSeconds, ullIterations, &dAllocs);
+    oResults.add("pages.temperature", {{"ns_per_op", dNs}, {"iterations", ullIterations}, {"allocs_per_op", dAllocs}});
+
+    dNs = nsPerOp([&] {
+        ++iNext;
+        keep(addons::pages::humidity(static_cast<float>(iNext % 100), aFrame));
+        keep(aFrame);
+    }, oConf.m_dBatchSeconds, ullIterations, &dAllocs);
+    oResults.add("pages.humidity", {{"ns_per_op", dNs}, {"iterations", ullIterations}, {"allocs_per_op", dAllocs}});
+
+    // Steady state of the time page: render and send an unchanged frame
+    CountingGpio oGpio;
+    addons::TM1637 oDisplay(23, 18, oGpio);
+    oDisplay.display(addons::pages::clockFrame(12, 34), true);
+    dNs = nsPerOp([&] {
+        oDisplay.display(addons::pages::clockFrame(12, 34), true);
+    }, oConf.m_dBatchSeconds, ullIterations, &dAllocs);
+    oResults.add("pages.clock_display_skipped", {
+        {"ns_per_op", dNs},
+        {"iterations", ullIterations},
+        {"allocs_per_op", dAllocs},
+    });
+}
+
+void benchSampleBus(const BenchConfig& oConf, Results& oResults) {
+    uint64_t ullIterations = 0;
+    SampleBus oBus;
+    SampleBus::Record oRecord;
+    int iNext = 0;
+
+    double dNs = nsPerOp([&] {
+        ++iNext;
+        keep(oBus.publish(iNext & 1, 21.0f, 40.0f, iNext));
+    }, oConf.m_dBatchSeconds, ullIterations);
+    oResults.add("sample_bus.publish", {{"ns_per_op", dNs}, {"iterations", ullIterations}});
+
+    dNs = nsPerOp([&] {
+        keep(oBus.latest(oRecord));
+    }, oConf.m_dBatchSeconds, ullIterations);
+    oResults.add("sample_bus.latest", {{"ns_per_op", dNs}, {"iterations", ullIterations}});
+
+    dNs = nsPerOp([&] {
+        keep(oBus.latestValid(oRecord));
+    }, oConf.m_dBatchSeconds, ullIterations);
+    oResults.add("sample_bus.latest_valid", {{"ns_per_op", dNs}, {"iterations", ullIterations}});
+
+    // Reads racing a writer that publishes as fast as it can
+    std::atomic<bool> bStop {false};
+    std::thread oWriter([&] {
+        for (uint32_t i = 0; !bStop.load(std::memory_order_relaxed); ++i) {
+            oBus.publish(true, 21.0f, 40.0f, i);
+        }
+    });
+    uint64_t ullMissed = 0;
+    dNs = nsPerOp([&] {
+        ullMissed += !oBus.latest(oRecord);
+    }, oConf.m_dBatchSeconds, ullIterations);
+    bStop = true;
+    oWriter.join();
+    oResults.add("sample_bus.latest_contended", {
+        {"ns_per_op", dNs},
+        {"iterations", ullIterations},
+        {"missed", static_cast<double>(ullMissed)},
+    });
+}
+
+// Per reading cost must not depend on the window: compare a short and a long one
+void benchFilter(const BenchConfig& oConf, Results& oResults) {
+    std::mt19937 oRng(7);
+    std::normal_distribution<float> oNoise(21.5f, 0.4f);
+    std::vector<float> vValues(4096);
+    for (float& fValue : vValues) {
+        fValue = oNoise(oRng);
+    }
+
+    for (size_t uiWindow : {10, 1000}) {
+        RollingWindow oWindow(uiWindow);
+        uint64_t ullIterations = 0;
+        double dAllocs = 0;
+        size_t uiNext = 0;
+        double dNs = nsPerOp([&] {
+            oWindow.push(vValues[uiNext++ % vValues.size()]);
+            keep(oWindow.min());
+            keep(oWindow.max());
+            keep(oWindow.mean());
+        }, oConf.m_dBatchSeconds, ullIterations, &dAllocs);
+        oResults.add("filter.rolling_window_" + std::to_string(uiWindow),
+                     {{"ns_per_op", dNs}, {"iterations", ullIterations}, {"allocs_per_op", dAllocs}});
+    }
+
+    ReadingFilter oFilter {ReadingFilter::Options()};
+    Hysteresis oShown(0.25f);
+    uint64_t ullIterations = 0;
+    double dAllocs = 0;
+    size_t uiNext = 0;
+    double dNs = nsPerOp([&] {
+        bool bOutlier;
+        keep(oShown.push(oFilter.push(vValues[uiNext++ % vValues.size()], bOutlier)));
+    }, oConf.m_dBatchSeconds, ullIterations, &dAllocs);
+    oResults.add("filter.reading", {{"ns_per_op", dNs}, {"iterations", ullIterations}, {"allocs_per_op", dAllocs}});
+}
+
+void benchLogger(const BenchConfig& oConf, Results& oResults) {
+    // Records go to stdout, which is pointed at /dev/null meanwhile
+    std::cout.flush();
+    int iStdout = dup(STDOUT_FILENO);
+    int iNull = open("/dev/null", O_WRONLY);
+    dup2(iNull, STDOUT_FILENO);
+    close(iNull);
+
+    Logger::setup(true, LOG_INFO, "bench", oConf.m_bAsyncLog ? Logger::MODE_ASYNC : Logger::MODE_SYNC,
+                  Logger::DROP_NEWEST);
+    const std::string sMode = oConf.m_bAsyncLog ? "async" : "sync";
+
+    // Above and below the runtime level, then with the filters temp-hum-clock sets up
+    for (const char* pCase : {"enabled", "filtered", "limited"}) {
+        int iLevel = std::strcmp(pCase, "filtered") ? LOG_INFO : LOG_DEBUG;
+        if (!std::strcmp(pCase, "limited")) {
+            Logger::setDedupWindow(std::chrono::seconds(60));
+            Logger::setRateLimit(LOG_INFO, 5, 50);
+        }
+        for (int iThreads : {1, 2, 4, 8}) {
+            std::vector<std::vector<uint32_t>> vLatencies(iThreads);
+            uint64_t ullDropped = Logger::dropped();
+            uint64_t ullRateLimited = Logger::rateLimited();
+
+            auto start = std::chrono::steady_clock::now();
+            std::vector<std::thread> vThreads;
+            for (int t = 0; t < iThreads; ++t) {
+                vThreads.emplace_back([&, t] {
+                    std::vector<uint32_t>& vNs = vLatencies[t];
+                    vNs.reserve(oConf.m_iLogRecords);
+                    for (int i = 0; i < oConf.m_iLogRecords; ++i) {
+                        auto before = std::chrono::steady_clock::now();
+                        // LOGGER_LOG needs a constant priority
+                        if (iLevel == LOG_INFO) {
+                            LOGGER_LOG(LOG_INFO, "Bench| thread [", t, "] record [", i, "] value ",
+                                       Logger::fixed(i * 0.5, 1));
+                        } else {
+                            LOGGER_LOG(LOG_DEBUG, "Bench| thread [", t, "] record [", i, "] value ",
+                                       Logger::fixed(i * 0.5, 1));
+                        }
+                        auto after = std::chrono::steady_clock::now();
+                        vNs.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(after - before).count());
+                    }
+                });
+            }
+            for (std::thread& oThread : vThreads) {
+                oThread.join();
+            }
+            double dSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            std::vector<uint32_t> vAll;
+            for (const auto& vNs : vLatencies) {
+                vAll.insert(vAll.end(), vNs.begin(), vNs.end());
+            }
+            std::sort(vAll.begin(), vAll.end());
+            auto at = [&](double dQuantile) {
+                return static_cast<double>(vAll[std::min(vAll.size() - 1, static_cast<size_t>(dQuantile * vAll.size()))]);
+            };
+
+            oResults.add("logger." + sMode + "." + pCase + ".threads_" + std::to_string(iThreads), {
+                {"records_per_s", vAll.size() / dSeconds},
+                {"p50_ns", at(0.5)},
+                {"p99_ns", at(0.99)},
+                {"p999_ns", at(0.999)},
+                {"max_ns", static_cast<double>(vAll.back())},
+                {"dropped", static_cast<double>(Logger::dropped() - ullDropped)},
+                {"rate_limited", static_cast<double>(Logger::rateLimited() - ullRateLimited)},
+            });
+        }
+    }
+    Logger::setDedupWindow(std::chrono::milliseconds::zero());
+    Logger::setRateLimit(LOG_INFO, 0, 0);
+
+    // One failing call site logging in a loop, deduplicated and rate limited
+    Logger::setDedupWindow(std::chrono::seconds(10));
+    Logger::setRateLimit(LOG_WARNING, 5, 50);
+    for (bool bVarying : {false, true}) {
+        uint64_t ullDeduplicated = Logger::deduplicated();
+        uint64_t ullRateLimited = Logger::rateLimited();
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < oConf.m_iLogRecords; ++i) {
+            if (bVarying) {
+                LOGGER_LOG(LOG_WARNING, "Bench| Char is not in list: [", static_cast<char>('a' + i % 26), "]");
+            } else {
+                LOGGER_LOG(LOG_WARNING, "Bench| Failed to read data from sensor: incorrect checksum");
+            }
+        }
+        double dSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        Logger::expire();
+        oResults.add("logger." + sMode + ".storm" + (bVarying ? ".varying" : ".identical"), {
+            {"ns_per_record", dSeconds * 1e9 / oConf.m_iLogRecords},
+            {"deduplicated", static_cast<double>(Logger::deduplicated() - ullDeduplicated)},
+            {"rate_limited", static_cast<double>(Logger::rateLimited() - ullRateLimited)},
+        });
+    }
+    Logger::setDedupWindow(std::chrono::milliseconds::zero());
+    Logger::setRateLimit(LOG_WARNING, 0, 0);
+
+    Logger::shutdown();
+    std::cout.flush();
+    dup2(iStdout, STDOUT_FILENO);
+    close(iStdout);
+}
+
+void printHelp(const char* programName) {
+    std::cout << "Usage: " << programName << " [options]\n"
+              << "Options:\n"
+              << "  -o, --output <path>         Write the JSON results to a file (default: stdout)\n"
+              << "  -f, --filter <text>         Only run groups whose name contains <text>:\n"
+              << "                              dht11, segments, display, display_bus, pages, sample_bus, filter, logger\n"
+              << "  -a, --async-log             Benchmark the logger in async mode (default: sync)\n"
+              << "  -q, --quick                 Shorter batches, noisier numbers\n"
+              << "  -h, --help                  Show this help message\n"
+              << "Progress goes to stderr.\n";
+}
+
+bool parseCommandLineArguments(int argc, char* argv[], BenchConfig &config) {
+    static struct option long_options[] = {
+        {"output",    required_argument, 0, 'o'},
+        {"filter",    required_argument, 0, 'f'},
+        {"async-log", no_argument,       0, 'a'},
+        {"quick",     no_argument,       0, 'q'},
+        {"help",      no_argument,       0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    int option_index = 0;
+    int c;
+    while ((c = getopt_long(argc, argv, "o:f:aqh", long_options, &option_index)) != -1) {
+        switch(c) {
+            case 'o': // --output
+                config.m_sOutputPath = optarg;
+                break;
+
+            case 'f': // --filter
+                config.m_sFilter = optarg;
+                break;
+
+            case 'a': // --async-log
+                config.m_bAsyncLog = true;
+                break;
+
+            case 'q': // --quick
+                config.m_dBatchSeconds = 0.005;
+                config.m_iLogRecords = 2000;
+                break;
+
+            case 'h': // --help
+                printHelp(argv[0]);
+                exit(0);
+
+            default:
+                printHelp(argv[0]);
+                return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+    if (!parseCommandLineArguments(argc, argv, config)) {
+        return 1;
+    }
+
+    typedef void (*BenchGroup)(const BenchConfig&, Results&);
+    const std::vector<std::pair<std::string, BenchGroup>> vGroups = {
+        {"dht11", benchDht11},
+        {"segments", benchSegments},
+        {"display", benchDisplay},
+        {"display_bus", benchDisplayBus},
+        {"pages", benchPages},
+        {"sample_bus", benchSampleBus},
+        {"filter", benchFilter},
+        // Last: the logger can only be set up once per process
+        {"logger", benchLogger},
+    };
+
+    Results oResults;
+    for (const auto& oGroup : vGroups) {
+        if (oGroup.first.find(config.m_sFilter) != std::string::npos) {
+            oGroup.second(config, oResults);
+        }
+    }
+
+    FILE* pOut = stdout;
+    if (!config.m_sOutputPath.empty()) {
+        pOut = std::fopen(config.m_sOutputPath.c_str(), "w");
+        if (!pOut) {
+            std::cerr << "Failed to open output file: " << config.m_sOutputPath << std::endl;
+            return 1;
+        }
+    }
+    oResults.write(pOut);
+    if (pOut != stdout) {
+        std::fclose(pOut);
+    }
+
+    return 0;
+}
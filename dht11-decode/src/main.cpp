@@ -0,0 +1,252 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <getopt.h>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+
+#include "DHT11.h"
+#include "EdgeLog.h"
+
+using addons::DHT11;
+
+const std::string DEFAULT_EDGE_LOG_PATH = "/var/lib/temp-hum-clock/edges";
+
+class DecodeConfig {
+public:
+    std::string m_sPath = DEFAULT_EDGE_LOG_PATH;
+    uint32_t m_uiThreshold = 0; // 0 - learned from every frame's response
+    int m_iRepeat = 1;
+    bool m_bVerbose = false;
+};
+
+// Frames per decoder status, indexed by DHT11::Status
+class StatusCounts {
+public:
+    uint64_t m_aCounts[4] = {};
+
+    void add(DHT11::Status eStatus) {
+        ++m_aCounts[std::min<unsigned>(eStatus, 3)];
+    }
+
+    void print(const char* pName) const {
+        std::cout << pName
+                  << "  ok=" << m_aCounts[DHT11::STATUS_OK]
+                  << "  checksum=" << m_aCounts[DHT11::STATUS_CHECKSUM]
+                  << "  timeout=" << m_aCounts[DHT11::STATUS_TIMEOUT]
+                  << "  invalid=" << m_aCounts[DHT11::STATUS_INVALID_PIN] << "\n";
+    }
+};
+
+// Bit HIGH pulses of the decoded frames, split by the threshold
+class PulseStats {
+public:
+    uint32_t m_uiZeroMax = 0;
+    uint32_t m_uiOneMin = std::numeric_limits<uint32_t>::max();
+    uint64_t m_ullZeroSum = 0;
+    uint64_t m_ullZeros = 0;
+    uint64_t m_ullOneSum = 0;
+    uint64_t m_ullOnes = 0;
+    uint32_t m_uiThresholdMin = std::numeric_limits<uint32_t>::max();
+    uint32_t m_uiThresholdMax = 0;
+    // Closest any bit came to its frame's threshold
+    uint32_t m_uiMargin = std::numeric_limits<uint32_t>::max();
+
+    void add(const addons::EdgeFrame& oFrame, uint32_t uiThreshold) {
+        m_uiThresholdMin = std::min(m_uiThresholdMin, uiThreshold);
+        m_uiThresholdMax = std::max(m_uiThresholdMax, uiThreshold);
+        for (int i = 0; i < 40; ++i) {
+            uint32_t uiHigh = oFrame.aTicks[2 * i + 4] - oFrame.aTicks[2 * i + 3];
+            if (uiHigh >= uiThreshold) {
+                m_uiOneMin = std::min(m_uiOneMin, uiHigh);
+                m_ullOneSum += uiHigh;
+                ++m_ullOnes;
+                m_uiMargin = std::min(m_uiMargin, uiHigh - uiThreshold);
+            } else {
+                m_uiZeroMax = std::max(m_uiZeroMax, uiHigh);
+                m_ullZeroSum += uiHigh;
+                ++m_ullZeros;
+                m_uiMargin = std::min(m_uiMargin, uiThreshold - uiHigh);
+            }
+        }
+    }
+
+    void print() const {
+        if (m_uiThresholdMax == 0) {
+            return;
+        }
+        std::cout << std::fixed << std::setprecision(1)
+                  << "threshold  " << m_uiThresholdMin << ".." << m_uiThresholdMax << "us"
+                  << "  closest bit " << m_uiMargin << "us\n";
+        if (m_ullZeros) {
+            std::cout << "zero HIGH  mean " << static_cast<double>(m_ullZeroSum) / m_ullZeros
+                      << "us  max " << m_uiZeroMax << "us\n";
+        }
+        if (m_ullOnes) {
+            std::cout << "one HIGH   mean " << static_cast<double>(m_ullOneSum) / m_ullOnes
+                      << "us  min " << m_uiOneMin << "us\n";
+        }
+    }
+};
+
+void printHelp(const char* programName) {
+    std::cout << "Usage: " << programName << " [options]\n"
+              << "Options:\n"
+              << "  -f, --file <path>           Edge log (default: " << DEFAULT_EDGE_LOG_PATH << ")\n"
+              << "  -t, --threshold <us>        Fixed bit threshold (default: learned per frame)\n"
+              << "  -n, --repeat <count>        Decode the log <count> times, for timing (default: 1)\n"
+              << "  -v, --verbose               Print every frame\n"
+              << "  -h, --help                  Show this help message\n"
+              << "Replays the recorded frames through the DHT11 decoder and compares the\n"
+              << "outcome with the one of the live read.\n";
+}
+
+bool parseCommandLineArguments(int argc, char* argv[], DecodeConfig &config) {
+    static struct option long_options[] = {
+        {"file",      required_argument, 0, 'f'},
+        {"threshold", required_argument, 0, 't'},
+        {"repeat",    required_argument, 0, 'n'},
+        {"verbose",   no_argument,       0, 'v'},
+        {"help",      no_argument,       0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    int option_index = 0;
+    int c;
+    while ((c = getopt_long(argc, argv, "f:t:n:vh", long_options, &option_index)) != -1) {
+        switch(c) {
+            case 'f': // --file
+                config.m_sPath = optarg;
+                break;
+
+            case 't': // --threshold
+            case 'n': // --repeat
+                try {
+                    int iValue = std::stoi(optarg);
+                    if (iValue < 1) {
+                        throw std::out_of_range("must be positive");
+                    }
+                    if (c == 't') {
+                        config.m_uiThreshold = iValue;
+                    } else {
+                        config.m_iRepeat = iValue;
+                    }
+                } catch (const std::exception & e) {
+                    std::cerr << "Parsing error: invalid value [" << optarg << "]: ["
+                              << e.what() << "]" << std::endl;
+                    return false;
+                }
+                break;
+
+            case 'v': // --verbose
+                config.m_bVerbose = true;
+                break;
+
+            case 'h': // --help
+                printHelp(argv[0]);
+                exit(0);
+
+            default:
+                printHelp(argv[0]);
+                return false;
+        }
+    }
+
+    return true;
+}
+
+// Same steps as a live read, without the exception of a short frame
+DHT11::Status decode(const addons::EdgeFrame& oFrame, uint32_t uiThreshold, float& fTemp, float& fHum) {
+    if (oFrame.iCount < DHT11::FRAME_EDGES) {
+        return DHT11::STATUS_TIMEOUT;
+    }
+    return DHT11::parseFrame(DHT11::decodeEdges(oFrame.aTicks, oFrame.iCount, uiThreshold), fTemp, fHum);
+}
+
+int main(int argc, char* argv[]) {
+    DecodeConfig config;
+    if (!parseCommandLineArguments(argc, argv, config)) {
+        return 1;
+    }
+
+    addons::EdgeLogReader oLog;
+    if (!oLog.open(config.m_sPath)) {
+        std::cerr << "Failed to open edge log: " << config.m_sPath << std::endl;
+        return 1;
+    }
+
+    StatusCounts oLive;
+    StatusCounts oReplay;
+    PulseStats oPulses;
+    uint64_t ullChanged = 0;
+    uint64_t ullFrames = 0;
+    uint64_t ullDecoded = 0;
+    addons::EdgeFrame oFrame;
+
+    // With repeats only the later, bare decoding passes are timed
+    auto start = std::chrono::steady_clock::now();
+    for (int iPass = 0; iPass < config.m_iRepeat; ++iPass) {
+        oLog.rewind();
+        if (iPass == 1) {
+            start = std::chrono::steady_clock::now();
+            ullDecoded = 0;
+        }
+        while (oLog.next(oFrame)) {
+            float fTemp = 0;
+            float fHum = 0;
+            DHT11::Status eStatus = decode(oFrame, config.m_uiThreshold, fTemp, fHum);
+            ++ullDecoded;
+            if (iPass > 0) {
+                continue;
+            }
+
+            ++ullFrames;
+            oLive.add(oFrame.eStatus);
+            oReplay.add(eStatus);
+            ullChanged += eStatus != oFrame.eStatus;
+
+            uint32_t uiThreshold = config.m_uiThreshold;
+            if (oFrame.iCount >= DHT11::FRAME_EDGES) {
+                if (!uiThreshold) {
+                    uiThreshold = DHT11::bitThreshold(oFrame.aTicks[2] - oFrame.aTicks[0]);
+                }
+                if (eStatus == DHT11::STATUS_OK) {
+                    oPulses.add(oFrame, uiThreshold);
+                }
+            }
+
+            if (config.m_bVerbose) {
+                time_t iTime = oFrame.uiTime;
+                std::tm oTm;
+                localtime_r(&iTime, &oTm);
+                std::cout << std::put_time(&oTm, "%Y-%m-%d %H:%M:%S")
+                          << "  gpio " << std::setw(2) << oFrame.iPin
+                          << "  edges " << std::setw(2) << oFrame.iCount
+                          << "  live " << oFrame.eStatus
+                          << "  replay " << eStatus;
+                if (eStatus == DHT11::STATUS_OK) {
+                    std::cout << "  T " << fTemp << "  H " << fHum << "  threshold " << uiThreshold << "us";
+                }
+                std::cout << "\n";
+            }
+        }
+    }
+    double dSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "frames     " << ullFrames << "  (" << oLog.size() << " bytes)\n";
+    oLive.print("live     ");
+    oReplay.print("replay   ");
+    std::cout << "changed    " << ullChanged << "\n";
+    oPulses.print();
+    if (dSeconds > 0 && ullFrames) {
+        double dBytes = static_cast<double>(oLog.size()) * ullDecoded / ullFrames;
+        std::cout << std::fixed << std::setprecision(2)
+                  << "decoded    " << ullDecoded / dSeconds / 1e6 << "M frames/s  "
+                  << dBytes / dSeconds / 1e6 << " MB/s\n";
+    }
+
+    return 0;
+}
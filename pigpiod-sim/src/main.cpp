@@ -0,0 +1,522 @@
+#include <arpa/inet.h>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <getopt.h>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sstream>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "PigpiodProtocol.h"
+#include "SimDevices.h"
+#include "SimGpioBackend.h"
+#include "reactor.h"
+
+using addons::GpioBackend;
+namespace pigpiod = addons::pigpiod;
+
+class SimConfig {
+public:
+    uint16_t m_uiPort = pigpiod::DEFAULT_PORT;
+    std::vector<int> m_vDht11Pins {17};
+    int m_iDispClkPin = 18;
+    int m_iDispIOPin = 23;
+    int m_iLightSensorPin = 27;
+    bool m_bVerbose = false;
+};
+
+void printHelp(const char* programName) {
+    std::cout << "Usage: " << programName << " [options]\n"
+              << "Options:\n"
+              << "  -p, --port <port>           TCP port on 127.0.0.1 (default: " << pigpiod::DEFAULT_PORT << ")\n"
+              << "  -d, --dht11 <pins>          Comma separated GPIOs of simulated DHT11s (default: 17)\n"
+              << "  -c, --clk <pin>             GPIO of the simulated TM1637 CLK line (default: 18)\n"
+              << "  -i, --dio <pin>             GPIO of the simulated TM1637 DIO line (default: 23)\n"
+              << "  -l, --light <pin>           GPIO of the simulated light sensor, switching every 30 s (default: 27)\n"
+              << "  -v, --verbose               Print every request and display change\n"
+              << "  -h, --help                  Show this help message\n"
+              << "Stand-in for pigpiod speaking its socket protocol, backed by the simulated\n"
+              << "GPIO bus. The bus clock follows the wall clock, delays sleep for real.\n";
+}
+
+bool parsePin(const std::string& sValue, int& iPin) {
+    try {
+        iPin = std::stoi(sValue);
+    } catch (const std::exception & e) {
+        std::cerr << "Parsing error: invalid pin [" << sValue << "]: [" << e.what() << "]" << std::endl;
+        return false;
+    }
+    if (iPin < 0 || iPin >= 32) {
+        std::cerr << "Parsing error: pin [" << sValue << "] is not in 0-31" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool parseCommandLineArguments(int argc, char* argv[], SimConfig &config) {
+    static struct option long_options[] = {
+        {"port",    required_argument, 0, 'p'},
+        {"dht11",   required_argument, 0, 'd'},
+        {"clk",     required_argument, 0, 'c'},
+        {"dio",     required_argument, 0, 'i'},
+        {"light",   required_argument, 0, 'l'},
+        {"verbose", no_argument,       0, 'v'},
+        {"help",    no_argument,       0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    int option_index = 0;
+    int c;
+    while ((c = getopt_long(argc, argv, "p:d:c:i:l:vh", long_options, &option_index)) != -1) {
+        switch(c) {
+            case 'p': // --port
+                try {
+                    int iPort = std::stoi(optarg);
+                    if (iPort < 1 || iPort > 65535) {
+                        throw std::out_of_range("not a port");
+                    }
+                    config.m_uiPort = iPort;
+                } catch (const std::exception & e) {
+                    std::cerr << "Parsing error: invalid port [" << optarg << "]: [" << e.what() << "]" << std::endl;
+                    return false;
+                }
+                break;
+
+            case 'd': { // --dht11
+                config.m_vDht11Pins.clear();
+                std::stringstream ss(optarg);
+                std::string sPin;
+                while (std::getline(ss, sPin, ',')) {
+                    int iPin;
+                    if (!parsePin(sPin, iPin)) {
+                        return false;
+                    }
+                    config.m_vDht11Pins.push_back(iPin);
+                }
+                break;
+            }
+
+            case 'c': // --clk
+                if (!parsePin(optarg, config.m_iDispClkPin)) {
+                    return false;
+                }
+                break;
+
+            case 'i': // --dio
+                if (!parsePin(optarg, config.m_iDispIOPin)) {
+                    return false;
+                }
+                break;
+
+            case 'l': // --light
+                if (!parsePin(optarg, config.m_iLightSensorPin)) {
+                    return false;
+                }
+                break;
+
+            case 'v': // --verbose
+                config.m_bVerbose = true;
+                break;
+
+            case 'h': // --help
+                printHelp(argv[0]);
+                exit(0);
+
+            default:
+                printHelp(argv[0]);
+                return false;
+        }
+    }
+
+    return true;
+}
+
+// One pigpiod instance: command connections, notification handles and the bus
+// they share. Every handler runs on the reactor thread.
+class SimDaemon {
+public:
+    SimDaemon(const SimConfig& oConf, Reactor& oReactor)
+        : m_oConf(oConf), m_oReactor(oReactor), m_oStart(std::chrono::steady_clock::now()) {
+        for (int iPin : m_oConf.m_vDht11Pins) {
+            m_oBus.attach(std::make_shared<addons::SimDHT11>(iPin), {static_cast<unsigned>(iPin)});
+        }
+        m_oBus.attach(std::make_shared<addons::SimLightSensor>(m_oConf.m_iLightSensorPin),
+                      {static_cast<unsigned>(m_oConf.m_iLightSensorPin)});
+        m_pDisplay = std::make_shared<addons::SimTM1637>(m_oConf.m_iDispClkPin, m_oConf.m_iDispIOPin);
+        m_oBus.attach(m_pDisplay, {
+            static_cast<unsigned>(m_oConf.m_iDispClkPin),
+            static_cast<unsigned>(m_oConf.m_iDispIOPin)
+        });
+    }
+
+    bool listen() {
+        m_iListenFd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (m_iListenFd < 0) {
+            return false;
+        }
+        int iOne = 1;
+        setsockopt(m_iListenFd, SOL_SOCKET, SO_REUSEADDR, &iOne, sizeof(iOne));
+
+        sockaddr_in oAddr {};
+        oAddr.sin_family = AF_INET;
+        oAddr.sin_port = htons(m_oConf.m_uiPort);
+        oAddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (::bind(m_iListenFd, reinterpret_cast<sockaddr*>(&oAddr), sizeof(oAddr)) < 0 ||
+            ::listen(m_iListenFd, 8) < 0) {
+            std::cerr << "Failed to listen on port " << m_oConf.m_uiPort << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        return m_oReactor.addFd(m_iListenFd, EPOLLIN, [this](uint32_t) { accept(); });
+    }
+
+    // Device driven edges only show up when the bus clock moves
+    void idle() {
+        sync();
+        flushReports();
+        showDisplay();
+    }
+
+private:
+    struct Client {
+        int iFd;
+        std::vector<char> vInput;
+        int iHandle = -1;  // notification handle this socket reports to
+    };
+
+    struct Handle {
+        int iFd;
+        uint32_t uiMask = 0;
+        uint16_t uiSeq = 0;
+        std::vector<pigpiod::Report> vReports;
+    };
+
+    void accept() {
+        int iFd = ::accept4(m_iListenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (iFd < 0) {
+            return;
+        }
+        int iOne = 1;
+        setsockopt(iFd, IPPROTO_TCP, TCP_NODELAY, &iOne, sizeof(iOne));
+
+        m_mClients[iFd] = Client{iFd, {}};
+        m_oReactor.addFd(iFd, EPOLLIN, [this, iFd](uint32_t) { receive(iFd); });
+        if (m_oConf.m_bVerbose) {
+            std::cout << "connection " << iFd << " opened" << std::endl;
+        }
+    }
+
+    void disconnect(int iFd) {
+        auto it = m_mClients.find(iFd);
+        if (it == m_mClients.end()) {
+            return;
+        }
+        if (it->second.iHandle >= 0) {
+            closeHandle(it->second.iHandle);
+        }
+        m_oReactor.removeFd(iFd);
+        ::close(iFd);
+        m_mClients.erase(it);
+        if (m_oConf.m_bVerbose) {
+            std::cout << "connection " << iFd << " closed" << std::endl;
+        }
+    }
+
+    void receive(int iFd) {
+        Client& oClient = m_mClients[iFd];
+        char aBuffer[4096];
+        ssize_t iRead = ::recv(iFd, aBuffer, sizeof(aBuffer), MSG_DONTWAIT);
+        if (iRead < 0 && (errno == EAGAIN || errno == EINTR)) {
+            return;
+        }
+        if (iRead <= 0) {
+            disconnect(iFd);
+            return;
+        }
+        oClient.vInput.insert(oClient.vInput.end(), aBuffer, aBuffer + iRead);
+
+        // Every complete request is answered in order, in one send
+        std::vector<pigpiod::Header> vReplies;
+        size_t uiPos = 0;
+        while (oClient.vInput.size() - uiPos >= sizeof(pigpiod::Header)) {
+            pigpiod::Header oRequest;
+            std::memcpy(&oRequest, oClient.vInput.data() + uiPos, sizeof(oRequest));
+            if (oClient.vInput.size() - uiPos - sizeof(oRequest) < oRequest.uiP3) {
+                break;
+            }
+            const char* pExt = oClient.vInput.data() + uiPos + sizeof(oRequest);
+            uiPos += sizeof(oRequest) + oRequest.uiP3;
+
+            int32_t iRes = execute(oClient, oRequest, pExt);
+            vReplies.push_back({oRequest.uiCmd, oRequest.uiP1, oRequest.uiP2, static_cast<uint32_t>(iRes)});
+        }
+        oClient.vInput.erase(oClient.vInput.begin(), oClient.vInput.begin() + uiPos);
+
+        if (!vReplies.empty() &&
+            ::send(iFd, vReplies.data(), vReplies.size() * sizeof(pigpiod::Header), MSG_NOSIGNAL) < 0) {
+            disconnect(iFd);
+            return;
+        }
+        flushReports();
+        showDisplay();
+    }
+
+    int32_t execute(Client& oClient, const pigpiod::Header& oRequest, const char* pExt) {
+        sync();
+        if (m_oConf.m_bVerbose) {
+            std::cout << "request  cmd " << std::setw(2) << oRequest.uiCmd
+                      << "  p1 " << oRequest.uiP1 << "  p2 " << oRequest.uiP2
+                      << "  ext " << oRequest.uiP3 << std::endl;
+        }
+
+        switch (oRequest.uiCmd) {
+            case pigpiod::CMD_MODES:
+                return m_oBus.setMode(oRequest.uiP1, oRequest.uiP2);
+            case pigpiod::CMD_PUD:
+                return m_oBus.setPullUpDown(oRequest.uiP1, oRequest.uiP2);
+            case pigpiod::CMD_READ:
+                return m_oBus.read(oRequest.uiP1);
+            case pigpiod::CMD_WRITE:
+                return m_oBus.write(oRequest.uiP1, oRequest.uiP2);
+            case pigpiod::CMD_BR1:
+                return static_cast<int32_t>(levels());
+            case pigpiod::CMD_BS1:
+                return m_oBus.writeBank(oRequest.uiP1, 0);
+            case pigpiod::CMD_BC1:
+                return m_oBus.writeBank(0, oRequest.uiP1);
+            case pigpiod::CMD_TICK:
+                return static_cast<int32_t>(m_oBus.tick());
+            case pigpiod::CMD_HWVER:
+                return 0;
+
+            case pigpiod::CMD_MICS:
+            case pigpiod::CMD_MILS: {
+                uint32_t uiLimit = oRequest.uiCmd == pigpiod::CMD_MICS ? pigpiod::MAX_MICS_DELAY
+                                                                     : pigpiod::MAX_MILS_DELAY;
+                if (oRequest.uiP1 > uiLimit) {
+                    return -1;
+                }
+                uint64_t ullUs = oRequest.uiP1;
+                if (oRequest.uiCmd == pigpiod::CMD_MILS) {
+                    ullUs *= 1000;
+                }
+                std::this_thread::sleep_for(std::chrono::microseconds(ullUs));
+                sync();
+                return 0;
+            }
+
+            case pigpiod::CMD_NOIB: {
+                int iHandle = m_iNextHandle++;
+                m_mHandles[iHandle] = Handle{oClient.iFd, 0, 0, {}};
+                oClient.iHandle = iHandle;
+                return iHandle;
+            }
+            case pigpiod::CMD_NB: {
+                auto it = m_mHandles.find(oRequest.uiP1);
+                if (it == m_mHandles.end()) {
+                    return -1;
+                }
+                it->second.uiMask = oRequest.uiP2;
+                updateAlerts();
+                return 0;
+            }
+            case pigpiod::CMD_NC:
+                return closeHandle(oRequest.uiP1);
+            case pigpiod::CMD_FG:
+                return m_oBus.setGlitchFilter(oRequest.uiP1, oRequest.uiP2);
+
+            case pigpiod::CMD_WVCLR:
+                for (int iWave : m_vWaves) {
+                    m_oBus.waveDelete(iWave);
+                }
+                m_vWaves.clear();
+                m_vPulses.clear();
+                return 0;
+            case pigpiod::CMD_WVNEW:
+                m_vPulses.clear();
+                return 0;
+            case pigpiod::CMD_WVAG: {
+                size_t uiCount = oRequest.uiP3 / sizeof(GpioBackend::Pulse);
+                const GpioBackend::Pulse* pPulses = reinterpret_cast<const GpioBackend::Pulse*>(pExt);
+                m_vPulses.insert(m_vPulses.end(), pPulses, pPulses + uiCount);
+                return static_cast<int32_t>(m_vPulses.size());
+            }
+            case pigpiod::CMD_WVCRE: {
+                if (m_vPulses.empty()) {
+                    return -1;
+                }
+                int iWave = m_oBus.waveCreate(m_vPulses);
+                m_vWaves.push_back(iWave);
+                m_vPulses.clear();
+                return iWave;
+            }
+            case pigpiod::CMD_WVTX:
+                return m_oBus.waveSend(oRequest.uiP1);
+            case pigpiod::CMD_WVBSY:
+                return m_oBus.waveBusy() ? 1 : 0;
+            case pigpiod::CMD_WVDEL:
+                for (auto it = m_vWaves.begin(); it != m_vWaves.end(); ++it) {
+                    if (*it == static_cast<int>(oRequest.uiP1)) {
+                        m_vWaves.erase(it);
+                        break;
+                    }
+                }
+                return m_oBus.waveDelete(oRequest.uiP1);
+
+            default:
+                return -1;
+        }
+    }
+
+    int closeHandle(uint32_t uiHandle) {
+        auto it = m_mHandles.find(uiHandle);
+        if (it == m_mHandles.end()) {
+            return -1;
+        }
+        auto itClient = m_mClients.find(it->second.iFd);
+        if (itClient != m_mClients.end()) {
+            itClient->second.iHandle = -1;
+        }
+        m_mHandles.erase(it);
+        updateAlerts();
+        return 0;
+    }
+
+    // Bus alerts are enabled for the union of the handles' masks
+    void updateAlerts() {
+        uint32_t uiMask = 0;
+        for (const auto& oEntry : m_mHandles) {
+            uiMask |= oEntry.second.uiMask;
+        }
+        for (unsigned uiPin = 0; uiPin < 32; ++uiPin) {
+            uint32_t uiBit = 1u << uiPin;
+            if ((uiMask & uiBit) == (m_uiAlertMask & uiBit)) {
+                continue;
+            }
+            if (uiMask & uiBit) {
+                m_oBus.setAlertFunc(uiPin, onAlert, this);
+                m_uiLevels = (m_uiLevels & ~uiBit) | (m_oBus.read(uiPin) ? uiBit : 0);
+            } else {
+                m_oBus.setAlertFunc(uiPin, nullptr, nullptr);
+            }
+        }
+        m_uiAlertMask = uiMask;
+    }
+
+    // Called with the bus locked: only queues the reports
+    static void onAlert(int iPin, int iLevel, uint32_t uiTick, void* pUserData) {
+        SimDaemon& oDaemon = *static_cast<SimDaemon*>(pUserData);
+        uint32_t uiBit = 1u << iPin;
+        oDaemon.m_uiLevels = (oDaemon.m_uiLevels & ~uiBit) | (iLevel ? uiBit : 0);
+        for (auto& oEntry : oDaemon.m_mHandles) {
+            Handle& oHandle = oEntry.second;
+            if (oHandle.uiMask & uiBit) {
+                oHandle.vReports.push_back({oHandle.uiSeq++, 0, uiTick, oDaemon.m_uiLevels});
+            }
+        }
+    }
+
+    void flushReports() {
+        std::vector<int> vLost;
+        for (auto& oEntry : m_mHandles) {
+            Handle& oHandle = oEntry.second;
+            if (oHandle.vReports.empty()) {
+                continue;
+            }
+            if (::send(oHandle.iFd, oHandle.vReports.data(), oHandle.vReports.size() * sizeof(pigpiod::Report),
+                       MSG_NOSIGNAL) < 0) {
+                vLost.push_back(oHandle.iFd);
+            }
+            oHandle.vReports.clear();
+        }
+        for (int iFd : vLost) {
+            disconnect(iFd);
+        }
+    }
+
+    uint32_t levels() {
+        return m_oBus.readBank();
+    }
+
+    // Moves the bus clock up to the wall clock; calls and waves may have run it ahead
+    void sync() {
+        uint64_t ullWallNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - m_oStart).count();
+        uint64_t ullBusNs = m_oBus.nowNs();
+        if (ullWallNs > ullBusNs) {
+            m_oBus.advanceNs(ullWallNs - ullBusNs);
+        }
+    }
+
+    void showDisplay() {
+        if (!m_oConf.m_bVerbose) {
+            return;
+        }
+        const std::array<uint8_t, 6>& aSegments = m_pDisplay->segments();
+        int iBrightness = m_pDisplay->displayOn() ? m_pDisplay->brightness() : -1;
+        if (aSegments == m_aShown && iBrightness == m_iShownBrightness) {
+            return;
+        }
+        m_aShown = aSegments;
+        m_iShownBrightness = iBrightness;
+
+        std::cout << "display ";
+        for (uint8_t uiSegments : aSegments) {
+            std::cout << " " << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(uiSegments);
+        }
+        std::cout << std::dec << std::setfill(' ') << "  brightness " << iBrightness << std::endl;
+    }
+
+    const SimConfig& m_oConf;
+    Reactor& m_oReactor;
+    std::chrono::steady_clock::time_point m_oStart;
+
+    addons::SimGpioBackend m_oBus;
+    std::shared_ptr<addons::SimTM1637> m_pDisplay;
+    std::array<uint8_t, 6> m_aShown {};
+    int m_iShownBrightness = -1;
+
+    int m_iListenFd = -1;
+    std::map<int, Client> m_mClients;
+
+    std::map<int, Handle> m_mHandles;
+    int m_iNextHandle = 0;
+    uint32_t m_uiAlertMask = 0;
+    uint32_t m_uiLevels = 0;
+
+    std::vector<GpioBackend::Pulse> m_vPulses;
+    std::vector<int> m_vWaves;
+};
+
+int main(int argc, char* argv[]) {
+    SimConfig config;
+    if (!parseCommandLineArguments(argc, argv, config)) {
+        return 1;
+    }
+
+    Reactor oReactor;
+    oReactor.addSignals({SIGTERM, SIGINT}, [&oReactor](int) { oReactor.stop(); });
+
+    SimDaemon oDaemon(config, oReactor);
+    if (!oDaemon.listen()) {
+        return 1;
+    }
+
+    int iTimer = oReactor.addTimer(CLOCK_MONOTONIC, [&oDaemon]() { oDaemon.idle(); });
+    oReactor.armAfter(iTimer, std::chrono::milliseconds(1), std::chrono::milliseconds(1));
+
+    std::cout << "pigpiod-sim listening on 127.0.0.1:" << config.m_uiPort << std::endl;
+    oReactor.run();
+    return 0;
+}
@@ -0,0 +1,569 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <getopt.h>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "SimDevices.h"
+#include "SimGpioBackend.h"
+#include "TM1637.h"
+#include "app_config.h"
+#include "clock.h"
+#include "logger.h"
+#include "reactor.h"
+#include "sample_bus.h"
+#include "service.h"
+
+namespace {
+
+// Spare line whose alert raises SIGTERM
+const unsigned SIGNAL_PIN = 26;
+
+const uint64_t MINUTE_NS = 60000000000ull;
+const uint64_t HOUR_NS = 60 * MINUTE_NS;
+// Well within the 64 records the bus keeps
+const uint64_t DRAIN_PERIOD_NS = 30000000000ull;
+
+// Day and night, the readings drift over the day
+const uint32_t LIGHT_PERIOD_MS = 12 * 3600 * 1000;
+const uint64_t WEATHER_STEP_NS = 10 * MINUTE_NS;
+// Virtual date the clock page starts from
+const time_t START_TIME = 1767225600;
+
+// Expectations every scenario is held to
+const double MIN_FRAMES_PER_HOUR = 600;  // a page every 5 s is 720
+const double MAX_FAILED_FRAME_SHARE = 0.001;
+const uint64_t MAX_SHUTDOWN_NS = 250000000;
+
+}
+
+class SoakConfig {
+public:
+    std::string m_sOutputPath; // empty - stdout
+    std::string m_sFilter;     // empty - every scenario
+    double m_dDays = 3;
+    double m_dRestartHours = 6;
+    uint32_t m_uiSeed = 1;
+};
+
+// One JSON object per scenario: a name and numeric fields.
+class Results {
+public:
+    typedef std::vector<std::pair<std::string, double>> Fields;
+
+    void add(const std::string& sName, const Fields& vFields) {
+        m_vResults.emplace_back(sName, vFields);
+        std::cerr << sName;
+        for (const auto& oField : vFields) {
+            std::cerr << "  " << oField.first << "=" << oField.second;
+        }
+        std::cerr << "\n";
+    }
+
+    void write(FILE* pOut, uint32_t uiSeed) const {
+        std::fprintf(pOut, "{\n  \"context\": {\"compiler\": \"%s\", \"seed\": %u, \"time\": %lld},\n",
+                     __VERSION__, uiSeed, static_cast<long long>(time(nullptr)));
+        std::fprintf(pOut, "  \"scenarios\": [\n");
+        for (size_t i = 0; i < m_vResults.size(); ++i) {
+            std::fprintf(pOut, "    {\"name\": \"%s\"", m_vResults[i].first.c_str());
+            for (const auto& oField : m_vResults[i].second) {
+                std::fprintf(pOut, ", \"%s\": %.6g", oField.first.c_str(), oField.second);
+            }
+            std::fprintf(pOut, "}%s\n", i + 1 < m_vResults.size() ? "," : "");
+        }
+        std::fprintf(pOut, "  ]\n}\n");
+    }
+
+private:
+    std::vector<std::pair<std::string, Fields>> m_vResults;
+};
+
+// Pulls its line low for a millisecond at the chosen instant. The alert on
+// the line raises SIGTERM, which the service reads from its signalfd, so the
+// signal lands wherever the loop happens to be. Also listens on the sensor
+// line to land one in the middle of a read.
+class SimSignal : public addons::SimDevice {
+public:
+    static constexpr uint64_t PULSE_NS = 1000000;
+    // A read and the redraw after it take less
+    static constexpr uint64_t AIM_WINDOW_NS = 30000000;
+
+    SimSignal(unsigned uiPin, unsigned uiSensorPin, uint32_t uiSeed)
+        : m_uiPin(uiPin), m_uiSensorPin(uiSensorPin), m_oRng(uiSeed) {}
+
+    void arm(uint64_t ullAtNs) {
+        m_ullAtNs = ullAtNs;
+        m_ullAimNs = UINT64_MAX;
+    }
+
+    // Fires within AIM_WINDOW_NS of the first start pulse from ullAfterNs on
+    void aim(uint64_t ullAfterNs) {
+        m_ullAtNs = UINT64_MAX;
+        m_ullAimNs = ullAfterNs;
+    }
+
+    uint64_t at() const {
+        return m_ullAtNs;
+    }
+
+    void onLineChange(unsigned uiPin, int iLevel, uint64_t ullNowNs) override {
+        if (uiPin == m_uiSensorPin && !iLevel && ullNowNs >= m_ullAimNs) {
+            m_ullAtNs = ullNowNs + std::uniform_int_distribution<uint64_t>(0, AIM_WINDOW_NS)(m_oRng);
+            m_ullAimNs = UINT64_MAX;
+        }
+    }
+
+    int drive(unsigned uiPin, uint64_t ullNowNs) override {
+        return (uiPin == m_uiPin && ullNowNs >= m_ullAtNs && ullNowNs < m_ullAtNs + PULSE_NS) ? 0 : 1;
+    }
+
+    bool nextToggle(unsigned uiPin, uint64_t ullAfterNs, uint64_t& ullAtNs) override {
+        if (uiPin != m_uiPin || m_ullAtNs == UINT64_MAX || ullAfterNs >= m_ullAtNs + PULSE_NS) {
+            return false;
+        }
+        ullAtNs = ullAfterNs < m_ullAtNs ? m_ullAtNs : m_ullAtNs + PULSE_NS;
+        return true;
+    }
+
+    static void onAlert(int /*iPin*/, int iLevel, uint32_t /*uiTick*/, void* /*pUserData*/) {
+        if (!iLevel) {
+            // Blocked by the reactor, stays pending for its signalfd
+            std::raise(SIGTERM);
+        }
+    }
+
+private:
+    unsigned m_uiPin;
+    unsigned m_uiSensorPin;
+    std::mt19937 m_oRng;
+    uint64_t m_ullAtNs = UINT64_MAX;
+    uint64_t m_ullAimNs = UINT64_MAX;
+};
+
+// The clock of the simulated bus, the service's steady clock and, offset to
+// START_TIME, its wall clock. Idle waits skip ahead but stop at the edges of
+// the watched lines, as the event loop wakes on their alerts.
+class SimClock : public VirtualClock {
+public:
+    explicit SimClock(addons::SimGpioBackend& oSim) : m_oSim(oSim) {}
+
+    void watch(std::shared_ptr<addons::SimDevice> pDevice, unsigned uiPin) {
+        m_vWatched.emplace_back(std::move(pDevice), uiPin);
+    }
+
+    std::chrono::steady_clock::time_point steady() const override {
+        return std::chrono::steady_clock::time_point(std::chrono::nanoseconds(m_oSim.nowNs()));
+    }
+
+    std::chrono::system_clock::time_point wall() const override {
+        return std::chrono::system_clock::from_time_t(START_TIME) +
+               std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                   std::chrono::nanoseconds(m_oSim.nowNs()));
+    }
+
+    void advance(std::chrono::steady_clock::time_point oDeadline) override {
+        uint64_t ullNow = m_oSim.nowNs();
+        auto llDeadlineNs = std::chrono::duration_cast<std::chrono::nanoseconds>(oDeadline.time_since_epoch()).count();
+        uint64_t ullWake = llDeadlineNs > 0 ? static_cast<uint64_t>(llDeadlineNs) : 0;
+        for (const auto& oWatched : m_vWatched) {
+            uint64_t ullAt;
+            if (oWatched.first->nextToggle(oWatched.second, ullNow, ullAt)) {
+                ullWake = std::min(ullWake, ullAt);
+            }
+        }
+        m_oSim.advanceNs(std::max(ullWake, ullNow + 1) - ullNow);
+    }
+
+private:
+    addons::SimGpioBackend& m_oSim;
+    std::vector<std::pair<std::shared_ptr<addons::SimDevice>, unsigned>> m_vWatched;
+};
+
+struct Scenario {
+    const char* pName;
+    addons::SimDHT11::Faults oSensorFaults;
+    double dNackRate;
+    bool bLightStuck;  // from halfway through
+    double dMinReadSuccess;
+};
+
+// Runs temp-hum-clock with its defaults for the configured virtual time,
+// restarting it with a SIGTERM every few hours, and checks the outcome
+// against the expectations.
+bool runScenario(const SoakConfig& oConf, const Scenario& oScenario, Results& oResults) {
+    const AppConfig oAppConf = [] {
+        AppConfig oAppConf;
+        oAppConf.m_bTime = true;
+        oAppConf.m_bTemperature = true;
+        oAppConf.m_bHumidity = true;
+        // Not whatever the host calibrated
+        oAppConf.m_sTimingPath.clear();
+        return oAppConf;
+    }();
+    const PinConfig oPinConf;
+    const unsigned uiSensorPin = static_cast<unsigned>(oPinConf.m_vDht11Pins[0]);
+    const unsigned uiLightPin = static_cast<unsigned>(oPinConf.m_iLightSensorPin);
+
+    std::mt19937 oRng(oConf.m_uiSeed);
+    addons::SimGpioBackend oSim;
+    oSim.initialise();
+    addons::GpioBackend::setInstance(&oSim);
+
+    auto pSensor = std::make_shared<addons::SimDHT11>(uiSensorPin);
+    pSensor->setFaults(oScenario.oSensorFaults, oConf.m_uiSeed);
+    oSim.attach(pSensor, {uiSensorPin});
+    auto pLight = std::make_shared<addons::SimLightSensor>(uiLightPin, LIGHT_PERIOD_MS);
+    oSim.attach(pLight, {uiLightPin});
+    auto pDisplay = std::make_shared<addons::SimTM1637>(oPinConf.m_iDispClkPin, oPinConf.m_iDispIOPin);
+    pDisplay->setNackRate(oScenario.dNackRate, oConf.m_uiSeed);
+    oSim.attach(pDisplay, {static_cast<unsigned>(oPinConf.m_iDispClkPin),
+                           static_cast<unsigned>(oPinConf.m_iDispIOPin)});
+    auto pSignal = std::make_shared<SimSignal>(SIGNAL_PIN, uiSensorPin, oConf.m_uiSeed);
+    oSim.attach(pSignal, {SIGNAL_PIN, uiSensorPin});
+    oSim.setAlertFunc(SIGNAL_PIN, SimSignal::onAlert, nullptr);
+
+    SimClock oClock(oSim);
+    oClock.watch(pLight, uiLightPin);
+    oClock.watch(pSignal, SIGNAL_PIN);
+
+    const uint64_t ullEndNs = static_cast<uint64_t>(oConf.m_dDays * 24 * HOUR_NS);
+    const uint64_t ullRestartNs = std::max<uint64_t>(static_cast<uint64_t>(oConf.m_dRestartHours * HOUR_NS),
+                                                     MINUTE_NS);
+    const uint64_t ullStuckNs = oScenario.bLightStuck ? ullEndNs / 2 : UINT64_MAX;
+
+    // Whole degrees and percents, following a daily cycle in steps
+    auto truth = [](uint64_t ullNowNs) {
+        double dAngle = 2 * M_PI * static_cast<double>(ullNowNs / WEATHER_STEP_NS * WEATHER_STEP_NS) / (24 * HOUR_NS);
+        return std::make_pair(static_cast<uint8_t>(std::lround(21 + 4 * std::sin(dAngle))),
+                              static_cast<uint8_t>(std::lround(50 + 12 * std::cos(dAngle))));
+    };
+
+    uint64_t ullReads = 0, ullReadsOk = 0, ullCorrupted = 0, ullLost = 0, ullBrightnessChanges = 0;
+    uint64_t ullFrames = 0, ullFailedFrames = 0, ullChecks = 0, ullMismatches = 0, ullUncleared = 0;
+    int iBrightness = -1;
+    std::vector<uint64_t> vShutdownNs;
+    auto start = std::chrono::steady_clock::now();
+
+    while (oSim.nowNs() < ullEndNs) {
+        // Every other signal is aimed at a sensor read, the rest land anywhere
+        uint64_t ullSignalNs = oSim.nowNs() + ullRestartNs / 2 +
+                               std::uniform_int_distribution<uint64_t>(0, ullRestartNs / 2)(oRng);
+        if (vShutdownNs.size() % 2) {
+            pSignal->aim(ullSignalNs);
+        } else {
+            pSignal->arm(ullSignalNs);
+        }
+
+        Reactor oReactor(&oClock);
+        if (!oReactor.isOpen() || !Service::stopOnSignals(oReactor)) {
+            std::cerr << oScenario.pName << ": failed to set up the event loop\n";
+            return false;
+        }
+        uint64_t ullNow = oSim.nowNs();
+        pSensor->setReading(truth(ullNow).first, truth(ullNow).second);
+        std::unique_ptr<Service> pService(new Service(oAppConf, oPinConf, oReactor));
+
+        // Every read off the bus, checked against what the sensor was given
+        uint32_t uiCursor = pService->bus().end();
+        auto drain = [&]() {
+            auto oNow = oClock.steady();
+            ullLost += pService->bus().readSince(uiCursor, [&](const SampleBus::Record& oRecord) {
+                ++ullReads;
+                if (!oRecord.bValid) {
+                    return;
+                }
+                ++ullReadsOk;
+                // The weather may step while a read is under way
+                uint64_t ullAtNs = oSim.nowNs() - uint64_t(oRecord.ageMs(oNow)) * 1000000;
+                auto oTruth = truth(ullAtNs);
+                auto oBefore = truth(ullAtNs > 1000000000 ? ullAtNs - 1000000000 : 0);
+                if ((oRecord.fTemp != oTruth.first || oRecord.fHum != oTruth.second) &&
+                    (oRecord.fTemp != oBefore.first || oRecord.fHum != oBefore.second)) {
+                    ++ullCorrupted;
+                }
+            });
+            // Polled often enough to catch every switch of the light
+            int iShown = pDisplay->brightness();
+            ullBrightnessChanges += iBrightness >= 0 && iShown != iBrightness;
+            iBrightness = iShown;
+        };
+
+        int iWeatherTimer = oReactor.addTimer(CLOCK_MONOTONIC, [&]() {
+            uint64_t ullAt = oSim.nowNs();
+            pSensor->setReading(truth(ullAt).first, truth(ullAt).second);
+        });
+        oReactor.armAfter(iWeatherTimer, std::chrono::nanoseconds((ullNow / WEATHER_STEP_NS + 1) * WEATHER_STEP_NS - ullNow),
+                          std::chrono::nanoseconds(WEATHER_STEP_NS));
+
+        // Half past every hour, far from the light switches
+        int iCheckTimer = oReactor.addTimer(CLOCK_MONOTONIC, [&]() {
+            // The brightness follows the light, or a stuck sensor
+            ++ullChecks;
+            ullMismatches += pDisplay->brightness() != (pLight->drive(uiLightPin, oSim.nowNs()) ? 6 : 2);
+        });
+        oReactor.armAfter(iCheckTimer, std::chrono::nanoseconds((ullNow + HOUR_NS / 2) / HOUR_NS * HOUR_NS + HOUR_NS / 2 - ullNow),
+                          std::chrono::nanoseconds(HOUR_NS));
+
+        int iDrainTimer = oReactor.addTimer(CLOCK_MONOTONIC, drain);
+        oReactor.armAfter(iDrainTimer, std::chrono::nanoseconds(DRAIN_PERIOD_NS), std::chrono::nanoseconds(DRAIN_PERIOD_NS));
+
+        if (ullStuckNs > ullNow && ullStuckNs < ullEndNs) {
+            int iStuckTimer = oReactor.addTimer(CLOCK_MONOTONIC, [&]() {
+                // Frozen at whatever it showed, no edge tells the display
+                pLight->setStuck(pLight->drive(uiLightPin, oSim.nowNs()));
+            });
+            oReactor.armAfter(iStuckTimer, std::chrono::nanoseconds(ullStuckNs - ullNow));
+        }
+
+        bool bEnded = false;
+        int iEndTimer = oReactor.addTimer(CLOCK_MONOTONIC, [&]() {
+            bEnded = true;
+            oReactor.stop();
+        });
+        oReactor.armAfter(iEndTimer, std::chrono::nanoseconds(ullEndNs - ullNow));
+
+        pService->start();
+        oReactor.run();
+        uint64_t ullStoppedNs = oSim.nowNs();
+
+        drain();
+        const addons::TM1637::FrameStats& oStats = pService->display().frameStats();
+        ullFrames += oStats.ullFull + oStats.ullPartial + oStats.ullControl + oStats.ullFailed;
+        ullFailedFrames += oStats.ullFailed;
+
+        // Shutdown is over once the display is cleared
+        pService.reset();
+        for (uint8_t uiSegments : pDisplay->segments()) {
+            if (uiSegments) {
+                ++ullUncleared;
+                break;
+            }
+        }
+
+        if (!bEnded && pSignal->at() > ullStoppedNs) {
+            // Not one of ours, the soak itself is asked to stop
+            std::cerr << oScenario.pName << ": interrupted\n";
+            exit(1);
+        }
+        if (!bEnded) {
+            vShutdownNs.push_back(oSim.nowNs() - pSignal->at());
+        } else if (pSignal->at() <= oSim.nowNs()) {
+            // Fired during the last shutdown, too late for the loop
+            sigset_t oMask;
+            sigemptyset(&oMask);
+            sigaddset(&oMask, SIGTERM);
+            timespec oNoWait = {};
+            sigtimedwait(&oMask, nullptr, &oNoWait);
+        }
+        pSignal->arm(UINT64_MAX);
+    }
+
+    double dWallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double dHours = static_cast<double>(oSim.nowNs()) / HOUR_NS;
+    double dReadSuccess = ullReads ? static_cast<double>(ullReadsOk) / ullReads : 0;
+    double dFramesPerHour = pDisplay->frames() / dHours;
+    double dFailedShare = ullFrames ? static_cast<double>(ullFailedFrames) / ullFrames : 0;
+    std::sort(vShutdownNs.begin(), vShutdownNs.end());
+    uint64_t ullShutdownMaxNs = vShutdownNs.empty() ? 0 : vShutdownNs.back();
+    uint64_t ullShutdownP50Ns = vShutdownNs.empty() ? 0 : vShutdownNs[vShutdownNs.size() / 2];
+
+    std::vector<std::string> vFailures;
+    if (dReadSuccess < oScenario.dMinReadSuccess) {
+        vFailures.push_back("read success " + std::to_string(dReadSuccess) + " < " +
+                            std::to_string(oScenario.dMinReadSuccess));
+    }
+    if (ullCorrupted) {
+        vFailures.push_back(std::to_string(ullCorrupted) + " corrupted readings accepted");
+    }
+    if (ullLost) {
+        vFailures.push_back(std::to_string(ullLost) + " readings lost off the bus");
+    }
+    if (dFramesPerHour < MIN_FRAMES_PER_HOUR) {
+        vFailures.push_back("frames per hour " + std::to_string(dFramesPerHour) + " < " +
+                            std::to_string(MIN_FRAMES_PER_HOUR));
+    }
+    if (dFailedShare > MAX_FAILED_FRAME_SHARE) {
+        vFailures.push_back("failed frames " + std::to_string(dFailedShare) + " > " +
+                            std::to_string(MAX_FAILED_FRAME_SHARE));
+    }
+    if (ullMismatches) {
+        vFailures.push_back(std::to_string(ullMismatches) + " of " + std::to_string(ullChecks) +
+                            " brightness checks off the light sensor");
+    }
+    if (vShutdownNs.empty() && ullEndNs > ullRestartNs) {
+        vFailures.push_back("no SIGTERM was handled");
+    }
+    if (ullShutdownMaxNs > MAX_SHUTDOWN_NS) {
+        vFailures.push_back("shutdown took " + std::to_string(ullShutdownMaxNs / 1000) + " us");
+    }
+    if (ullUncleared) {
+        vFailures.push_back("display left on after " + std::to_string(ullUncleared) + " shutdowns");
+    }
+    for (const std::string& sFailure : vFailures) {
+        std::cerr << oScenario.pName << ": FAILED, " << sFailure << "\n";
+    }
+
+    oResults.add(oScenario.pName, {
+        {"passed", vFailures.empty() ? 1 : 0},
+        {"virtual_hours", dHours},
+        {"wall_seconds", dWallSeconds},
+        {"speedup", dHours * 3600 / dWallSeconds},
+        {"reads", static_cast<double>(ullReads)},
+        {"read_success", dReadSuccess},
+        {"faulty_sensor_frames", static_cast<double>(pSensor->faultyFrames())},
+        {"corrupted_accepted", static_cast<double>(ullCorrupted)},
+        {"frames_per_hour", dFramesPerHour},
+        {"failed_frame_share", dFailedShare},
+        {"nacked_transactions", static_cast<double>(pDisplay->nacked())},
+        {"brightness_changes", static_cast<double>(ullBrightnessChanges)},
+        {"shutdowns", static_cast<double>(vShutdownNs.size())},
+        {"shutdown_p50_ms", ullShutdownP50Ns / 1e6},
+        {"shutdown_max_ms", ullShutdownMaxNs / 1e6},
+    });
+    return vFailures.empty();
+}
+
+void printHelp(const char* programName) {
+    std::cout << "Usage: " << programName << " [options]\n"
+              << "Options:\n"
+              << "  -o, --output <path>         Write the JSON results to a file (default: stdout)\n"
+              << "  -f, --filter <text>         Only run scenarios whose name contains <text>:\n"
+              << "                              clean, sensor_faults, display_nack, light_stuck, all_faults\n"
+              << "  -D, --days <days>           Virtual days per scenario (default: 3)\n"
+              << "  -r, --restart <hours>       Virtual hours between SIGTERMs (default: 6)\n"
+              << "  -s, --seed <n>              Seed of the injected faults (default: 1)\n"
+              << "  -h, --help                  Show this help message\n"
+              << "Progress and failures go to stderr, the exit status is 1 if a scenario failed.\n";
+}
+
+bool parseCommandLineArguments(int argc, char* argv[], SoakConfig &config) {
+    static struct option long_options[] = {
+        {"output",  required_argument, 0, 'o'},
+        {"filter",  required_argument, 0, 'f'},
+        {"days",    required_argument, 0, 'D'},
+        {"restart", required_argument, 0, 'r'},
+        {"seed",    required_argument, 0, 's'},
+        {"help",    no_argument,       0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    int option_index = 0;
+    int c;
+    while ((c = getopt_long(argc, argv, "o:f:D:r:s:h", long_options, &option_index)) != -1) {
+        switch(c) {
+            case 'o': // --output
+                config.m_sOutputPath = optarg;
+                break;
+
+            case 'f': // --filter
+                config.m_sFilter = optarg;
+                break;
+
+            case 'D': // --days
+            case 'r': // --restart
+                try {
+                    double dValue = std::stod(optarg);
+                    // Also rejects NaN
+                    if (!(dValue > 0)) {
+                        throw std::out_of_range("must be positive");
+                    }
+                    if (c == 'D') {
+                        config.m_dDays = dValue;
+                    } else {
+                        config.m_dRestartHours = dValue;
+                    }
+                } catch (const std::exception & e) {
+                    std::cerr << "Parsing error: invalid argument for ["
+                    << "-" << static_cast<char>(c)
+                    << "]: ["
+                    << optarg
+                    << "]: ["
+                    << e.what()
+                    << "]" << std::endl;
+                    return false;
+                }
+                break;
+
+            case 's': // --seed
+                try {
+                    config.m_uiSeed = static_cast<uint32_t>(std::stoul(optarg));
+                } catch (const std::exception & e) {
+                    std::cerr << "Parsing error: invalid argument for seed ["
+                    << optarg
+                    << "]: ["
+                    << e.what()
+                    << "]" << std::endl;
+                    return false;
+                }
+                break;
+
+            case 'h': // --help
+                printHelp(argv[0]);
+                exit(0);
+
+            default:
+                printHelp(argv[0]);
+                return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    SoakConfig config;
+    if (!parseCommandLineArguments(argc, argv, config)) {
+        return 1;
+    }
+
+    // The injected faults would flood the system log otherwise
+    Logger::setup(false, LOG_WARNING, "soak");
+
+    addons::SimDHT11::Faults oNoFaults;
+    addons::SimDHT11::Faults oSensorFaults;
+    oSensorFaults.dMissingEdge = 0.01;
+    oSensorFaults.dStretchedPulse = 0.01;
+    oSensorFaults.dBadChecksum = 0.01;
+
+    const std::vector<Scenario> vScenarios = {
+        // name, sensor faults, NACK rate, stuck light, minimum read success
+        {"clean", oNoFaults, 0, false, 0.999},
+        {"sensor_faults", oSensorFaults, 0, false, 0.95},
+        {"display_nack", oNoFaults, 0.02, false, 0.999},
+        {"light_stuck", oNoFaults, 0, true, 0.999},
+        {"all_faults", oSensorFaults, 0.02, true, 0.95},
+    };
+
+    Results oResults;
+    bool bPassed = true;
+    for (const Scenario& oScenario : vScenarios) {
+        if (std::string(oScenario.pName).find(config.m_sFilter) != std::string::npos) {
+            bPassed &= runScenario(config, oScenario, oResults);
+        }
+    }
+
+    FILE* pOut = stdout;
+    if (!config.m_sOutputPath.empty()) {
+        pOut = std::fopen(config.m_sOutputPath.c_str(), "w");
+        if (!pOut) {
+            std::cerr << "Failed to open output file: " << config.m_sOutputPath << std::endl;
+            return 1;
+        }
+    }
+    oResults.write(pOut, config.m_uiSeed);
+    if (pOut != stdout) {
+        std::fclose(pOut);
+    }
+
+    return bPassed ? 0 : 1;
+}
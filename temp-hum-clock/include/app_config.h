@@ -0,0 +1,63 @@
+#ifndef APP_CONFIG_H_
+#define APP_CONFIG_H_
+
+#include <ctime>
+#include <string>
+#include <syslog.h>
+#include <vector>
+
+#include "GpioBackend.h"
+
+extern const std::string DEFAULT_PIN_CONFIG;
+extern const std::string DEFAULT_TIMING_PROFILE;
+
+// Set from the command line
+class AppConfig {
+public:
+    bool m_bHumidity = false;
+    bool m_bTemperature = false;
+    bool m_bTime = false;
+    bool m_bStdOut = false;
+    bool m_bWave = false;
+    bool m_bAsyncLog = false;
+    int m_ilogLevel = LOG_INFO;
+    time_t m_iShowDelay = 5; // Delay in seconds between changes
+    time_t m_iMaxSampleInterval = 60; // Longest delay in seconds between sensor reads
+    int m_iRealtimePriority = 0; // 0 - taken from the config file
+    int m_iRealtimeCpu = -1; // -1 - taken from the config file
+    int m_iJitterSamples = 0; // 0 - no jitter probe
+    int m_iCalibrationFrames = 0; // 0 - no display calibration
+    std::string m_sPinConfigPath = DEFAULT_PIN_CONFIG;
+    std::string m_sTimingPath = DEFAULT_TIMING_PROFILE;
+    std::string m_sBackend = addons::GpioBackend::defaultName();
+    std::string m_sHistoryPath; // empty - history is not recorded
+    std::string m_sEdgeLogPath; // empty - raw frames are not recorded
+    std::string m_sShmName; // empty - readings are not published
+    std::string m_sMetricsPath; // empty - metrics are not served
+};
+
+// Set from the configuration file
+class PinConfig {
+public:
+
+    std::vector<int> m_vDht11Pins {17}; // GPIO17 (BCM numbering, physical pin 11)
+    int m_iDispIOPin = 23; // GPIO23 (BCM numbering, physical pin 16)
+    int m_iDispClkPin = 18; // GPIO18 (BCM numbering, physical pin 12)
+    int m_iLightSensorPin = 27; //GPIO27 (BCM numbering, physical pin 13)
+    // Light sensor pulses shorter than this are dropped where the backend can
+    int m_iLightGlitchUs = 10000;
+    // The brightness follows the sensor once it stayed put this long
+    int m_iLightDebounceMs = 2000;
+
+    // Samples of the rolling statistics and of the outlier median
+    int m_iFilterWindow = 30;
+    int m_iFilterMedian = 5;
+
+    // Scheduling of the event loop thread, see Realtime::Options
+    int m_iRealtimePriority = 0;
+    int m_iRealtimeCpu = -1;
+
+    bool readPinConfig(std::string sFilepath);
+};
+
+#endif  // APP_CONFIG_H_
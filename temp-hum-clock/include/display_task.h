@@ -0,0 +1,72 @@
+#ifndef DISPLAY_TASK_H_
+#define DISPLAY_TASK_H_
+
+#include <cstdint>
+
+#include "BoolReader.h"
+#include "TM1637.h"
+#include "app_config.h"
+#include "clock.h"
+#include "reactor.h"
+#include "reading_filter.h"
+#include "sample_bus.h"
+
+// Shows the enabled pages in turn, from the bus, at a brightness that
+// follows the light sensor. Clears the display when destroyed.
+class DisplayTask {
+public:
+    enum Page {
+        PAGE_TIME,
+        PAGE_TEMPERATURE,
+        PAGE_HUMIDITY,
+        PAGE_COUNT, // nothing shown yet
+    };
+
+    DisplayTask(const AppConfig& oConf, const PinConfig& oPinConf, const SampleBus& oBus, const Clock& oClock);
+    ~DisplayTask();
+
+    // Lets the brightness follow the light sensor. Edges come from a backend
+    // thread through an eventfd; every edge restarts the debounce timer and
+    // the level is applied when it fires. oReactor must outlive the task,
+    // which takes both off it again.
+    bool trackLight(Reactor& oReactor);
+
+    // Pages enabled on the command line
+    int pageCount() const {
+        return m_oConf.m_bTime + m_oConf.m_bTemperature + m_oConf.m_bHumidity;
+    }
+
+    Page page() const {
+        return m_ePage;
+    }
+
+    // Moves to the next page that has something to show and draws it
+    void rotate();
+    void redraw();
+
+    const addons::TM1637::FrameStats& frameStats() const {
+        return m_oTM1637.frameStats();
+    }
+
+private:
+    static void onLightChange(bool bValue, uint32_t uiTick, void* pUserData);
+
+    bool available(Page ePage) const;
+
+    const AppConfig& m_oConf;
+    const PinConfig& m_oPinConf;
+    const Clock& m_oClock;
+    addons::TM1637 m_oTM1637;
+    addons::BoolReader m_oLightSensor;
+    bool m_bLight = true;
+    Reactor* m_pReactor = nullptr;
+    int m_iLightFd = -1;
+    int m_iLightTimer = -1;
+    // Whole degrees and percents shown, steady while a value hovers between two
+    Hysteresis m_oTempShown {0.25f};
+    Hysteresis m_oHumShown {0.25f};
+    const SampleBus& m_oBus;
+    Page m_ePage = PAGE_COUNT;
+};
+
+#endif  // DISPLAY_TASK_H_
@@ -0,0 +1,90 @@
+#ifndef SENSOR_TASK_H_
+#define SENSOR_TASK_H_
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "DHT11Array.h"
+#include "EdgeLog.h"
+#include "adaptive_sampler.h"
+#include "app_config.h"
+#include "clock.h"
+#include "reading_filter.h"
+#include "reading_publisher.h"
+#include "sample_bus.h"
+#include "sample_store.h"
+
+// DHT11 needs at least a second between reads
+extern const std::chrono::seconds SENSOR_MIN_INTERVAL;
+
+SampleStore::Status toSampleStatus(addons::DHT11::Status eStatus);
+
+// Reads the sensors, records and publishes every reading and puts the first
+// sensor's on the bus, filtered.
+class SensorTask {
+public:
+    // Rolling statistics of the accepted readings, also read by the metrics server thread
+    struct WindowStats {
+        std::atomic<float> fMean {NAN};
+        std::atomic<float> fMin {NAN};
+        std::atomic<float> fMax {NAN};
+
+        void update(const RollingWindow& oWindow) {
+            fMean.store(oWindow.mean(), std::memory_order_relaxed);
+            fMin.store(oWindow.min(), std::memory_order_relaxed);
+            fMax.store(oWindow.max(), std::memory_order_relaxed);
+        }
+    };
+
+    SensorTask(const AppConfig& oAppConf, const PinConfig& oConf, SampleBus& oBus, const Clock& oClock);
+
+    // Publishes the reading of the first sensor, returns true if it succeeded
+    bool sample();
+
+    const WindowStats& temperatureStats() const {
+        return m_oTempStats;
+    }
+
+    const WindowStats& humidityStats() const {
+        return m_oHumStats;
+    }
+
+    uint64_t outliers() const {
+        return m_ullOutliers.load(std::memory_order_relaxed);
+    }
+
+    // Delay until the next read, chosen by the last sample()
+    std::chrono::milliseconds interval() const {
+        return std::chrono::milliseconds(m_llIntervalMs.load(std::memory_order_relaxed));
+    }
+
+private:
+    // Further from the median of the last reads is taken for a corrupt frame
+    static constexpr float MAX_TEMP_DEVIATION = 5.0f;
+    static constexpr float MAX_HUM_DEVIATION = 15.0f;
+
+    static ReadingFilter::Options filterOptions(const PinConfig& oConf, float fMaxDeviation);
+
+    const Clock& m_oClock;
+    addons::DHT11Array m_oSensors;
+    std::vector<addons::DHT11Array::Reading> m_vReadings;
+    std::vector<AdaptiveSampler> m_vSamplers;
+    // Also read by the metrics server thread
+    std::atomic<long long> m_llIntervalMs {std::chrono::milliseconds(SENSOR_MIN_INTERVAL).count()};
+    std::vector<std::unique_ptr<SampleStore>> m_vHistory;
+    addons::EdgeLogWriter m_oEdgeLog;
+    ReadingPublisher m_oPublisher;
+    // Of the first sensor, the one on the bus
+    ReadingFilter m_oTempFilter;
+    ReadingFilter m_oHumFilter;
+    WindowStats m_oTempStats;
+    WindowStats m_oHumStats;
+    std::atomic<uint64_t> m_ullOutliers {0};
+    SampleBus& m_oBus;
+};
+
+#endif  // SENSOR_TASK_H_
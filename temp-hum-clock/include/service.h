@@ -0,0 +1,60 @@
+#ifndef SERVICE_H_
+#define SERVICE_H_
+
+#include <ctime>
+#include <vector>
+
+#include "app_config.h"
+#include "display_task.h"
+#include "reactor.h"
+#include "sample_bus.h"
+#include "sensor_task.h"
+
+// The sensor and display tasks with their timers, everything temp-hum-clock
+// does between setting up and tearing down. The drivers use the process wide
+// GPIO backend, the tasks the clock of the reactor.
+class Service {
+public:
+    // The configs and the reactor must outlive the service
+    Service(const AppConfig& oConf, const PinConfig& oPinConf, Reactor& oReactor);
+    ~Service();
+
+    Service(const Service&) = delete;
+    Service& operator=(const Service&) = delete;
+
+    // Arms the timers and shows the first page, the reactor runs them
+    void start();
+
+    // Stops oReactor on SIGTERM and SIGINT. Must be called before any other
+    // thread is started, see Reactor::addSignals.
+    static bool stopOnSignals(Reactor& oReactor);
+
+    const SampleBus& bus() const {
+        return m_oBus;
+    }
+
+    const SensorTask& sensor() const {
+        return m_oSensor;
+    }
+
+    const DisplayTask& display() const {
+        return m_oDisplay;
+    }
+
+private:
+    int addTimer(clockid_t iClock, Reactor::TimerHandler fHandler);
+    // Arms the log timer for the earliest pending summary, if there is one
+    void armLogExpiry();
+
+    const AppConfig& m_oConf;
+    Reactor& m_oReactor;
+    SampleBus m_oBus;
+    SensorTask m_oSensor;
+    DisplayTask m_oDisplay;
+    // Re-armed from its own callback
+    int m_iSensorTimer = -1;
+    int m_iLogTimer = -1;
+    std::vector<int> m_vTimers;
+};
+
+#endif  // SERVICE_H_
@@ -0,0 +1,66 @@
+#include "app_config.h"
+
+#include <fstream>
+#include <sstream>
+
+#include "logger.h"
+
+const std::string DEFAULT_PIN_CONFIG = "/etc/temp-hum-clock";
+const std::string DEFAULT_TIMING_PROFILE = "/var/lib/temp-hum-clock/tm1637-timing";
+
+bool PinConfig::readPinConfig(std::string sFilepath) {
+
+    std::ifstream oFile(sFilepath);
+    std::string line;
+
+    if (!oFile) {
+        std::stringstream ss;
+        ss << "Error opening file: " << sFilepath;
+        return false;
+    }
+
+    while (std::getline(oFile, line)) {
+        std::istringstream iss(line);
+        std::string key;
+        int value;
+
+        if (!std::getline(iss, key, '=')) {
+            continue;
+        }
+
+        if (key == "DHT11_DATA") {
+            // Comma separated list, the first sensor feeds the display
+            m_vDht11Pins.clear();
+            std::string sPin;
+            while (std::getline(iss, sPin, ',')) {
+                try {
+                    m_vDht11Pins.push_back(std::stoi(sPin));
+                } catch (const std::exception&) {
+                    LOGGER_LOG(LOG_ERR, "Invalid DHT11 pin: [", sPin, "]");
+                }
+            }
+        } else if (iss >> value) {
+            if (key == "TM1637_CLK") {
+                m_iDispClkPin = value;
+            } else if (key == "TM1637_DIO") {
+                m_iDispIOPin = value;
+            } else if (key == "LIGHT_SENSOR") {
+                m_iLightSensorPin = value;
+            } else if (key == "LIGHT_GLITCH_US") {
+                m_iLightGlitchUs = value;
+            } else if (key == "LIGHT_DEBOUNCE_MS") {
+                m_iLightDebounceMs = value;
+            } else if (key == "FILTER_WINDOW") {
+                m_iFilterWindow = value;
+            } else if (key == "FILTER_MEDIAN") {
+                m_iFilterMedian = value;
+            } else if (key == "REALTIME_PRIORITY") {
+                m_iRealtimePriority = value;
+            } else if (key == "REALTIME_CPU") {
+                m_iRealtimeCpu = value;
+            }
+        }
+    }
+
+    return true;
+}
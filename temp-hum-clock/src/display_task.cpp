@@ -0,0 +1,140 @@
+#include "display_task.h"
+
+#include <chrono>
+#include <ctime>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include "PageFrames.h"
+#include "TM1637Timing.h"
+#include "logger.h"
+
+DisplayTask::DisplayTask(const AppConfig& oConf, const PinConfig& oPinConf, const SampleBus& oBus,
+                         const Clock& oClock)
+    : m_oConf(oConf), m_oPinConf(oPinConf), m_oClock(oClock), m_oTM1637(oPinConf.m_iDispIOPin, oPinConf.m_iDispClkPin),
+      m_oLightSensor(oPinConf.m_iLightSensorPin), m_oBus(oBus) {
+    if (oConf.m_bWave) {
+        m_oTM1637.setTransmitMode(addons::TM1637::TRANSMIT_WAVE);
+    }
+
+    addons::TM1637TimingProfile oProfile;
+    addons::TM1637Timing oTiming;
+    if (oProfile.load(oConf.m_sTimingPath) &&
+        oProfile.find(oPinConf.m_iDispClkPin, oPinConf.m_iDispIOPin, oTiming)) {
+        LOGGER_LOG(LOG_INFO, "DisplayTask| Calibrated timing, half bit: [", oTiming.uiHalfBitUs, "] us");
+        m_oTM1637.setTiming(oTiming);
+    }
+
+    if (!m_oLightSensor.read(m_bLight)) {
+        // If it fails to get the brightness, make the brightness max
+        m_bLight = true;
+    }
+    m_oTM1637.setBrightness(m_bLight ? 6 : 2);
+
+    m_oTM1637.display("Run", false);
+}
+
+DisplayTask::~DisplayTask() {
+    m_oLightSensor.unwatch();
+    if (m_pReactor) {
+        m_pReactor->removeTimer(m_iLightTimer);
+        m_pReactor->removeFd(m_iLightFd);
+    }
+    if (m_iLightFd >= 0) {
+        close(m_iLightFd);
+    }
+    m_oTM1637.display("    ", false);
+    m_oTM1637.setBrightness(0);
+}
+
+bool DisplayTask::trackLight(Reactor& oReactor) {
+    m_iLightFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (m_iLightFd < 0) {
+        return false;
+    }
+
+    m_pReactor = &oReactor;
+    m_iLightTimer = oReactor.addTimer(CLOCK_MONOTONIC, [this]() {
+        bool bLight = m_bLight;
+        if (m_oLightSensor.read(bLight) && bLight != m_bLight) {
+            LOGGER_LOG(LOG_INFO, "DisplayTask| Light sensor: [", bLight ? "light" : "dark", "]");
+            m_bLight = bLight;
+            m_oTM1637.setBrightness(m_bLight ? 6 : 2);
+        }
+    });
+    std::chrono::milliseconds oDebounce(m_oPinConf.m_iLightDebounceMs);
+    bool bWatched = m_iLightTimer >= 0 && oReactor.addFd(m_iLightFd, EPOLLIN, [this, oDebounce](uint32_t) {
+        uint64_t ullEdges;
+        if (::read(m_iLightFd, &ullEdges, sizeof(ullEdges)) > 0) {
+            m_pReactor->armAfter(m_iLightTimer, oDebounce);
+        }
+    });
+
+    return bWatched && m_oLightSensor.watch(m_oPinConf.m_iLightGlitchUs, onLightChange, this);
+}
+
+void DisplayTask::rotate() {
+    for (int i = 1; i <= PAGE_COUNT + 1; ++i) {
+        Page ePage = static_cast<Page>((m_ePage + i) % (PAGE_COUNT + 1));
+        if (available(ePage)) {
+            m_ePage = ePage;
+            break;
+        }
+    }
+    redraw();
+}
+
+void DisplayTask::redraw() {
+    // Both values always come from the same read
+    SampleBus::Record oRecord;
+    bool bRecord = m_oBus.latestValid(oRecord);
+    addons::pages::Frame aFrame;
+
+    switch (m_ePage) {
+        case PAGE_TIME: {
+            std::time_t now = std::chrono::system_clock::to_time_t(m_oClock.wall());
+            std::tm local_tm;
+            localtime_r(&now, &local_tm);
+            m_oTM1637.display(addons::pages::clockFrame(local_tm.tm_hour, local_tm.tm_min), true);
+            break;
+        }
+
+        case PAGE_TEMPERATURE:
+            if (bRecord && addons::pages::temperature(m_oTempShown.push(oRecord.fTempFiltered), aFrame)) {
+                m_oTM1637.display(aFrame, false);
+            }
+            break;
+
+        case PAGE_HUMIDITY:
+            if (bRecord && addons::pages::humidity(m_oHumShown.push(oRecord.fHumFiltered), aFrame)) {
+                m_oTM1637.display(aFrame, false);
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+void DisplayTask::onLightChange(bool /*bValue*/, uint32_t /*uiTick*/, void* pUserData) {
+    DisplayTask& oTask = *static_cast<DisplayTask*>(pUserData);
+    uint64_t ullOne = 1;
+    if (::write(oTask.m_iLightFd, &ullOne, sizeof(ullOne)) < 0) {
+        // Counter full: a wakeup is already pending
+    }
+}
+
+bool DisplayTask::available(Page ePage) const {
+    SampleBus::Record oRecord;
+    switch (ePage) {
+        case PAGE_TIME:
+            return m_oConf.m_bTime;
+        case PAGE_TEMPERATURE:
+            return m_oConf.m_bTemperature && m_oBus.latestValid(oRecord);
+        case PAGE_HUMIDITY:
+            return m_oConf.m_bHumidity && m_oBus.latestValid(oRecord);
+        default:
+            return false;
+    }
+}
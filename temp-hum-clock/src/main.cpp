@@ -1,93 +1,35 @@
 #include <atomic>
+#include <chrono>
+#include <cmath>
 #include <iostream>
 #include <cstdlib>
 #include <getopt.h>
-#include <pigpio.h>
-#include <sstream>
 #include <string>
 #include <sys/syslog.h>
-#include <unistd.h>
-#include <csignal>
-#include <iomanip>
-#include <optional>
-#include <thread>
-#include <fstream>
-#include <condition_variable>
-#include <mutex>
-
-#include "BoolReader.h"
-#include "DHT11.h"
+#include <memory>
+#include <vector>
+
+#include "GpioBackend.h"
+#include "JitterProbe.h"
+#include "SimDevices.h"
+#include "SimGpioBackend.h"
 #include "TM1637.h"
+#include "TM1637Timing.h"
+#include "app_config.h"
 #include "logger.h"
-
-std::atomic_bool bTermSignal = false;
-std::condition_variable cvTerminate;
-std::mutex oMutex;
-std::atomic<std::optional<float>> fTemp;
-std::atomic<std::optional<float>> fHum;
-
-const std::string DEFAULT_PIN_CONFIG = "/etc/temp-hum-clock";
-
-class AppConfig {
-public:
-    bool m_bHumidity = false;
-    bool m_bTemperature = false;
-    bool m_bTime = false;
-    bool m_bStdOut = false;
-    int m_ilogLevel = LOG_INFO;
-    time_t m_iShowDelay = 5; // Delay in seconds between changes
-    std::string m_sPinConfigPath = DEFAULT_PIN_CONFIG;
-};
-
-class PinConfig {
-public:
-
-    int m_iDht11Pin = 17; // GPIO17 (BCM numbering, physical pin 11)
-    int m_iDispIOPin = 23; // GPIO23 (BCM numbering, physical pin 16)
-    int m_iDispClkPin = 18; // GPIO18 (BCM numbering, physical pin 12)
-    int m_iLightSensorPin = 27; //GPIO27 (BCM numbering, physical pin 13)
-
-    bool readPinConfig(std::string sFilepath) {
-
-        std::ifstream oFile(sFilepath);
-        std::string line;
-        
-        if (!oFile) {
-            std::stringstream ss;
-            ss << "Error opening file: " << sFilepath;
-            return false;
-        }
-    
-        while (std::getline(oFile, line)) {
-            std::istringstream iss(line);
-            std::string key;
-            int value;
-            
-            if (std::getline(iss, key, '=') && (iss >> value)) {
-                if (key == "TM1637_CLK") {
-                    m_iDispClkPin = value;
-                } else if (key == "TM1637_DIO") {
-                    m_iDispIOPin = value;
-                } else if (key == "DHT11_DATA") {
-                    m_iDht11Pin = value;
-                } else if (key == "LIGHT_SENSOR") {
-                    m_iLightSensorPin = value;
-                }
-            }
-        }
-
-        return true;
-    }
-};
-
-void signalHandler(int signal) {
-    if (signal == SIGTERM || signal == SIGINT) {
-        Logger::log(LOG_INFO, "Received signal: " + std::to_string(signal));
-        bTermSignal.store(true);
-        std::unique_lock <std::mutex> lock (oMutex);
-        cvTerminate.notify_all();
-    }
-}
+#include "metrics.h"
+#include "reactor.h"
+#include "reading_shm.h"
+#include "realtime.h"
+#include "sample_bus.h"
+#include "sensor_task.h"
+#include "service.h"
+
+// A failing sensor or display logs on every cycle, identical records are
+// summarised and the rest is held to a steady trickle
+const std::chrono::seconds LOG_DEDUP_WINDOW(60);
+const double LOG_RECORDS_PER_SECOND = 5;
+const double LOG_RECORDS_BURST = 50;
 
 void printHelp(const char* programName) {
     std::cout << "Usage: " << programName << " [options]\n"
@@ -99,6 +41,19 @@ void printHelp(const char* programName) {
               << "  -d, --delay <seconds>       Set delay in seconds between changes (default: 10)\n"
               << "  -s, --stdout                Output logs to stdout (default: false)\n"
               << "  -p, --loglevel              Set the log level (default: 6 - LOG_INFO)\n"
+              << "  -R, --realtime <priority>   Run the GPIO loop under SCHED_FIFO with memory locked (default: off)\n"
+              << "  -C, --cpu <core>            Pin the GPIO loop to a CPU core (default: any)\n"
+              << "  -j, --jitter-probe <count>  Measure <count> GPIO delays of each driver duration and exit\n"
+              << "  -K, --calibrate <frames>    Find the fastest display timing ACKed over <frames> trial frames, save it and exit\n"
+              << "  -k, --timing <path>         Display timing profile (default: " << DEFAULT_TIMING_PROFILE << ")\n"
+              << "  -i, --max-interval <sec>    Longest delay between sensor reads (default: 60)\n"
+              << "  -r, --history <path>        Append every sensor sample to a history file (default: off)\n"
+              << "  -e, --edge-log <path>       Append the raw edges of every sensor frame to a file (default: off)\n"
+              << "  -a, --async-log             Write logs from a background thread (default: false)\n"
+              << "  -w, --wave                  Send display frames as DMA waves (default: false)\n"
+              << "  -P, --publish <name>        Publish the latest readings in a shared memory segment, e.g. " << ReadingShm::DEFAULT_NAME << " (default: off)\n"
+              << "  -m, --metrics <path>        Serve Prometheus metrics on a Unix socket (default: off)\n"
+              << "  -b, --backend <name>        GPIO backend: pigpio, pigpiod, sim (default: " << addons::GpioBackend::defaultName() << ")\n"
               << "  -h, --help                  Show this help message\n";
 }
 
@@ -115,11 +70,24 @@ bool parseCommandLineArguments(int argc, char* argv[], AppConfig &config) {
         {"loglevel",    required_argument, 0, 'p'},
         {"help",        no_argument,       0, 'h'},
         {"pin-config",  required_argument, 0, 'c'},
+        {"backend",     required_argument, 0, 'b'},
+        {"wave",        no_argument,       0, 'w'},
+        {"async-log",   no_argument,       0, 'a'},
+        {"history",     required_argument, 0, 'r'},
+        {"edge-log",    required_argument, 0, 'e'},
+        {"max-interval", required_argument, 0, 'i'},
+        {"realtime",    required_argument, 0, 'R'},
+        {"cpu",         required_argument, 0, 'C'},
+        {"jitter-probe", required_argument, 0, 'j'},
+        {"metrics",     required_argument, 0, 'm'},
+        {"calibrate",   required_argument, 0, 'K'},
+        {"timing",      required_argument, 0, 'k'},
+        {"publish",     required_argument, 0, 'P'},
         {0, 0, 0, 0}
     };
 
     // Option string: 'd' requires an argument (hence the colon).
-    const char* optionString = "HTtd:sp:hc:";
+    const char* optionString = "HTtd:sp:hc:b:war:e:m:P:i:R:C:j:K:k:";
 
     int option_index = 0;
     int c;
@@ -186,6 +154,82 @@ bool parseCommandLineArguments(int argc, char* argv[], AppConfig &config) {
                 config.m_sPinConfigPath = optarg;
                 break;
 
+            case 'b': // --backend
+                config.m_sBackend = optarg;
+                break;
+
+            case 'w': // --wave
+                config.m_bWave = true;
+                break;
+
+            case 'a': // --async-log
+                config.m_bAsyncLog = true;
+                break;
+
+            case 'i': // --max-interval
+                try {
+                    config.m_iMaxSampleInterval = std::stoi(optarg);
+                } catch (const std::exception & e) {
+                    std::cerr << "Parsing error: invalid argument for max interval ["
+                    << optarg
+                    << "]: ["
+                    << e.what()
+                    << "]" << std::endl;
+                    return false;
+                }
+                break;
+
+            case 'R': // --realtime
+            case 'C': // --cpu
+            case 'j': // --jitter-probe
+            case 'K': // --calibrate
+                try {
+                    int iValue = std::stoi(optarg);
+                    if (c == 'R') {
+                        // 0 would silently fall back to the config file
+                        if (iValue < 1 || iValue > 99) {
+                            throw std::out_of_range("SCHED_FIFO priority is 1-99");
+                        }
+                        config.m_iRealtimePriority = iValue;
+                    } else if (c == 'C') {
+                        config.m_iRealtimeCpu = iValue;
+                    } else if (c == 'j') {
+                        config.m_iJitterSamples = iValue;
+                    } else {
+                        config.m_iCalibrationFrames = iValue;
+                    }
+                } catch (const std::exception & e) {
+                    std::cerr << "Parsing error: invalid argument for ["
+                    << "-" << static_cast<char>(c)
+                    << "]: ["
+                    << optarg
+                    << "]: ["
+                    << e.what()
+                    << "]" << std::endl;
+                    return false;
+                }
+                break;
+
+            case 'r': // --history
+                config.m_sHistoryPath = optarg;
+                break;
+
+            case 'e': // --edge-log
+                config.m_sEdgeLogPath = optarg;
+                break;
+
+            case 'm': // --metrics
+                config.m_sMetricsPath = optarg;
+                break;
+
+            case 'P': // --publish
+                config.m_sShmName = optarg;
+                break;
+
+            case 'k': // --timing
+                config.m_sTimingPath = optarg;
+                break;
+
             case 'h': // --help
                 printHelp(argv[0]);
                 exit(0);
@@ -203,145 +247,191 @@ bool parseCommandLineArguments(int argc, char* argv[], AppConfig &config) {
     return true;
 }
 
-void dht11Runner(const PinConfig& oConf) {
-    addons::DHT11 oDht11(oConf.m_iDht11Pin);
-
-    while(!bTermSignal.load()) {
-        float fTmpTemp;
-        float fTmpHum;
-
-        if(oDht11.read( fTmpTemp, fTmpHum)) {
-            fHum.store(fTmpHum);
-            fTemp.store(fTmpTemp);
-            std::stringstream ss;
-            ss << std::fixed << std::setprecision(1) << fTemp.load().value() << "C*\t" << fHum.load().value();
-            Logger::log(LOG_DEBUG, "dht11Runner| Getting data from the sensor:" + ss.str());
-        } else {
-            Logger::log(LOG_ERR, "Failed to get info from the DHT11 sensor");
-        }
-
-        std::unique_lock <std::mutex> lock (oMutex);
-        auto sec = std::chrono::seconds(20);
-        cvTerminate.wait_for(lock, sec);
+void attachSimulatedDevices(addons::SimGpioBackend& oSim, const PinConfig& oPinConf) {
+    for (int iPin : oPinConf.m_vDht11Pins) {
+        oSim.attach(std::make_shared<addons::SimDHT11>(iPin), {static_cast<unsigned>(iPin)});
     }
+    // The simulated clock only moves with GPIO calls, far slower than the wall
+    // clock, so the light switches every simulated second
+    oSim.attach(std::make_shared<addons::SimLightSensor>(oPinConf.m_iLightSensorPin, 1000),
+                {static_cast<unsigned>(oPinConf.m_iLightSensorPin)});
+    // Needs some slack on the clock like real modules, for the calibration
+    auto pDisplay = std::make_shared<addons::SimTM1637>(oPinConf.m_iDispClkPin, oPinConf.m_iDispIOPin);
+    pDisplay->setMinClockPhaseNs(3000);
+    oSim.attach(pDisplay, {
+        static_cast<unsigned>(oPinConf.m_iDispClkPin),
+        static_cast<unsigned>(oPinConf.m_iDispIOPin)
+    });
 }
 
-void updateDisplayDuringTime(const AppConfig &oConf, addons::TM1637 &oTM1637) {
-    if (oConf.m_bTime) {
-        auto endTime = std::chrono::system_clock::now() + std::chrono::seconds(oConf.m_iShowDelay);
-        while (std::chrono::system_clock::now() < endTime && !bTermSignal.load()) {
-            auto now = std::chrono::system_clock::now();
-            std::time_t now_c = std::chrono::system_clock::to_time_t(now);
-            std::tm* local_tm = std::localtime(&now_c);
-
-            std::ostringstream oss;
-            oss << std::setw(2) << std::setfill('0') << local_tm->tm_hour
-                << std::setw(2) << std::setfill('0') << local_tm->tm_min;
-            std::string timeStr = oss.str();
-
-            oTM1637.display(timeStr, true);
-            std::this_thread::sleep_for(std::chrono::milliseconds(50));
-        }
+int main(int argc, char* argv[]) {
+    AppConfig config;
+    if (!parseCommandLineArguments(argc, argv, config)) {
+        return 1;
     }
-}
-
-void TM1637Runner(const AppConfig& oConf, const PinConfig& oPinConf) {
-    addons::TM1637 oTM1637(oPinConf.m_iDispIOPin, oPinConf.m_iDispClkPin);
-    addons::BoolReader oLightSensor(oPinConf.m_iLightSensorPin);
 
-    bool bLight = false;
-    if (!oLightSensor.read(bLight)) {
-        // If it fails to get the brightness, make the brightness max
-        bLight = true;
+    // Signals are read from the event loop, blocked before any thread starts
+    Reactor oReactor;
+    bool bSignals = Service::stopOnSignals(oReactor);
+    if (!oReactor.isOpen() || !bSignals) {
+        std::cerr << "Failed to set up the event loop" << std::endl;
+        return 1;
     }
-    oTM1637.setBrightness(bLight ? 6 : 2);
-
-
-    oTM1637.display("Run", false);
 
-    while(!bTermSignal.load()) {
-        float fTmpTemp;
-        float fTmpHum;
-
-        std::stringstream ss;
-
-        if (oConf.m_bTime) {
-            updateDisplayDuringTime(oConf, oTM1637);
-        }
-
-        if (bTermSignal.load()) {
-            break;
-        }
-
-        if (oConf.m_bTemperature && fTemp.load().has_value()) {
-            ss.clear();
-            float fTmpTemp = fTemp.load().value();
-            if (fTmpTemp < 0) {
-                ss << std::setw(3) << std::fixed << std::setprecision(0) << fTmpTemp << "*";
-            } else {
-                ss << std::setw(2) << std::fixed << std::setprecision(0) << fTmpTemp << "*C";
-            }
-
-            oTM1637.display(ss.str(), false);
-
-            std::unique_lock <std::mutex> lock (oMutex);
-            auto sec = std::chrono::seconds(oConf.m_iShowDelay);
-            cvTerminate.wait_for(lock, sec);
-        }
-
-        if (bTermSignal.load()) {
-            break;
-        }
+    Logger::setup(config.m_bStdOut, config.m_ilogLevel, "temp-hum-clock",
+                  config.m_bAsyncLog ? Logger::MODE_ASYNC : Logger::MODE_SYNC);
+    Logger::setDedupWindow(LOG_DEDUP_WINDOW);
+    // Never hold back what is about to bring the service down
+    for (int iPriority = LOG_ERR; iPriority <= LOG_DEBUG; ++iPriority) {
+        Logger::setRateLimit(iPriority, LOG_RECORDS_PER_SECOND, LOG_RECORDS_BURST);
+    }
 
-        if (oConf.m_bHumidity && fHum.load().has_value()) {
-            ss.clear();
-            float fTmpHum = fHum.load().value();
-            ss << std::setw(4) << std::setprecision(0) << fTmpHum;
+    if (!config.m_bTime && !config.m_bTemperature && !config.m_bHumidity) {
+        Logger::log(LOG_WARNING, "All options to display are disabled. Exiting");
+        return 0;
+    }
 
-            oTM1637.display(ss.str(), false);
+    PinConfig pinConfig;
+    pinConfig.readPinConfig(config.m_sPinConfigPath);
 
-            std::unique_lock <std::mutex> lock (oMutex);
-            auto sec = std::chrono::seconds(oConf.m_iShowDelay);
-            cvTerminate.wait_for(lock, sec);
-        }
+    std::unique_ptr<addons::GpioBackend> pGpio = addons::GpioBackend::create(config.m_sBackend);
+    if (!pGpio) {
+        Logger::log(LOG_ERR, "Unknown GPIO backend: " + config.m_sBackend);
+        return 1;
     }
 
-    oTM1637.display("    ", false);
-    oTM1637.setBrightness(0);
-}
-
-int main(int argc, char* argv[]) {
-    if (gpioInitialise() < 0) {
+    if (pGpio->initialise() < 0) {
         Logger::log(LOG_ERR, "Failed to initialize GPIO");
         return 1;
     }
 
-    std::signal(SIGTERM, signalHandler);
-    std::signal(SIGINT, signalHandler);
-
-    AppConfig config;
-    if (!parseCommandLineArguments(argc, argv, config)) {
-        return 1;
+    if (auto pSim = dynamic_cast<addons::SimGpioBackend*>(pGpio.get())) {
+        attachSimulatedDevices(*pSim, pinConfig);
+    }
+    addons::GpioBackend::setInstance(pGpio.get());
+
+    metrics::Callback oLogEmitted(metrics::Metric::TYPE_COUNTER, "logger_records_total",
+                                  "Log records by fate", [] { return Logger::emitted(); }, "fate=\"emitted\"");
+    metrics::Callback oLogSuppressed(metrics::Metric::TYPE_COUNTER, "logger_records_total",
+                                     "Log records by fate", [] { return Logger::suppressed(); }, "fate=\"suppressed\"");
+    metrics::Callback oLogDropped(metrics::Metric::TYPE_COUNTER, "logger_records_total",
+                                  "Log records by fate", [] { return Logger::dropped(); }, "fate=\"dropped\"");
+    metrics::Callback oLogDeduplicated(metrics::Metric::TYPE_COUNTER, "logger_records_total", "Log records by fate",
+                                       [] { return Logger::deduplicated(); }, "fate=\"deduplicated\"");
+    metrics::Callback oLogRateLimited(metrics::Metric::TYPE_COUNTER, "logger_records_total", "Log records by fate",
+                                      [] { return Logger::rateLimited(); }, "fate=\"rate_limited\"");
+    metrics::Server oMetrics;
+    if (!config.m_sMetricsPath.empty()) {
+        oMetrics.start(config.m_sMetricsPath);
     }
 
-    Logger::setup(config.m_bStdOut, config.m_ilogLevel, "temp-hum-clock");
+    // After the helper threads are started (the logger, the metrics server
+    // and the backend's alert thread, see GpioBackend::initialise), they must
+    // not inherit SCHED_FIFO
+    Realtime::Options oRealtime;
+    oRealtime.m_iPriority = config.m_iRealtimePriority ? config.m_iRealtimePriority : pinConfig.m_iRealtimePriority;
+    oRealtime.m_iCpu = config.m_iRealtimeCpu >= 0 ? config.m_iRealtimeCpu : pinConfig.m_iRealtimeCpu;
+    if (oRealtime.m_iPriority > 0 || oRealtime.m_iCpu >= 0) {
+        Realtime::apply(oRealtime);
+    }
 
-    if (!config.m_bTime && !config.m_bTemperature && !config.m_bHumidity) {
-        Logger::log(LOG_WARNING, "All options to display are disabled. Exiting");
+    if (config.m_iJitterSamples > 0) {
+        // Bit delays of TM1637, the DHT11 start pulse and the alert wait step
+        addons::JitterProbe oProbe(*pGpio);
+        addons::JitterProbe::print(std::cout, oProbe.run({10, 20, 50, 1000, 18000}, config.m_iJitterSamples));
+        pGpio->terminate();
+        Logger::shutdown();
         return 0;
     }
 
-    PinConfig pinConfig;
-    pinConfig.readPinConfig(config.m_sPinConfigPath);
+    if (config.m_iCalibrationFrames > 0) {
+        addons::TM1637 oDisplay(pinConfig.m_iDispIOPin, pinConfig.m_iDispClkPin, *pGpio);
+        addons::TM1637Timing oTiming;
+        bool bCalibrated = oDisplay.calibrate(config.m_iCalibrationFrames, oTiming);
+        if (bCalibrated) {
+            // Keeps the profiles of the other pin pairs
+            addons::TM1637TimingProfile oProfile;
+            oProfile.load(config.m_sTimingPath);
+            oProfile.set(pinConfig.m_iDispClkPin, pinConfig.m_iDispIOPin, oTiming);
+            bCalibrated = oProfile.save(config.m_sTimingPath);
+        }
+        std::cout << "half bit " << oTiming.uiHalfBitUs << " us, edge " << oTiming.uiEdgeUs
+                  << " us, digit gap " << oTiming.uiDigitGapUs << " us, ACK window "
+                  << oTiming.uiAckPolls * oTiming.uiAckPollUs << " us, frame " << oTiming.frameUs(4)
+                  << " us (default " << addons::TM1637Timing().frameUs(4) << " us)"
+                  << (bCalibrated ? "" : ", not saved") << std::endl;
+        oDisplay.clear();
+        pGpio->terminate();
+        Logger::shutdown();
+        return bCalibrated ? 0 : 1;
+    }
 
-    std::thread DHT11Thread(dht11Runner, pinConfig);
-    std::thread TM1637Thread(TM1637Runner, config, pinConfig);
+    {
+        Service oService(config, pinConfig, oReactor);
+        const SensorTask& oSensor = oService.sensor();
+        const SampleBus& oBus = oService.bus();
+        metrics::Callback oSampleInterval(metrics::Metric::TYPE_GAUGE, "dht11_sample_interval_seconds",
+                                          "Delay until the next sensor read", [&oSensor] {
+            return oSensor.interval().count() / 1000.0;
+        });
+        // Read from the metrics thread, off the bus
+        metrics::Callback oTemperature(metrics::Metric::TYPE_GAUGE, "dht11_temperature_celsius",
+                                       "Last successful temperature reading", [&oBus] {
+            SampleBus::Record oRecord;
+            return oBus.latestValid(oRecord) ? oRecord.fTemp : NAN;
+        });
+        metrics::Callback oHumidity(metrics::Metric::TYPE_GAUGE, "dht11_humidity_percent",
+                                    "Last successful humidity reading", [&oBus] {
+            SampleBus::Record oRecord;
+            return oBus.latestValid(oRecord) ? oRecord.fHum : NAN;
+        });
+        metrics::Callback oReadingAge(metrics::Metric::TYPE_GAUGE, "dht11_reading_age_seconds",
+                                      "Time since the last successful reading", [&oBus] {
+            SampleBus::Record oRecord;
+            return oBus.latestValid(oRecord) ? oRecord.ageMs() / 1000.0 : NAN;
+        });
+        metrics::Callback oTemperatureFiltered(metrics::Metric::TYPE_GAUGE, "dht11_temperature_filtered_celsius",
+                                               "Temperature with outliers rejected, smoothed", [&oBus] {
+            SampleBus::Record oRecord;
+            return oBus.latestValid(oRecord) ? oRecord.fTempFiltered : NAN;
+        });
+        metrics::Callback oHumidityFiltered(metrics::Metric::TYPE_GAUGE, "dht11_humidity_filtered_percent",
+                                            "Humidity with outliers rejected, smoothed", [&oBus] {
+            SampleBus::Record oRecord;
+            return oBus.latestValid(oRecord) ? oRecord.fHumFiltered : NAN;
+        });
+        metrics::Callback oOutliers(metrics::Metric::TYPE_COUNTER, "dht11_outliers_total",
+                                    "Readings rejected as outliers", [&oSensor] {
+            return static_cast<double>(oSensor.outliers());
+        });
+        // Rolling statistics over the FILTER_WINDOW last accepted readings
+        std::vector<std::unique_ptr<metrics::Callback>> vWindowStats;
+        for (const auto& oStats : {std::make_pair("dht11_temperature_window_celsius", &oSensor.temperatureStats()),
+                                   std::make_pair("dht11_humidity_window_percent", &oSensor.humidityStats())}) {
+            const SensorTask::WindowStats* pStats = oStats.second;
+            vWindowStats.emplace_back(new metrics::Callback(metrics::Metric::TYPE_GAUGE, oStats.first,
+                "Rolling statistics of the accepted readings", [pStats] {
+                    return pStats->fMean.load(std::memory_order_relaxed);
+                }, "stat=\"mean\""));
+            vWindowStats.emplace_back(new metrics::Callback(metrics::Metric::TYPE_GAUGE, oStats.first,
+                "Rolling statistics of the accepted readings", [pStats] {
+                    return pStats->fMin.load(std::memory_order_relaxed);
+                }, "stat=\"min\""));
+            vWindowStats.emplace_back(new metrics::Callback(metrics::Metric::TYPE_GAUGE, oStats.first,
+                "Rolling statistics of the accepted readings", [pStats] {
+                    return pStats->fMax.load(std::memory_order_relaxed);
+                }, "stat=\"max\""));
+        }
 
-    DHT11Thread.join();
-    TM1637Thread.join();
+        oService.start();
+        oReactor.run();
+        LOGGER_LOG(LOG_INFO, "Event loop woke up ", oReactor.wakeups(), " times");
+    }
 
-    gpioTerminate();
+    oMetrics.stop();
+    pGpio->terminate();
 
     Logger::log(LOG_INFO, "Graceful terminating... ");
+    Logger::shutdown();
     return 0;
 }
@@ -0,0 +1,116 @@
+#include "sensor_task.h"
+
+#include <algorithm>
+#include <string>
+
+#include "logger.h"
+
+const std::chrono::seconds SENSOR_MIN_INTERVAL(1);
+
+SampleStore::Status toSampleStatus(addons::DHT11::Status eStatus) {
+    switch (eStatus) {
+        case addons::DHT11::STATUS_OK:
+            return SampleStore::STATUS_OK;
+        case addons::DHT11::STATUS_TIMEOUT:
+            return SampleStore::STATUS_TIMEOUT;
+        case addons::DHT11::STATUS_CHECKSUM:
+            return SampleStore::STATUS_CHECKSUM;
+        default:
+            return SampleStore::STATUS_ERROR;
+    }
+}
+
+SensorTask::SensorTask(const AppConfig& oAppConf, const PinConfig& oConf, SampleBus& oBus, const Clock& oClock)
+    : m_oClock(oClock),
+      m_oSensors(oConf.m_vDht11Pins),
+      m_oTempFilter(filterOptions(oConf, MAX_TEMP_DEVIATION)),
+      m_oHumFilter(filterOptions(oConf, MAX_HUM_DEVIATION)),
+      m_oBus(oBus) {
+    for (size_t i = 0; i < oConf.m_vDht11Pins.size(); ++i) {
+        m_vSamplers.emplace_back(SENSOR_MIN_INTERVAL, std::chrono::seconds(oAppConf.m_iMaxSampleInterval));
+    }
+
+    if (!oAppConf.m_sEdgeLogPath.empty() && m_oEdgeLog.open(oAppConf.m_sEdgeLogPath)) {
+        m_oSensors.setEdgeLog(&m_oEdgeLog);
+    }
+
+    if (!oAppConf.m_sShmName.empty()) {
+        m_oPublisher.open(oAppConf.m_sShmName, oConf.m_vDht11Pins.data(), oConf.m_vDht11Pins.size());
+    }
+
+    if (oAppConf.m_sHistoryPath.empty()) {
+        return;
+    }
+    // The first sensor keeps the plain path, the others get their pin appended
+    for (size_t i = 0; i < oConf.m_vDht11Pins.size(); ++i) {
+        m_vHistory.emplace_back(new SampleStore());
+        std::string sPath = oAppConf.m_sHistoryPath;
+        if (i > 0) {
+            sPath += "." + std::to_string(oConf.m_vDht11Pins[i]);
+        }
+        m_vHistory.back()->open(sPath);
+    }
+}
+
+bool SensorTask::sample() {
+    auto readStart = m_oClock.steady();
+    m_oSensors.read(m_vReadings);
+    auto readUs = std::chrono::duration_cast<std::chrono::microseconds>(m_oClock.steady() - readStart).count();
+    time_t now = std::chrono::system_clock::to_time_t(m_oClock.wall());
+
+    // The fastest changing sensor sets the pace for the whole pass
+    std::chrono::milliseconds oNext = std::chrono::milliseconds::max();
+    for (size_t i = 0; i < m_vReadings.size(); ++i) {
+        const addons::DHT11Array::Reading& oRead = m_vReadings[i];
+        if (i < m_vHistory.size() && m_vHistory[i]->isOpen()) {
+            m_vHistory[i]->append(now, oRead.fTemp, oRead.fHum, readUs, toSampleStatus(oRead.eStatus));
+        }
+        if (m_oPublisher.isOpen()) {
+            m_oPublisher.publish(i, static_cast<ReadingShm::Status>(toSampleStatus(oRead.eStatus)),
+                                 oRead.fTemp, oRead.fHum, now);
+        }
+        if (oRead.eStatus == addons::DHT11::STATUS_OK) {
+            LOGGER_LOG(LOG_DEBUG, "SensorTask| Getting data from the sensor [", oRead.iPin, "]:",
+                       Logger::fixed(oRead.fTemp, 1), "C*\t", Logger::fixed(oRead.fHum, 1));
+            oNext = std::min(oNext, m_vSamplers[i].onSample(readStart, oRead.fTemp, oRead.fHum));
+        } else {
+            LOGGER_LOG(LOG_ERR, "Failed to get info from the DHT11 sensor [", oRead.iPin, "]");
+            oNext = std::min(oNext, m_vSamplers[i].onFailure());
+        }
+    }
+    if (oNext != interval()) {
+        LOGGER_LOG(LOG_DEBUG, "SensorTask| Next read in ", oNext.count(), " ms");
+    }
+    m_llIntervalMs.store(oNext.count(), std::memory_order_relaxed);
+
+    if (m_vReadings.empty()) {
+        return false;
+    }
+    const addons::DHT11Array::Reading& oFirst = m_vReadings[0];
+    bool bValid = oFirst.eStatus == addons::DHT11::STATUS_OK;
+    bool bOutlier = false;
+    if (bValid) {
+        bool bTempOutlier, bHumOutlier;
+        m_oTempFilter.push(oFirst.fTemp, bTempOutlier);
+        m_oHumFilter.push(oFirst.fHum, bHumOutlier);
+        bOutlier = bTempOutlier || bHumOutlier;
+        if (bOutlier) {
+            LOGGER_LOG(LOG_WARNING, "SensorTask| Rejected outlier of the sensor [", oFirst.iPin, "]: ",
+                       Logger::fixed(oFirst.fTemp, 1), "C*\t", Logger::fixed(oFirst.fHum, 1));
+        }
+        m_oTempStats.update(m_oTempFilter.window());
+        m_oHumStats.update(m_oHumFilter.window());
+        m_ullOutliers.store(m_oTempFilter.outliers() + m_oHumFilter.outliers(), std::memory_order_relaxed);
+    }
+    m_oBus.publish(bValid, oFirst.fTemp, oFirst.fHum, m_oTempFilter.filtered(), m_oHumFilter.filtered(),
+                   bOutlier, now, readStart);
+    return bValid;
+}
+
+ReadingFilter::Options SensorTask::filterOptions(const PinConfig& oConf, float fMaxDeviation) {
+    ReadingFilter::Options oOptions;
+    oOptions.uiWindow = std::max(oConf.m_iFilterWindow, 1);
+    oOptions.uiMedian = std::max(oConf.m_iFilterMedian, 1);
+    oOptions.fMaxDeviation = fMaxDeviation;
+    return oOptions;
+}
@@ -0,0 +1,91 @@
+#include "service.h"
+
+#include <chrono>
+#include <csignal>
+#include <utility>
+
+#include "logger.h"
+
+Service::Service(const AppConfig& oConf, const PinConfig& oPinConf, Reactor& oReactor)
+    : m_oConf(oConf), m_oReactor(oReactor),
+      m_oSensor(oConf, oPinConf, m_oBus, oReactor.clock()),
+      m_oDisplay(oConf, oPinConf, m_oBus, oReactor.clock()) {
+}
+
+Service::~Service() {
+    for (int iTimer : m_vTimers) {
+        m_oReactor.removeTimer(iTimer);
+    }
+}
+
+void Service::start() {
+    // The sensor is only needed for the pages or the recordings
+    if (m_oConf.m_bTemperature || m_oConf.m_bHumidity || !m_oConf.m_sHistoryPath.empty() ||
+        !m_oConf.m_sEdgeLogPath.empty() || !m_oConf.m_sShmName.empty()) {
+        m_oSensor.sample();
+        m_iSensorTimer = addTimer(CLOCK_MONOTONIC, [this]() {
+            if (m_oSensor.sample() && m_oDisplay.page() != DisplayTask::PAGE_TIME) {
+                m_oDisplay.redraw();
+            }
+            m_oReactor.armAfter(m_iSensorTimer, m_oSensor.interval());
+        });
+        m_oReactor.armAfter(m_iSensorTimer, m_oSensor.interval());
+    }
+
+    if (m_oDisplay.pageCount() > 1) {
+        int iRotateTimer = addTimer(CLOCK_MONOTONIC, [this]() {
+            m_oDisplay.rotate();
+        });
+        m_oReactor.armAfter(iRotateTimer, std::chrono::seconds(m_oConf.m_iShowDelay),
+                            std::chrono::seconds(m_oConf.m_iShowDelay));
+    }
+
+    // The clock shows HH:MM, so it only changes on minute boundaries
+    if (m_oConf.m_bTime) {
+        int iClockTimer = addTimer(CLOCK_REALTIME, [this]() {
+            if (m_oDisplay.page() == DisplayTask::PAGE_TIME) {
+                m_oDisplay.redraw();
+            }
+        });
+        m_oReactor.armAligned(iClockTimer, std::chrono::minutes(1));
+    }
+
+    // Summaries of a storm that has stopped would wait for the next record.
+    // Only armed while one is pending, see addTimer.
+    m_iLogTimer = addTimer(CLOCK_MONOTONIC, [] {
+        Logger::expire();
+    });
+
+    if (!m_oDisplay.trackLight(m_oReactor)) {
+        LOGGER_LOG(LOG_WARNING, "Light sensor edges unavailable, the brightness stays as it is");
+    }
+
+    m_oDisplay.rotate();
+    armLogExpiry();
+}
+
+bool Service::stopOnSignals(Reactor& oReactor) {
+    return oReactor.addSignals({SIGTERM, SIGINT}, [&oReactor](int iSignal) {
+        LOGGER_LOG(LOG_INFO, "Received signal: ", iSignal);
+        oReactor.stop();
+    });
+}
+
+int Service::addTimer(clockid_t iClock, Reactor::TimerHandler fHandler) {
+    // Any handler may have logged something a summary is due for
+    int iTimer = m_oReactor.addTimer(iClock, [this, fHandler = std::move(fHandler)]() {
+        fHandler();
+        armLogExpiry();
+    });
+    if (iTimer >= 0) {
+        m_vTimers.push_back(iTimer);
+    }
+    return iTimer;
+}
+
+void Service::armLogExpiry() {
+    std::chrono::nanoseconds oIn;
+    if (m_iLogTimer >= 0 && Logger::nextExpiry(oIn)) {
+        m_oReactor.armAfter(m_iLogTimer, oIn);
+    }
+}
@@ -0,0 +1,185 @@
+#include <algorithm>
+#include <cstdint>
+#include <ctime>
+#include <getopt.h>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+
+#include "sample_store.h"
+
+const std::string DEFAULT_HISTORY_PATH = "/var/lib/temp-hum-clock/history";
+
+class HistoryConfig {
+public:
+    std::string m_sPath = DEFAULT_HISTORY_PATH;
+    time_t m_iBucket = 3600;
+    long m_lLast = 0; // 0 - all buckets
+};
+
+class BucketStats {
+public:
+    time_t m_iStart = 0;
+    uint64_t m_ullOk = 0;
+    uint64_t m_ullFailed = 0;
+    float m_fTempMin = std::numeric_limits<float>::max();
+    float m_fTempMax = std::numeric_limits<float>::lowest();
+    double m_dTempSum = 0;
+    float m_fHumMin = std::numeric_limits<float>::max();
+    float m_fHumMax = std::numeric_limits<float>::lowest();
+    double m_dHumSum = 0;
+    uint64_t m_ullLatencySum = 0;
+
+    void add(const SampleStore::Sample& oSample) {
+        if (oSample.uiStatus != SampleStore::STATUS_OK) {
+            ++m_ullFailed;
+            return;
+        }
+        float fTemp = SampleStore::temperature(oSample);
+        float fHum = SampleStore::humidity(oSample);
+        ++m_ullOk;
+        m_fTempMin = std::min(m_fTempMin, fTemp);
+        m_fTempMax = std::max(m_fTempMax, fTemp);
+        m_dTempSum += fTemp;
+        m_fHumMin = std::min(m_fHumMin, fHum);
+        m_fHumMax = std::max(m_fHumMax, fHum);
+        m_dHumSum += fHum;
+        m_ullLatencySum += oSample.uiLatency100Us;
+    }
+
+    void print() const {
+        std::tm oTm;
+        localtime_r(&m_iStart, &oTm);
+
+        std::cout << std::put_time(&oTm, "%Y-%m-%d %H:%M")
+                  << "  ok=" << std::setw(4) << m_ullOk
+                  << "  failed=" << std::setw(3) << m_ullFailed;
+        if (m_ullOk) {
+            std::cout << std::fixed << std::setprecision(1)
+                      << "  T " << m_fTempMin << "/" << m_dTempSum / m_ullOk << "/" << m_fTempMax
+                      << "  H " << m_fHumMin << "/" << m_dHumSum / m_ullOk << "/" << m_fHumMax
+                      << "  read " << std::setprecision(1) << m_ullLatencySum / 10.0 / m_ullOk << "ms";
+        }
+        std::cout << "\n";
+    }
+};
+
+void printHelp(const char* programName) {
+    std::cout << "Usage: " << programName << " [options]\n"
+              << "Options:\n"
+              << "  -f, --file <path>           History file (default: " << DEFAULT_HISTORY_PATH << ")\n"
+              << "  -g, --group <hour|day>      Bucket size (default: hour)\n"
+              << "  -n, --last <count>          Only show the last <count> buckets (default: all)\n"
+              << "  -h, --help                  Show this help message\n"
+              << "Columns: min/mean/max of successful reads per bucket.\n";
+}
+
+bool parseCommandLineArguments(int argc, char* argv[], HistoryConfig &config) {
+    static struct option long_options[] = {
+        {"file",  required_argument, 0, 'f'},
+        {"group", required_argument, 0, 'g'},
+        {"last",  required_argument, 0, 'n'},
+        {"help",  no_argument,       0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    int option_index = 0;
+    int c;
+    while ((c = getopt_long(argc, argv, "f:g:n:h", long_options, &option_index)) != -1) {
+        switch(c) {
+            case 'f': // --file
+                config.m_sPath = optarg;
+                break;
+
+            case 'g': // --group
+                if (std::string(optarg) == "hour") {
+                    config.m_iBucket = 3600;
+                } else if (std::string(optarg) == "day") {
+                    config.m_iBucket = 86400;
+                } else {
+                    std::cerr << "Parsing error: unknown group [" << optarg << "]" << std::endl;
+                    return false;
+                }
+                break;
+
+            case 'n': // --last
+                try {
+                    config.m_lLast = std::stol(optarg);
+                } catch (const std::exception & e) {
+                    std::cerr << "Parsing error: invalid bucket count [" << optarg << "]: ["
+                              << e.what() << "]" << std::endl;
+                    return false;
+                }
+                break;
+
+            case 'h': // --help
+                printHelp(argv[0]);
+                exit(0);
+
+            default:
+                printHelp(argv[0]);
+                return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    HistoryConfig config;
+    if (!parseCommandLineArguments(argc, argv, config)) {
+        return 1;
+    }
+
+    SampleStore oStore;
+    if (!oStore.open(config.m_sPath, 0, true)) {
+        std::cerr << "Failed to open history file: " << config.m_sPath << std::endl;
+        return 1;
+    }
+
+    // Buckets follow local midnight/hours, the offset is taken once for the scan
+    time_t iNow = time(nullptr);
+    std::tm oNowTm;
+    localtime_r(&iNow, &oNowTm);
+    long lOffset = oNowTm.tm_gmtoff;
+
+    auto bucketOf = [&](time_t iTime) {
+        time_t iLocal = iTime + lOffset;
+        return iLocal - iLocal % config.m_iBucket - lOffset;
+    };
+
+    time_t iFrom = 0;
+    if (config.m_lLast > 0) {
+        const SampleStore::Sample* pLast = nullptr;
+        for (uint64_t ullSeq = oStore.end(); ullSeq > oStore.begin() && !pLast; --ullSeq) {
+            pLast = oStore.at(ullSeq - 1);
+        }
+        if (pLast) {
+            iFrom = bucketOf(pLast->uiTime) - (config.m_lLast - 1) * config.m_iBucket;
+        }
+    }
+
+    BucketStats oBucket;
+    bool bHave = false;
+    oStore.forEach([&](const SampleStore::Sample& oSample) {
+        if (static_cast<time_t>(oSample.uiTime) < iFrom) {
+            return;
+        }
+        time_t iStart = bucketOf(oSample.uiTime);
+        if (!bHave || iStart != oBucket.m_iStart) {
+            if (bHave) {
+                oBucket.print();
+            }
+            oBucket = BucketStats();
+            oBucket.m_iStart = iStart;
+            bHave = true;
+        }
+        oBucket.add(oSample);
+    });
+    if (bHave) {
+        oBucket.print();
+    }
+
+    return 0;
+}
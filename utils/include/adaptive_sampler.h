@@ -0,0 +1,54 @@
+#ifndef ADAPTIVE_SAMPLER_H_
+#define ADAPTIVE_SAMPLER_H_
+
+#include <chrono>
+
+// Picks the delay until the next sensor read from how fast the readings move.
+//
+// Changes are measured in sensor steps (the resolution of a reading). A read
+// that moved by a step or more cuts the interval right away; otherwise it
+// grows slowly towards what the smoothed rate of change allows. Failed reads
+// back off exponentially from the minimum.
+class AdaptiveSampler {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    AdaptiveSampler(std::chrono::milliseconds oMinInterval = std::chrono::seconds(1),
+                    std::chrono::milliseconds oMaxInterval = std::chrono::seconds(60),
+                    float fTempStep = 1.0f, float fHumStep = 1.0f);
+
+    // Records a successful read, returns the delay until the next one.
+    std::chrono::milliseconds onSample(Clock::time_point oAt, float fTemp, float fHum);
+    // Records a failed read, returns the delay until the next one.
+    std::chrono::milliseconds onFailure();
+
+    std::chrono::milliseconds interval() const;
+    // Smoothed change in sensor steps per second.
+    double rate() const;
+    unsigned failures() const;
+
+private:
+    // Share of a step the readings may drift between two reads
+    static constexpr double TARGET_STEPS = 0.5;
+    static constexpr double RATE_SMOOTHING = 0.3;
+    // Largest increase of the interval per quiet read
+    static constexpr double GROWTH = 1.25;
+
+    double clamp(double dSeconds) const;
+
+    double m_dMin;
+    double m_dMax;
+    float m_fTempStep;
+    float m_fHumStep;
+
+    bool m_bHavePrev = false;
+    Clock::time_point m_oPrevAt;
+    float m_fPrevTemp = 0;
+    float m_fPrevHum = 0;
+
+    double m_dRate = 0;
+    double m_dInterval;
+    unsigned m_uiFailures = 0;
+};
+
+#endif  // ADAPTIVE_SAMPLER_H_
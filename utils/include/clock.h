@@ -0,0 +1,29 @@
+#ifndef CLOCK_H_
+#define CLOCK_H_
+
+#include <chrono>
+
+// Time as the service reads it. The system clock asks the kernel; a
+// simulation hands out a VirtualClock instead, so the readings, pages and
+// timers all follow its time.
+class Clock {
+public:
+    virtual ~Clock() {}
+
+    virtual std::chrono::steady_clock::time_point steady() const = 0;
+    virtual std::chrono::system_clock::time_point wall() const = 0;
+
+    static const Clock& system();
+};
+
+// Time that only moves when advanced. A Reactor running on it advances it
+// whenever it would otherwise block, see Reactor::run().
+class VirtualClock : public Clock {
+public:
+    // Moves the time forward, to oDeadline at most. May stop short when
+    // something outside the event loop changed, e.g. a line with an alert,
+    // so the loop looks at its descriptors again first.
+    virtual void advance(std::chrono::steady_clock::time_point oDeadline) = 0;
+};
+
+#endif  // CLOCK_H_
@@ -1,29 +1,272 @@
 #ifndef LOGGER_H_
 #define LOGGER_H_
 
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <mutex>
 #include <syslog.h>
+#include <thread>
+#include <type_traits>
+
+// Records with a priority above this are compiled out of LOGGER_LOG call sites.
+#ifndef LOGGER_COMPILE_LEVEL
+#define LOGGER_COMPILE_LEVEL LOG_DEBUG
+#endif
+
+// Logs the concatenation of the arguments. Nothing is evaluated or formatted
+// unless the record passes both the compile-time and the runtime level. The
+// call site takes part in the deduplication of repeated records.
+#define LOGGER_LOG(iPriority, ...)                                          \
+    do {                                                                    \
+        if constexpr ((iPriority) <= LOGGER_COMPILE_LEVEL) {                \
+            if (Logger::enabled(iPriority)) {                               \
+                constexpr uint64_t ullLoggerSite_ = Logger::site(__FILE__, __LINE__); \
+                Logger::Line oLoggerLine_;                                  \
+                oLoggerLine_.append(__VA_ARGS__);                           \
+                Logger::log(iPriority, oLoggerLine_.data(), oLoggerLine_.size(), ullLoggerSite_); \
+            }                                                               \
+        }                                                                   \
+    } while (0)
 
 class Logger {
 public:
+    // Fixed precision floating point argument for LOGGER_LOG.
+    struct Fixed {
+        double dValue;
+        int iPrecision;
+    };
+
+    // Stack buffer the LOGGER_LOG arguments are rendered into, truncates.
+    class Line {
+    public:
+        static constexpr size_t CAPACITY = 256;
+
+        template <typename... Args>
+        void append(const Args&... args) {
+            (put(args), ...);
+        }
+
+        const char* data() const { return m_aBuf; }
+        size_t size() const { return m_uiLen; }
+
+    private:
+        void put(const char* pText) {
+            put(pText, std::strlen(pText));
+        }
+        void put(const std::string& sText) {
+            put(sText.data(), sText.size());
+        }
+        void put(std::string_view sText) {
+            put(sText.data(), sText.size());
+        }
+        void put(char cChar) {
+            put(&cChar, 1);
+        }
+        void put(bool bValue) {
+            put(bValue ? "true" : "false");
+        }
+        void put(const Fixed& oFixed) {
+            char aBuf[32];
+            int iLen = std::snprintf(aBuf, sizeof(aBuf), "%.*f", oFixed.iPrecision, oFixed.dValue);
+            put(aBuf, iLen > 0 ? static_cast<size_t>(iLen) : 0);
+        }
+        template <typename T>
+        typename std::enable_if<std::is_arithmetic<T>::value>::type put(T value) {
+            char aBuf[32];
+            if constexpr (std::is_floating_point<T>::value) {
+                int iLen = std::snprintf(aBuf, sizeof(aBuf), "%g", static_cast<double>(value));
+                put(aBuf, iLen > 0 ? static_cast<size_t>(iLen) : 0);
+            } else {
+                auto oRes = std::to_chars(aBuf, aBuf + sizeof(aBuf), value);
+                put(aBuf, oRes.ptr - aBuf);
+            }
+        }
+        void put(const char* pText, size_t uiLen) {
+            size_t uiCopy = std::min(uiLen, CAPACITY - m_uiLen);
+            std::memcpy(m_aBuf + m_uiLen, pText, uiCopy);
+            m_uiLen += uiCopy;
+        }
+
+        char m_aBuf[CAPACITY];
+        size_t m_uiLen = 0;
+    };
+
+    enum Mode {
+        MODE_SYNC,   // write to syslog/stdout on the calling thread
+        MODE_ASYNC,  // queue records for a background drain thread
+    };
+
+    // What an async log() does when the queue is full.
+    enum OverflowPolicy {
+        DROP_NEWEST,
+        DROP_OLDEST,
+        BLOCK,
+    };
+
     static Logger& instance();
 
-    static void setup(bool bLogToStdout, int iMinLogLevel, const std::string& sIdent);
+    static void setup(bool bLogToStdout, int iMinLogLevel, const std::string& sIdent,
+                      Mode eMode = MODE_SYNC, OverflowPolicy ePolicy = DROP_NEWEST);
+
+    // Flushes queued records and pending summaries and stops the drain
+    // thread; later records are written synchronously.
+    static void shutdown();
+
+    // Identical records from the same call site within the window are only
+    // written once, followed by a "repeated N times" summary. 0 disables it.
+    static void setDedupWindow(std::chrono::milliseconds oWindow);
+    // Token bucket per priority: dBurst records at once, refilled at
+    // dPerSecond. A dPerSecond of 0 lifts the limit. Rejected records are
+    // reported in a summary once the bucket has tokens again.
+    //
+    // Neither filter takes a lock for a repeat or a rejected record: it costs
+    // a hash of the text and a CAS. Only the first record of a dedup window and
+    // the expiry, once a second, try a mutex; under contention the record is
+    // written untracked, so a repeat racing it may be written too.
+    static void setRateLimit(int iPriority, double dPerSecond, double dBurst);
+    // Writes the summaries of repeats whose window is over and of rate
+    // limited records. log() does it in passing, call it when idle.
+    static void expire();
+    // Time left until the earliest summary expire() would write is due, the
+    // end of a dedup window or a rate limited bucket having tokens again.
+    // False while no summary is pending.
+    static bool nextExpiry(std::chrono::nanoseconds& oIn);
+
+    // Identifies a LOGGER_LOG call site, folded at compile time.
+    static constexpr uint64_t site(const char* pFile, int iLine) {
+        uint64_t ullHash = FNV_OFFSET;
+        for (; *pFile; ++pFile) {
+            ullHash = (ullHash ^ static_cast<unsigned char>(*pFile)) * FNV_PRIME;
+        }
+        return (ullHash ^ static_cast<uint64_t>(iLine)) * FNV_PRIME;
+    }
 
     static void log(int iPriority, const std::string& sMessage);
+    static void log(int iPriority, const char* pText, size_t uiLength, uint64_t ullSite = 0);
+
+    // True if a record of this priority would be written right now.
+    static bool enabled(int iPriority);
+
+    static Fixed fixed(double dValue, int iPrecision) {
+        return Fixed{dValue, iPrecision};
+    }
+
+    // Records lost to a full queue in async mode.
+    static uint64_t dropped();
+    // Records handed to syslog/stdout.
+    static uint64_t emitted();
+    // Records rejected by the runtime level.
+    static uint64_t suppressed();
+    // Records folded into a "repeated N times" summary.
+    static uint64_t deduplicated();
+    // Records rejected by the token buckets, of one priority or of all.
+    static uint64_t rateLimited(int iPriority = -1);
 
 private:
+    static constexpr uint64_t FNV_OFFSET = 14695981039346656037ull;
+    static constexpr uint64_t FNV_PRIME = 1099511628211ull;
+    // Messages longer than this are truncated in async mode.
+    static constexpr size_t RECORD_TEXT_SIZE = 240;
+    static constexpr size_t RING_SIZE = 1024;  // power of two
+    static constexpr size_t DRAIN_BATCH = 64;
+
+    struct Record {
+        std::atomic<size_t> uiSeq;
+        int iPriority;
+        uint16_t uiLength;
+        char aText[RECORD_TEXT_SIZE];
+    };
+
+    static constexpr size_t REPEAT_SLOTS = 64;  // power of two
+    static constexpr size_t REPEAT_TEXT_SIZE = 96;
+    static constexpr int PRIORITIES = LOG_DEBUG + 1;
+    static constexpr uint64_t EXPIRE_PERIOD_NS = 1000000000;
+
+    // Record written at ullSinceNs and its repeats since. Slots form sets of
+    // two; a third record of a set evicts the older one, ending its window early.
+    // Repeats are counted lock-free in ullState: a CAS that only succeeds while
+    // the generation read before the key is unchanged, like a seqlock. The
+    // rest changes under m_filterMutex, with an odd generation meanwhile.
+    struct Repeat {
+        std::atomic<uint64_t> ullState {0};  // generation << 32 | repeats
+        std::atomic<uint64_t> ullKey {0};    // 0 while free
+        std::atomic<uint64_t> ullSinceNs {0};
+        int iPriority = 0;
+        uint16_t uiLength = 0;
+        char aText[REPEAT_TEXT_SIZE];
+    };
+
+    // Token bucket kept as the time it next fills (GCRA), so a record takes
+    // a token with one CAS.
+    struct TokenBucket {
+        std::atomic<uint64_t> ullIntervalNs {0};   // per token, 0 while unlimited
+        std::atomic<uint64_t> ullToleranceNs {0};  // the burst less one token
+        std::atomic<uint64_t> ullFullNs {0};       // when the bucket is full again
+        std::atomic<uint64_t> ullPending {0};      // rejected since the last summary
+        std::atomic<uint64_t> ullLimited {0};
+    };
+
     Logger();
     ~Logger();
 
     Logger(const Logger&) = delete;
     Logger& operator=(const Logger&) = delete;
 
+    void emit(int iPriority, const char* pText, size_t uiLength);
+    void write(int iPriority, const char* pText, size_t uiLength);
+    bool admit(int iPriority, const char* pText, size_t uiLength, uint64_t ullSite);
+    bool countRepeat(Repeat* pSet, uint64_t ullKey, uint64_t ullNowNs, uint64_t ullWindowNs);
+    void track(Repeat* pSet, uint64_t ullKey, uint64_t ullNowNs, uint64_t ullWindowNs,
+               int iPriority, const char* pText, size_t uiLength);
+    bool takeToken(int iPriority, uint64_t ullNowNs);
+    uint64_t closeRepeat(Repeat& oRepeat);
+    void openRepeat(Repeat& oRepeat, uint64_t ullState);
+    void flushRepeat(Repeat& oRepeat);
+    void flushLimited(int iPriority);
+    void expire(uint64_t ullNowNs, bool bAll);
+    bool tryPush(int iPriority, const char* pText, size_t uiLength);
+    bool tryPop(Record& oOut);
+    void push(int iPriority, const char* pText, size_t uiLength);
+    void drain();
+    void stopDrain();
+
     bool m_bLogToStdout;
-    int m_iMinLogLevel;
-    bool m_bIsSetup;
+    std::atomic<int> m_iMinLogLevel;
+    std::atomic<bool> m_bIsSetup;
     std::mutex m_mutex;
+
+    std::atomic<Mode> m_eMode;
+    OverflowPolicy m_ePolicy = DROP_NEWEST;
+    std::unique_ptr<Record[]> m_pRing;
+    alignas(64) std::atomic<size_t> m_uiEnqueuePos {0};
+    alignas(64) std::atomic<size_t> m_uiDequeuePos {0};
+    alignas(64) std::atomic<uint64_t> m_ullDropped {0};
+    std::atomic<uint64_t> m_ullEmitted {0};
+    alignas(64) std::atomic<uint64_t> m_ullSuppressed {0};
+
+    // Deduplication and rate limits, both off until configured
+    std::mutex m_filterMutex;  // taken before m_mutex
+    std::atomic<uint64_t> m_ullDedupWindowNs {0};
+    std::atomic<bool> m_bRateLimits {false};
+    std::atomic<uint64_t> m_ullExpiredNs {0};
+    Repeat m_aRepeats[REPEAT_SLOTS];
+    TokenBucket m_aBuckets[PRIORITIES];
+    std::atomic<uint64_t> m_ullDeduplicated {0};
+    std::atomic<bool> m_bDrainerIdle {false};
+    std::atomic<bool> m_bStopDrain {false};
+    std::mutex m_drainMutex;
+    std::condition_variable m_cvDrain;
+    std::thread m_drainThread;
 };
 
 #endif  // LOGGER_H_
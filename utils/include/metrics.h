@@ -0,0 +1,128 @@
+#ifndef METRICS_H_
+#define METRICS_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace metrics {
+
+// Base of every exported series. Metrics register themselves on construction
+// and are expected to live for the whole process (namespace scope statics).
+class Metric {
+public:
+    enum Type {
+        TYPE_COUNTER,
+        TYPE_GAUGE,
+        TYPE_HISTOGRAM,
+    };
+
+    // pLabels is the pre-rendered label set without braces: outcome="ok"
+    Metric(Type eType, const char* pName, const char* pHelp, const char* pLabels);
+    virtual ~Metric();
+
+    Metric(const Metric&) = delete;
+    Metric& operator=(const Metric&) = delete;
+
+    Type type() const { return m_eType; }
+    const char* name() const { return m_pName; }
+    const char* help() const { return m_pHelp; }
+    const char* labels() const { return m_pLabels; }
+
+    virtual void render(std::string& sOut) const = 0;
+
+private:
+    Type m_eType;
+    const char* m_pName;
+    const char* m_pHelp;
+    const char* m_pLabels;
+};
+
+// Monotonic count, one relaxed atomic add per update.
+class Counter : public Metric {
+public:
+    Counter(const char* pName, const char* pHelp, const char* pLabels = "");
+
+    void inc(uint64_t ullBy = 1) {
+        m_ullValue.fetch_add(ullBy, std::memory_order_relaxed);
+    }
+    uint64_t value() const {
+        return m_ullValue.load(std::memory_order_relaxed);
+    }
+
+    void render(std::string& sOut) const override;
+
+private:
+    std::atomic<uint64_t> m_ullValue {0};
+};
+
+// Value sampled from elsewhere when a snapshot is rendered.
+class Callback : public Metric {
+public:
+    Callback(Type eType, const char* pName, const char* pHelp, std::function<double()> fValue,
+             const char* pLabels = "");
+
+    void render(std::string& sOut) const override;
+
+private:
+    std::function<double()> m_fValue;
+};
+
+// Fixed upper bounds in seconds; observations are stored in nanoseconds.
+class Histogram : public Metric {
+public:
+    static constexpr size_t MAX_BUCKETS = 16;
+
+    Histogram(const char* pName, const char* pHelp, std::initializer_list<double> lBounds,
+              const char* pLabels = "");
+
+    void observe(uint64_t ullNanos) {
+        size_t i = 0;
+        while (i < m_uiBounds && ullNanos > m_aBoundsNs[i]) {
+            ++i;
+        }
+        m_aCounts[i].fetch_add(1, std::memory_order_relaxed);
+        m_ullSumNs.fetch_add(ullNanos, std::memory_order_relaxed);
+    }
+
+    void render(std::string& sOut) const override;
+
+private:
+    size_t m_uiBounds = 0;
+    uint64_t m_aBoundsNs[MAX_BUCKETS];
+    double m_aBounds[MAX_BUCKETS];
+    std::atomic<uint64_t> m_aCounts[MAX_BUCKETS + 1];
+    std::atomic<uint64_t> m_ullSumNs {0};
+};
+
+// Prometheus text exposition of every registered metric.
+std::string snapshot();
+
+// Serves snapshot() to every client connecting to a Unix domain socket.
+class Server {
+public:
+    Server();
+    ~Server();
+
+    bool start(const std::string& sPath);
+    void stop();
+
+private:
+    void run();
+
+    std::string m_sPath;
+    int m_iFd = -1;
+    int m_iWakeFd = -1;  // eventfd, written by stop()
+    std::atomic<bool> m_bStop {false};
+    std::thread m_thread;
+};
+
+}
+
+#endif  // METRICS_H_
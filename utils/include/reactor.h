@@ -0,0 +1,95 @@
+#ifndef REACTOR_H_
+#define REACTOR_H_
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <initializer_list>
+#include <map>
+#include <memory>
+
+#include "clock.h"
+
+// Single-threaded event loop over epoll. Timers are timerfds, signals arrive
+// through a signalfd, so every handler runs on the thread calling run() and
+// needs no locking.
+//
+// On a VirtualClock the timers keep their deadlines on that clock instead,
+// and run() advances it to the next one rather than wait; descriptors and
+// signals are watched as usual.
+class Reactor {
+public:
+    typedef std::function<void()> TimerHandler;
+    typedef std::function<void(int iSignal)> SignalHandler;
+    typedef std::function<void(uint32_t uiEvents)> FdHandler;
+
+    explicit Reactor(VirtualClock* pClock = nullptr);
+    ~Reactor();
+
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+
+    bool isOpen() const;
+
+    // What the timers run on, the system clock unless a virtual one was given.
+    const Clock& clock() const;
+
+    // Blocks the signals for the calling thread and delivers them to fHandler
+    // instead. Must be called before any other thread is started, threads
+    // inherit the mask.
+    bool addSignals(std::initializer_list<int> lSignals, SignalHandler fHandler);
+
+    // Returns a timer id, -1 on failure. The timer is created disarmed.
+    int addTimer(clockid_t iClock, TimerHandler fHandler);
+    // Relative to now; a zero interval fires once.
+    bool armAfter(int iTimer, std::chrono::nanoseconds oDelay,
+                  std::chrono::nanoseconds oInterval = std::chrono::nanoseconds::zero());
+    // Fires on every wall-clock multiple of oPeriod (e.g. each minute) and
+    // re-aligns itself when the system time is set. Needs a CLOCK_REALTIME timer.
+    bool armAligned(int iTimer, std::chrono::seconds oPeriod);
+    bool disarm(int iTimer);
+    void removeTimer(int iTimer);
+
+    // Watches a caller-owned descriptor.
+    bool addFd(int iFd, uint32_t uiEvents, FdHandler fHandler);
+    void removeFd(int iFd);
+
+    // Dispatches events until stop() is called from a handler.
+    void run();
+    void stop();
+
+    // Returns from epoll_wait, for comparing wakeup rates.
+    uint64_t wakeups() const;
+
+private:
+    enum Kind {
+        KIND_TIMER,
+        KIND_SIGNAL,
+        KIND_FD,
+    };
+
+    struct Source {
+        Kind eKind;
+        TimerHandler fTimer;
+        SignalHandler fSignal;
+        FdHandler fFd;
+        std::chrono::seconds oAlign {0};  // 0 - not wall-clock aligned
+        // Only on a virtual clock, the timerfd stays disarmed
+        bool bArmed = false;
+        std::chrono::steady_clock::time_point oDeadline;
+        std::chrono::nanoseconds oInterval {0};
+    };
+
+    bool watch(int iFd, uint32_t uiEvents, std::shared_ptr<Source> pSource);
+    void dispatch(int iFd, uint32_t uiEvents);
+    void advance();
+
+    VirtualClock* m_pClock;
+    int m_iEpollFd = -1;
+    bool m_bStop = false;
+    uint64_t m_ullWakeups = 0;
+    std::map<int, std::shared_ptr<Source>> m_mSources;
+};
+
+#endif  // REACTOR_H_
@@ -0,0 +1,130 @@
+#ifndef READING_FILTER_H_
+#define READING_FILTER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Mean, minimum and maximum of the last N values, O(1) per value with memory
+// allocated once: a running sum, and minimum and maximum candidates kept in
+// monotonic deques laid out as rings of sample numbers.
+class RollingWindow {
+public:
+    explicit RollingWindow(size_t uiSize);
+
+    void push(float fValue);
+    void clear();
+
+    size_t size() const;
+    size_t count() const;
+    // Meaningless while count() is 0
+    float mean() const;
+    float min() const;
+    float max() const;
+
+private:
+    // Sample numbers whose values are monotonic from front to back
+    class MonotonicDeque {
+    public:
+        explicit MonotonicDeque(size_t uiSize);
+
+        void clear();
+        // Drops the candidates that can no longer be the extreme, then
+        // appends ullSeq. fOutranks(a, b) holds if a beats b.
+        template <typename F>
+        void push(uint64_t ullSeq, F fOutranks);
+        void expire(uint64_t ullOldest);
+        uint64_t front() const;
+
+    private:
+        std::vector<uint64_t> m_vSeqs;
+        size_t m_uiHead = 0;
+        size_t m_uiCount = 0;
+    };
+
+    float at(uint64_t ullSeq) const;
+
+    std::vector<float> m_vValues;  // ring of the last values
+    uint64_t m_ullPushed = 0;
+    double m_dSum = 0;
+    MonotonicDeque m_oMin;
+    MonotonicDeque m_oMax;
+};
+
+// Median of the last N values. A value further than fMaxDeviation from the
+// median, itself included, is an outlier and replaced by the median. A real
+// step passes once it holds for more than half the window.
+class MedianFilter {
+public:
+    MedianFilter(size_t uiSize, float fMaxDeviation);
+
+    float filter(float fValue, bool& bOutlier);
+    void clear();
+
+private:
+    std::vector<float> m_vValues;   // ring of the last values
+    std::vector<float> m_vScratch;  // sorted in place, N stays small
+    size_t m_uiNext = 0;
+    size_t m_uiCount = 0;
+    float m_fMaxDeviation;
+};
+
+// Exponential moving average, the first value is taken as is.
+class Ema {
+public:
+    explicit Ema(float fAlpha);
+
+    float push(float fValue);
+    float value() const;
+    void clear();
+
+private:
+    float m_fAlpha;
+    float m_fValue = 0;
+    bool m_bPrimed = false;
+};
+
+// Whole number shown for a value: it only moves once the value is more than
+// half a step plus fBand away, so noise around x.5 doesn't make it flicker.
+class Hysteresis {
+public:
+    explicit Hysteresis(float fBand);
+
+    long push(float fValue);
+    long value() const;
+
+private:
+    float m_fBand;
+    long m_lValue = 0;
+    bool m_bPrimed = false;
+};
+
+// Outlier rejection, then smoothing and rolling statistics of one quantity.
+class ReadingFilter {
+public:
+    struct Options {
+        size_t uiWindow = 30;        // samples of the rolling statistics
+        size_t uiMedian = 5;         // samples of the outlier median
+        float fMaxDeviation = 5.0f;  // from the median before a value is rejected
+        float fAlpha = 0.3f;         // of the moving average
+    };
+
+    explicit ReadingFilter(const Options& oOptions);
+
+    // Returns the smoothed value, bOutlier is set if fRaw was rejected.
+    float push(float fRaw, bool& bOutlier);
+    void clear();
+
+    float filtered() const;
+    // Of the accepted values
+    const RollingWindow& window() const;
+    uint64_t outliers() const;
+
+private:
+    MedianFilter m_oMedian;
+    Ema m_oEma;
+    RollingWindow m_oWindow;
+    uint64_t m_ullOutliers = 0;
+};
+
+#endif  // READING_FILTER_H_
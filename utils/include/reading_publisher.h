@@ -0,0 +1,34 @@
+#ifndef READING_PUBLISHER_H_
+#define READING_PUBLISHER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "reading_shm.h"
+
+// Writing side of the ReadingShm segment. Single writer: the segment is kept
+// on close, so readers mapped across a restart see the new process' values.
+class ReadingPublisher {
+public:
+    ReadingPublisher();
+    ~ReadingPublisher();
+
+    ReadingPublisher(const ReadingPublisher&) = delete;
+    ReadingPublisher& operator=(const ReadingPublisher&) = delete;
+
+    // Creates or takes over the segment, one slot per pin (at most MAX_SENSORS).
+    bool open(const std::string& sName, const int* pPins, size_t uiCount);
+    void close();
+    bool isOpen() const;
+
+    // Counts a read attempt of sensor uiIndex; the values replace the
+    // published ones only with STATUS_OK.
+    void publish(size_t uiIndex, ReadingShm::Status eStatus, float fTemp, float fHum, uint32_t uiTime);
+
+private:
+    ReadingShm::Segment* m_pSegment = nullptr;
+    size_t m_uiSensors = 0;
+};
+
+#endif  // READING_PUBLISHER_H_
@@ -0,0 +1,180 @@
+#ifndef READING_SHM_H_
+#define READING_SHM_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Latest sensor readings published by temp-hum-clock in a POSIX shared memory
+// segment, one seqlock protected slot per sensor. Header-only on the reading
+// side: link nothing but -lrt on older glibc, and a read costs no syscall.
+//
+//     ReadingShmReader oReader;
+//     ReadingShm::Snapshot oSnap;
+//     if (oReader.open() && oReader.read(0, oSnap) && oSnap.uiTime) { ... }
+namespace ReadingShm {
+
+const char DEFAULT_NAME[] = "/temp-hum-clock";
+const char MAGIC[8] = {'T', 'H', 'C', 'S', 'H', 'M', '0', '1'};
+constexpr uint32_t VERSION = 2;
+constexpr size_t MAX_SENSORS = 8;
+
+// Same values as SampleStore::Status
+enum Status : uint32_t {
+    STATUS_OK       = 0,
+    STATUS_TIMEOUT  = 1,
+    STATUS_CHECKSUM = 2,
+    STATUS_ERROR    = 3,
+    STATUS_NONE     = 4,  // not read yet
+};
+
+// A consistent copy of one slot
+struct Snapshot {
+    int iPin;
+    float fTemp;          // of the last successful read
+    float fHum;
+    uint32_t uiTime;      // unix seconds of the last successful read, 0 - none yet
+    Status eStatus;       // of the last read attempt
+    uint32_t uiSamples;   // read attempts so far
+    uint32_t uiVersion;   // changes with every publication
+};
+
+// Every field is an atomic so the racing copies of a seqlock stay defined;
+// 32-bit fields keep them lock-free on every Pi. A cache line per slot, so
+// readers of one sensor don't slow the writes of another.
+struct alignas(64) Slot {
+    std::atomic<uint32_t> uiSeq;  // odd while being written
+    std::atomic<int32_t> iPin;
+    std::atomic<uint32_t> uiTempBits;
+    std::atomic<uint32_t> uiHumBits;
+    std::atomic<uint32_t> uiTime;
+    std::atomic<uint32_t> uiStatus;
+    std::atomic<uint32_t> uiSamples;
+};
+
+struct Segment {
+    char aMagic[8];
+    uint32_t uiVersion;
+    std::atomic<uint32_t> uiSensors;
+    Slot aSlots[MAX_SENSORS];
+};
+
+static_assert(sizeof(Slot) == 64, "A slot must fill exactly one cache line");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "Slots must be lock-free to be shared");
+
+inline uint32_t toBits(float fValue) {
+    uint32_t uiBits;
+    std::memcpy(&uiBits, &fValue, sizeof(uiBits));
+    return uiBits;
+}
+
+inline float fromBits(uint32_t uiBits) {
+    float fValue;
+    std::memcpy(&fValue, &uiBits, sizeof(fValue));
+    return fValue;
+}
+
+}
+
+class ReadingShmReader {
+public:
+    // Reads that keep meeting a write in progress give up after this many
+    // tries, e.g. when the writer died in the middle of one.
+    static constexpr int MAX_RETRIES = 1000;
+
+    ReadingShmReader() {}
+
+    ~ReadingShmReader() {
+        close();
+    }
+
+    ReadingShmReader(const ReadingShmReader&) = delete;
+    ReadingShmReader& operator=(const ReadingShmReader&) = delete;
+
+    bool open(const std::string& sName = ReadingShm::DEFAULT_NAME) {
+        close();
+
+        int iFd = shm_open(sName.c_str(), O_RDONLY, 0);
+        if (iFd < 0) {
+            return false;
+        }
+        struct stat oStat;
+        if (fstat(iFd, &oStat) < 0 || static_cast<size_t>(oStat.st_size) < sizeof(ReadingShm::Segment)) {
+            ::close(iFd);
+            return false;
+        }
+        void* pMap = mmap(nullptr, sizeof(ReadingShm::Segment), PROT_READ, MAP_SHARED, iFd, 0);
+        ::close(iFd);
+        if (pMap == MAP_FAILED) {
+            return false;
+        }
+
+        m_pSegment = static_cast<const ReadingShm::Segment*>(pMap);
+        if (std::memcmp(m_pSegment->aMagic, ReadingShm::MAGIC, sizeof(ReadingShm::MAGIC)) != 0 ||
+            m_pSegment->uiVersion != ReadingShm::VERSION) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+        if (m_pSegment) {
+            munmap(const_cast<ReadingShm::Segment*>(m_pSegment), sizeof(ReadingShm::Segment));
+            m_pSegment = nullptr;
+        }
+    }
+
+    bool isOpen() const {
+        return m_pSegment != nullptr;
+    }
+
+    size_t sensors() const {
+        if (!m_pSegment) {
+            return 0;
+        }
+        return std::min<size_t>(m_pSegment->uiSensors.load(std::memory_order_acquire), ReadingShm::MAX_SENSORS);
+    }
+
+    // Copies slot uiIndex, false if there is none or no consistent copy was had.
+    bool read(size_t uiIndex, ReadingShm::Snapshot& oSnap) const {
+        if (uiIndex >= sensors()) {
+            return false;
+        }
+
+        const ReadingShm::Slot& oSlot = m_pSegment->aSlots[uiIndex];
+        for (int i = 0; i < MAX_RETRIES; ++i) {
+            uint32_t uiBefore = oSlot.uiSeq.load(std::memory_order_acquire);
+            if (uiBefore & 1) {
+                continue;
+            }
+
+            oSnap.iPin = oSlot.iPin.load(std::memory_order_relaxed);
+            oSnap.fTemp = ReadingShm::fromBits(oSlot.uiTempBits.load(std::memory_order_relaxed));
+            oSnap.fHum = ReadingShm::fromBits(oSlot.uiHumBits.load(std::memory_order_relaxed));
+            oSnap.uiTime = oSlot.uiTime.load(std::memory_order_relaxed);
+            oSnap.eStatus = static_cast<ReadingShm::Status>(oSlot.uiStatus.load(std::memory_order_relaxed));
+            oSnap.uiSamples = oSlot.uiSamples.load(std::memory_order_relaxed);
+
+            // Orders the copies before the second look at the sequence
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (oSlot.uiSeq.load(std::memory_order_relaxed) == uiBefore) {
+                oSnap.uiVersion = uiBefore >> 1;
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    const ReadingShm::Segment* m_pSegment = nullptr;
+};
+
+#endif  // READING_SHM_H_
@@ -0,0 +1,28 @@
+#ifndef REALTIME_H_
+#define REALTIME_H_
+
+#include <cstddef>
+
+// Scheduling setup for the thread doing the bit-banging.
+class Realtime {
+public:
+    class Options {
+    public:
+        int m_iPriority = 0;   // SCHED_FIFO priority 1-99, 0 - keep the default scheduler
+        int m_iCpu = -1;       // core to pin the thread to, -1 - any
+        size_t m_uiStackPrefault = 256 * 1024;
+    };
+
+    // Applies the options to the calling thread: pins it to the core, and with
+    // a priority locks all current and future pages, touches uiStackPrefault
+    // bytes of stack so it never page faults and switches it to SCHED_FIFO.
+    // Threads started later inherit the policy, so call it after helper
+    // threads are running.
+    // Returns false if any step failed, the remaining ones are still tried.
+    static bool apply(const Options& oOptions);
+
+private:
+    static void prefaultStack(size_t uiBytes);
+};
+
+#endif  // REALTIME_H_
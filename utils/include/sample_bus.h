@@ -0,0 +1,112 @@
+#ifndef SAMPLE_BUS_H_
+#define SAMPLE_BUS_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Readings of one sensor, published by a single writer to any number of
+// readers on other threads. Every read attempt becomes an immutable record in
+// a ring of slots, each guarded by its own sequence stamp: readers copy a
+// record and check the stamp once, so they never wait on the writer nor retry
+// more than a few times. Consumers that fell behind catch up from the ring.
+// Only 32-bit atomics are used, which stay lock-free on every Pi.
+class SampleBus {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    static constexpr uint32_t CAPACITY = 64;
+
+    struct Record {
+        uint32_t uiSeq;        // 0 for the first record published
+        bool bValid;           // values are only meaningful for a successful read
+        float fTemp;           // as read
+        float fHum;
+        float fTempFiltered;   // outliers rejected and smoothed
+        float fHumFiltered;
+        bool bOutlier;         // the read was rejected by the filter
+        uint32_t uiTime;       // unix seconds of the capture
+        uint32_t uiCaptureMs;  // steady clock milliseconds of the capture, wraps
+
+        // Milliseconds since the capture
+        uint32_t ageMs(Clock::time_point oNow = Clock::now()) const {
+            return toMs(oNow) - uiCaptureMs;
+        }
+    };
+
+    SampleBus();
+
+    SampleBus(const SampleBus&) = delete;
+    SampleBus& operator=(const SampleBus&) = delete;
+
+    // Writer only. Returns the sequence number of the record.
+    uint32_t publish(bool bValid, float fTemp, float fHum, float fTempFiltered, float fHumFiltered,
+                     bool bOutlier, uint32_t uiTime, Clock::time_point oCaptured = Clock::now());
+    // Unfiltered: the filtered values are the raw ones.
+    uint32_t publish(bool bValid, float fTemp, float fHum, uint32_t uiTime,
+                     Clock::time_point oCaptured = Clock::now());
+
+    // Sequence of the next record; [end() - CAPACITY, end()) may be retained.
+    uint32_t end() const {
+        return m_uiEnd.load(std::memory_order_acquire);
+    }
+
+    // Copies the record stored under uiSeq, false if not published yet or
+    // overwritten (also while it is being overwritten).
+    bool at(uint32_t uiSeq, Record& oRecord) const;
+    bool latest(Record& oRecord) const;
+    // Newest record with bValid set still in the ring.
+    bool latestValid(Record& oRecord) const;
+
+    // Calls fVisit(const Record&) for every record from uiCursor on and moves
+    // the cursor past them. Returns how many were lost to the ring wrapping.
+    template <typename F>
+    uint32_t readSince(uint32_t& uiCursor, F fVisit) const {
+        uint32_t uiEnd = end();
+        uint32_t uiMissed = 0;
+        if (uiEnd - uiCursor > CAPACITY) {
+            uiMissed = uiEnd - uiCursor - CAPACITY;
+            uiCursor = uiEnd - CAPACITY;
+        }
+        Record oRecord;
+        for (; uiCursor != uiEnd; ++uiCursor) {
+            if (at(uiCursor, oRecord)) {
+                fVisit(oRecord);
+            } else {
+                ++uiMissed;
+            }
+        }
+        return uiMissed;
+    }
+
+    static uint32_t toMs(Clock::time_point oAt) {
+        return static_cast<uint32_t>(
+            std::chrono::duration_cast<std::chrono::milliseconds>(oAt.time_since_epoch()).count());
+    }
+
+private:
+    // Rounds before latest() gives up on a writer that keeps lapping it
+    static constexpr int MAX_TRIES = 4;
+
+    static constexpr uint32_t FLAG_VALID = 1;
+    static constexpr uint32_t FLAG_OUTLIER = 2;
+
+    struct Slot {
+        // 2 * seq + 2 once the record of seq is complete, odd while written
+        std::atomic<uint32_t> uiStamp {0};
+        std::atomic<uint32_t> uiFlags {0};  // FLAG_*
+        std::atomic<uint32_t> uiTempBits {0};
+        std::atomic<uint32_t> uiHumBits {0};
+        std::atomic<uint32_t> uiTempFilteredBits {0};
+        std::atomic<uint32_t> uiHumFilteredBits {0};
+        std::atomic<uint32_t> uiTime {0};
+        std::atomic<uint32_t> uiCaptureMs {0};
+    };
+
+    std::array<Slot, CAPACITY> m_aSlots;
+    std::atomic<uint32_t> m_uiEnd {0};
+};
+
+#endif  // SAMPLE_BUS_H_
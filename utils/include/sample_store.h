@@ -0,0 +1,100 @@
+#ifndef SAMPLE_STORE_H_
+#define SAMPLE_STORE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Fixed-size circular file of sensor samples, memory-mapped.
+//
+// Each record carries the low bits of its sequence number and a checksum, and
+// the header only holds a hint of the next sequence. Nothing is synced per
+// sample: after a crash open() walks forward from the hint over valid records
+// and readers skip slots whose sequence/checksum don't match.
+class SampleStore {
+public:
+    enum Status : uint8_t {
+        STATUS_OK       = 0,
+        STATUS_TIMEOUT  = 1,
+        STATUS_CHECKSUM = 2,
+        STATUS_ERROR    = 3,
+    };
+
+#pragma pack(push, 1)
+    struct Sample {
+        uint32_t uiTime;         // unix seconds
+        uint32_t uiSeq;          // low 32 bits of the sequence number
+        int16_t iTempTenths;
+        uint16_t uiHumTenths;
+        uint16_t uiLatency100Us; // duration of the read, saturates at 6.5 s
+        uint8_t uiStatus;
+        uint8_t uiCheck;         // makes the byte sum of the record CHECK_SEED (0xA5), an all-zero record never passes
+    };
+#pragma pack(pop)
+
+    static_assert(sizeof(Sample) == 16, "Sample must stay 16 bytes");
+
+    // 121 days of 20 second samples, 8 MiB
+    static constexpr uint64_t DEFAULT_CAPACITY = 1 << 19;
+
+    SampleStore();
+    ~SampleStore();
+
+    SampleStore(const SampleStore&) = delete;
+    SampleStore& operator=(const SampleStore&) = delete;
+
+    // Creates the file with ullCapacity records if it doesn't exist, otherwise
+    // keeps the capacity it was created with.
+    bool open(const std::string& sPath, uint64_t ullCapacity = DEFAULT_CAPACITY, bool bReadOnly = false);
+    void close();
+    bool isOpen() const;
+
+    bool append(uint32_t uiTime, float fTemp, float fHum, uint32_t uiLatencyUs, Status eStatus);
+
+    uint64_t capacity() const;
+    // Sequence of the next record to be written; [begin(), end()) is retained.
+    uint64_t begin() const;
+    uint64_t end() const;
+
+    // Record stored under the sequence number, nullptr if overwritten or torn.
+    const Sample* at(uint64_t ullSeq) const;
+
+    // Calls fVisit(const Sample&) for every valid record, oldest first,
+    // directly on the mapping.
+    template <typename F>
+    void forEach(F fVisit) const {
+        for (uint64_t ullSeq = begin(), ullEnd = end(); ullSeq < ullEnd; ++ullSeq) {
+            if (const Sample* pSample = at(ullSeq)) {
+                fVisit(*pSample);
+            }
+        }
+    }
+
+    static float temperature(const Sample& oSample);
+    static float humidity(const Sample& oSample);
+
+private:
+    struct Header {
+        char aMagic[8];
+        uint32_t uiVersion;
+        uint32_t uiRecordSize;
+        uint64_t ullCapacity;
+        std::atomic<uint64_t> ullNextSeq;
+    };
+
+    static constexpr size_t HEADER_SIZE = 4096;
+
+    static uint8_t checksum(const Sample& oSample);
+    bool valid(const Sample& oSample, uint64_t ullSeq) const;
+    void recover();
+
+    int m_iFd = -1;
+    void* m_pMap = nullptr;
+    size_t m_uiMapSize = 0;
+    Header* m_pHeader = nullptr;
+    Sample* m_pSamples = nullptr;
+    bool m_bReadOnly = true;
+};
+
+#endif  // SAMPLE_STORE_H_
@@ -0,0 +1,71 @@
+#include "adaptive_sampler.h"
+
+#include <algorithm>
+#include <cmath>
+
+AdaptiveSampler::AdaptiveSampler(std::chrono::milliseconds oMinInterval, std::chrono::milliseconds oMaxInterval,
+                                 float fTempStep, float fHumStep)
+    : m_dMin(oMinInterval.count() / 1000.0),
+      m_dMax(std::max(oMaxInterval, oMinInterval).count() / 1000.0),
+      m_fTempStep(fTempStep),
+      m_fHumStep(fHumStep),
+      m_dInterval(m_dMin) {}
+
+std::chrono::milliseconds AdaptiveSampler::onSample(Clock::time_point oAt, float fTemp, float fHum) {
+    m_uiFailures = 0;
+
+    if (!m_bHavePrev) {
+        m_bHavePrev = true;
+        m_oPrevAt = oAt;
+        m_fPrevTemp = fTemp;
+        m_fPrevHum = fHum;
+        m_dInterval = m_dMin;
+        return interval();
+    }
+
+    double dElapsed = std::chrono::duration<double>(oAt - m_oPrevAt).count();
+    double dSteps = std::max(std::fabs(fTemp - m_fPrevTemp) / m_fTempStep,
+                             std::fabs(fHum - m_fPrevHum) / m_fHumStep);
+    m_oPrevAt = oAt;
+    m_fPrevTemp = fTemp;
+    m_fPrevHum = fHum;
+
+    if (dElapsed > 0) {
+        m_dRate += RATE_SMOOTHING * (dSteps / dElapsed - m_dRate);
+    }
+
+    // Grow by at most GROWTH per read, never past what the trend allows
+    double dNext = m_dInterval * GROWTH;
+    if (m_dRate > 0) {
+        dNext = std::min(dNext, TARGET_STEPS / m_dRate);
+    }
+    // A visible change reacts at once, whatever the history says
+    if (dSteps >= 1) {
+        dNext = std::min(dNext, m_dInterval / (2 * dSteps));
+    }
+
+    m_dInterval = clamp(dNext);
+    return interval();
+}
+
+std::chrono::milliseconds AdaptiveSampler::onFailure() {
+    ++m_uiFailures;
+    m_dInterval = clamp(std::ldexp(m_dMin, std::min(m_uiFailures, 16u)));
+    return interval();
+}
+
+std::chrono::milliseconds AdaptiveSampler::interval() const {
+    return std::chrono::milliseconds(static_cast<long long>(m_dInterval * 1000));
+}
+
+double AdaptiveSampler::rate() const {
+    return m_dRate;
+}
+
+unsigned AdaptiveSampler::failures() const {
+    return m_uiFailures;
+}
+
+double AdaptiveSampler::clamp(double dSeconds) const {
+    return std::min(std::max(dSeconds, m_dMin), m_dMax);
+}
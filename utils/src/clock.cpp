@@ -0,0 +1,21 @@
+#include "clock.h"
+
+namespace {
+
+class SystemClock : public Clock {
+public:
+    std::chrono::steady_clock::time_point steady() const override {
+        return std::chrono::steady_clock::now();
+    }
+
+    std::chrono::system_clock::time_point wall() const override {
+        return std::chrono::system_clock::now();
+    }
+};
+
+}
+
+const Clock& Clock::system() {
+    static SystemClock oClock;
+    return oClock;
+}
@@ -1,7 +1,19 @@
 #include "logger.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <iostream>
 #include <syslog.h>
 
+namespace {
+
+uint64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}
+
 Logger& Logger::instance() {
     static Logger instance;
     return instance;
@@ -10,37 +22,521 @@ Logger& Logger::instance() {
 Logger::Logger()
     : m_bLogToStdout(false),
       m_iMinLogLevel(LOG_DEBUG),
-      m_bIsSetup(false)
+      m_bIsSetup(false),
+      m_eMode(MODE_SYNC)
 {}
 
 Logger::~Logger() {
+    stopDrain();
     std::lock_guard<std::mutex> lock(m_mutex);
     closelog();
 }
 
-void Logger::setup(bool bLogToStdout, int iMinLogLevel, const std::string& sIdent) {
-    std::lock_guard<std::mutex> lock(instance().m_mutex);
+void Logger::setup(bool bLogToStdout, int iMinLogLevel, const std::string& sIdent,
+                   Mode eMode, OverflowPolicy ePolicy) {
+    Logger& oLogger = instance();
+    std::lock_guard<std::mutex> lock(oLogger.m_mutex);
 
-    if (!instance().m_bIsSetup) {
-        instance().m_bLogToStdout = bLogToStdout;
-        instance().m_iMinLogLevel = iMinLogLevel;
+    if (!oLogger.m_bIsSetup) {
+        oLogger.m_bLogToStdout = bLogToStdout;
+        oLogger.m_iMinLogLevel = iMinLogLevel;
         // Open syslog with the provided identifier.
         openlog(sIdent.c_str(), LOG_PID | LOG_CONS, LOG_USER);
-        instance().m_bIsSetup = true;
+
+        if (eMode == MODE_ASYNC) {
+            oLogger.m_ePolicy = ePolicy;
+            oLogger.m_pRing.reset(new Record[RING_SIZE]);
+            for (size_t i = 0; i < RING_SIZE; ++i) {
+                oLogger.m_pRing[i].uiSeq.store(i, std::memory_order_relaxed);
+            }
+            oLogger.m_bStopDrain = false;
+            oLogger.m_drainThread = std::thread(&Logger::drain, &oLogger);
+            oLogger.m_eMode.store(MODE_ASYNC, std::memory_order_release);
+        }
+
+        oLogger.m_bIsSetup.store(true, std::memory_order_release);
+    }
+}
+
+void Logger::shutdown() {
+    Logger& oLogger = instance();
+    oLogger.stopDrain();
+
+    std::lock_guard<std::mutex> lock(oLogger.m_filterMutex);
+    oLogger.expire(nowNs(), true);
+}
+
+void Logger::setDedupWindow(std::chrono::milliseconds oWindow) {
+    Logger& oLogger = instance();
+    std::lock_guard<std::mutex> lock(oLogger.m_filterMutex);
+    if (oWindow <= std::chrono::milliseconds::zero()) {
+        // Nothing would ever flush the repeats held so far
+        oLogger.expire(nowNs(), true);
+    }
+    oLogger.m_ullDedupWindowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::max(oWindow, std::chrono::milliseconds::zero())).count();
+}
+
+void Logger::setRateLimit(int iPriority, double dPerSecond, double dBurst) {
+    Logger& oLogger = instance();
+    if (iPriority < 0 || iPriority >= PRIORITIES) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(oLogger.m_filterMutex);
+    TokenBucket& oBucket = oLogger.m_aBuckets[iPriority];
+    uint64_t ullIntervalNs = dPerSecond > 0 ? static_cast<uint64_t>(std::clamp(1e9 / dPerSecond, 1.0, 1e15)) : 0;
+    oBucket.ullToleranceNs.store(static_cast<uint64_t>((std::max(dBurst, 1.0) - 1) * ullIntervalNs),
+                                 std::memory_order_relaxed);
+    oBucket.ullFullNs.store(nowNs(), std::memory_order_relaxed);
+    oBucket.ullIntervalNs.store(ullIntervalNs, std::memory_order_relaxed);
+    oLogger.flushLimited(iPriority);
+
+    bool bLimits = false;
+    for (const TokenBucket& oOther : oLogger.m_aBuckets) {
+        bLimits = bLimits || oOther.ullIntervalNs.load(std::memory_order_relaxed);
+    }
+    oLogger.m_bRateLimits = bLimits;
+}
+
+void Logger::expire() {
+    Logger& oLogger = instance();
+    std::lock_guard<std::mutex> lock(oLogger.m_filterMutex);
+    oLogger.expire(nowNs(), false);
+}
+
+bool Logger::nextExpiry(std::chrono::nanoseconds& oIn) {
+    Logger& oLogger = instance();
+    uint64_t ullDueNs = UINT64_MAX;
+
+    // Read without the lock, a summary racing it is found on the next call
+    uint64_t ullWindowNs = oLogger.m_ullDedupWindowNs.load(std::memory_order_relaxed);
+    for (const Repeat& oRepeat : oLogger.m_aRepeats) {
+        if (oRepeat.ullKey.load(std::memory_order_relaxed) &&
+            static_cast<uint32_t>(oRepeat.ullState.load(std::memory_order_relaxed))) {
+            ullDueNs = std::min(ullDueNs, oRepeat.ullSinceNs.load(std::memory_order_relaxed) + ullWindowNs);
+        }
+    }
+    for (const TokenBucket& oBucket : oLogger.m_aBuckets) {
+        if (oBucket.ullPending.load(std::memory_order_relaxed)) {
+            uint64_t ullFullNs = oBucket.ullFullNs.load(std::memory_order_relaxed);
+            uint64_t ullToleranceNs = oBucket.ullToleranceNs.load(std::memory_order_relaxed);
+            ullDueNs = std::min(ullDueNs, ullFullNs - std::min(ullFullNs, ullToleranceNs));
+        }
     }
+    if (ullDueNs == UINT64_MAX) {
+        return false;
+    }
+
+    uint64_t ullNowNs = nowNs();
+    oIn = std::chrono::nanoseconds(ullDueNs > ullNowNs ? ullDueNs - ullNowNs : 0);
+    return true;
 }
 
 void Logger::log(int iPriority, const std::string& sMessage) {
-    std::lock_guard<std::mutex> lock(instance().m_mutex);
+    log(iPriority, sMessage.data(), sMessage.size());
+}
+
+void Logger::log(int iPriority, const char* pText, size_t uiLength, uint64_t ullSite) {
+    Logger& oLogger = instance();
+
+    if (!enabled(iPriority)) {
+        return;
+    }
+    if (!oLogger.admit(iPriority, pText, uiLength, ullSite)) {
+        return;
+    }
+    oLogger.emit(iPriority, pText, uiLength);
+}
+
+bool Logger::enabled(int iPriority) {
+    Logger& oLogger = instance();
+    if (!oLogger.m_bIsSetup.load(std::memory_order_acquire)) {
+        return false;
+    }
+    if (iPriority > oLogger.m_iMinLogLevel.load(std::memory_order_relaxed)) {
+        oLogger.m_ullSuppressed.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+uint64_t Logger::dropped() {
+    return instance().m_ullDropped.load(std::memory_order_relaxed);
+}
+
+uint64_t Logger::emitted() {
+    return instance().m_ullEmitted.load(std::memory_order_relaxed);
+}
+
+uint64_t Logger::suppressed() {
+    return instance().m_ullSuppressed.load(std::memory_order_relaxed);
+}
+
+uint64_t Logger::deduplicated() {
+    return instance().m_ullDeduplicated.load(std::memory_order_relaxed);
+}
+
+uint64_t Logger::rateLimited(int iPriority) {
+    Logger& oLogger = instance();
+    if (iPriority >= 0) {
+        return iPriority < PRIORITIES ?
+               oLogger.m_aBuckets[iPriority].ullLimited.load(std::memory_order_relaxed) : 0;
+    }
+
+    uint64_t ullTotal = 0;
+    for (const TokenBucket& oBucket : oLogger.m_aBuckets) {
+        ullTotal += oBucket.ullLimited.load(std::memory_order_relaxed);
+    }
+    return ullTotal;
+}
+
+void Logger::emit(int iPriority, const char* pText, size_t uiLength) {
+    if (m_eMode.load(std::memory_order_acquire) == MODE_ASYNC) {
+        push(iPriority, pText, uiLength);
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    write(iPriority, pText, uiLength);
+    if (m_bLogToStdout) {
+        std::cout.flush();
+    }
+}
+
+void Logger::write(int iPriority, const char* pText, size_t uiLength) {
+    m_ullEmitted.fetch_add(1, std::memory_order_relaxed);
+    syslog(iPriority, "%.*s", static_cast<int>(uiLength), pText);
+    if (m_bLogToStdout) {
+        std::cout.write(pText, uiLength) << '\n';
+    }
+}
+
+// Bounded MPMC queue with per-slot sequence numbers (D. Vyukov). Producers
+// claim a slot with one CAS and publish it by bumping its sequence.
+bool Logger::tryPush(int iPriority, const char* pText, size_t uiLength) {
+    size_t uiPos = m_uiEnqueuePos.load(std::memory_order_relaxed);
+    Record* pRecord = nullptr;
+
+    for (;;) {
+        pRecord = &m_pRing[uiPos & (RING_SIZE - 1)];
+        size_t uiSeq = pRecord->uiSeq.load(std::memory_order_acquire);
+        intptr_t iDiff = static_cast<intptr_t>(uiSeq) - static_cast<intptr_t>(uiPos);
+        if (iDiff == 0) {
+            if (m_uiEnqueuePos.compare_exchange_weak(uiPos, uiPos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (iDiff < 0) {
+            return false;
+        } else {
+            uiPos = m_uiEnqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    pRecord->iPriority = iPriority;
+    pRecord->uiLength = static_cast<uint16_t>(std::min(uiLength, RECORD_TEXT_SIZE));
+    std::memcpy(pRecord->aText, pText, pRecord->uiLength);
+    pRecord->uiSeq.store(uiPos + 1, std::memory_order_release);
+    return true;
+}
+
+bool Logger::tryPop(Record& oOut) {
+    size_t uiPos = m_uiDequeuePos.load(std::memory_order_relaxed);
+    Record* pRecord = nullptr;
+
+    for (;;) {
+        pRecord = &m_pRing[uiPos & (RING_SIZE - 1)];
+        size_t uiSeq = pRecord->uiSeq.load(std::memory_order_acquire);
+        intptr_t iDiff = static_cast<intptr_t>(uiSeq) - static_cast<intptr_t>(uiPos + 1);
+        if (iDiff == 0) {
+            if (m_uiDequeuePos.compare_exchange_weak(uiPos, uiPos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (iDiff < 0) {
+            return false;
+        } else {
+            uiPos = m_uiDequeuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    oOut.iPriority = pRecord->iPriority;
+    oOut.uiLength = pRecord->uiLength;
+    std::memcpy(oOut.aText, pRecord->aText, pRecord->uiLength);
+    pRecord->uiSeq.store(uiPos + RING_SIZE, std::memory_order_release);
+    return true;
+}
+
+void Logger::push(int iPriority, const char* pText, size_t uiLength) {
+    while (!tryPush(iPriority, pText, uiLength)) {
+        if (m_ePolicy == DROP_NEWEST) {
+            m_ullDropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        if (m_ePolicy == DROP_OLDEST) {
+            Record oOldest;
+            if (tryPop(oOldest)) {
+                m_ullDropped.fetch_add(1, std::memory_order_relaxed);
+            }
+        } else {
+            m_cvDrain.notify_one();
+            std::this_thread::yield();
+        }
+    }
+
+    // Pairs with the fence in drain(): either the drainer sees the record
+    // before it sleeps or this sees it idle. The lock keeps the notification
+    // from landing between its last look at the queue and the wait.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_bDrainerIdle.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(m_drainMutex);
+        m_cvDrain.notify_one();
+    }
+}
+
+void Logger::drain() {
+    Record oRecord;
+
+    for (;;) {
+        size_t uiCount = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            while (uiCount < DRAIN_BATCH && tryPop(oRecord)) {
+                write(oRecord.iPriority, oRecord.aText, oRecord.uiLength);
+                ++uiCount;
+            }
+            if (uiCount && m_bLogToStdout) {
+                std::cout.flush();
+            }
+        }
+
+        if (uiCount) {
+            continue;
+        }
+        if (m_bStopDrain.load()) {
+            break;
+        }
+
+        // Producers only signal an idle drainer, see push()
+        std::unique_lock<std::mutex> lock(m_drainMutex);
+        m_bDrainerIdle.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        m_cvDrain.wait(lock, [this]() {
+            return m_bStopDrain.load() ||
+                   m_uiEnqueuePos.load(std::memory_order_relaxed) !=
+                   m_uiDequeuePos.load(std::memory_order_relaxed);
+        });
+        m_bDrainerIdle.store(false, std::memory_order_relaxed);
+    }
+}
+
+void Logger::stopDrain() {
+    if (!m_drainThread.joinable()) {
+        return;
+    }
+
+    m_eMode.store(MODE_SYNC, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(m_drainMutex);
+        m_bStopDrain = true;
+    }
+    m_cvDrain.notify_one();
+    m_drainThread.join();
+
+    // Records pushed by callers that raced with the mode switch
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Record oRecord;
+    while (tryPop(oRecord)) {
+        write(oRecord.iPriority, oRecord.aText, oRecord.uiLength);
+    }
+    if (m_bLogToStdout) {
+        std::cout.flush();
+    }
+}
+
+// Repeats and rejected records are settled on atomics. Only the first record
+// of a dedup window and the periodic expiry take m_filterMutex, both with a
+// try-lock, so a record never waits for another thread.
+bool Logger::admit(int iPriority, const char* pText, size_t uiLength, uint64_t ullSite) {
+    uint64_t ullWindowNs = m_ullDedupWindowNs.load(std::memory_order_relaxed);
+    bool bRateLimits = m_bRateLimits.load(std::memory_order_relaxed);
+    if (!ullWindowNs && !bRateLimits) {
+        return true;
+    }
+
+    uint64_t ullNowNs = nowNs();
+    if (m_ullExpiredNs.load(std::memory_order_relaxed) + EXPIRE_PERIOD_NS <= ullNowNs) {
+        std::unique_lock<std::mutex> lock(m_filterMutex, std::try_to_lock);
+        if (lock.owns_lock()) {
+            expire(ullNowNs, false);
+        }
+    }
+
+    Repeat* pSet = nullptr;
+    uint64_t ullKey = 0;
+    if (ullWindowNs) {
+        // FNV-1a of the text seeded with the call site, never 0
+        ullKey = ullSite ? ullSite : FNV_OFFSET;
+        for (size_t i = 0; i < uiLength; ++i) {
+            ullKey = (ullKey ^ static_cast<unsigned char>(pText[i])) * FNV_PRIME;
+        }
+        ullKey |= 1;
+
+        pSet = &m_aRepeats[((ullKey >> 1) & (REPEAT_SLOTS / 2 - 1)) * 2];
+        if (countRepeat(pSet, ullKey, ullNowNs, ullWindowNs)) {
+            return false;
+        }
+    }
+
+    if (bRateLimits && iPriority >= 0 && iPriority < PRIORITIES && !takeToken(iPriority, ullNowNs)) {
+        return false;
+    }
+
+    if (pSet) {
+        track(pSet, ullKey, ullNowNs, ullWindowNs, iPriority, pText, uiLength);
+    }
+    return true;
+}
+
+bool Logger::countRepeat(Repeat* pSet, uint64_t ullKey, uint64_t ullNowNs, uint64_t ullWindowNs) {
+    for (Repeat* pWay = pSet; pWay != pSet + 2; ++pWay) {
+        uint64_t ullState = pWay->ullState.load(std::memory_order_acquire);
+        uint64_t ullGeneration = ullState >> 32;
+        if (ullGeneration & 1 || pWay->ullKey.load(std::memory_order_relaxed) != ullKey ||
+            pWay->ullSinceNs.load(std::memory_order_relaxed) + ullWindowNs <= ullNowNs) {
+            continue;
+        }
+
+        // Orders the copies before the CAS, which fails once the slot changed
+        std::atomic_thread_fence(std::memory_order_acquire);
+        while (ullState >> 32 == ullGeneration && static_cast<uint32_t>(ullState) != UINT32_MAX) {
+            if (pWay->ullState.compare_exchange_weak(ullState, ullState + 1, std::memory_order_relaxed)) {
+                m_ullDeduplicated.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void Logger::track(Repeat* pSet, uint64_t ullKey, uint64_t ullNowNs, uint64_t ullWindowNs,
+                   int iPriority, const char* pText, size_t uiLength) {
+    // Under contention the record goes out untracked rather than wait
+    std::unique_lock<std::mutex> lock(m_filterMutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return;
+    }
+
+    Repeat* pRepeat = nullptr;
+    for (Repeat* pWay = pSet; pWay != pSet + 2; ++pWay) {
+        if (pWay->ullKey.load(std::memory_order_relaxed) == ullKey) {
+            pRepeat = pWay;
+        }
+    }
+    if (pRepeat && pRepeat->ullSinceNs.load(std::memory_order_relaxed) + ullWindowNs > ullNowNs) {
+        // Another thread opened this window meanwhile
+        return;
+    }
+    if (!pRepeat) {
+        // Two ways per set, a miss takes the free or the older one
+        uint64_t ullKey0 = pSet[0].ullKey.load(std::memory_order_relaxed);
+        uint64_t ullKey1 = pSet[1].ullKey.load(std::memory_order_relaxed);
+        pRepeat = !ullKey0 || (ullKey1 && pSet[0].ullSinceNs.load(std::memory_order_relaxed) <=
+                                          pSet[1].ullSinceNs.load(std::memory_order_relaxed)) ?
+                  &pSet[0] : &pSet[1];
+    }
+
+    flushRepeat(*pRepeat);
+    uint64_t ullState = closeRepeat(*pRepeat);
+    pRepeat->ullKey.store(ullKey, std::memory_order_relaxed);
+    pRepeat->ullSinceNs.store(ullNowNs, std::memory_order_relaxed);
+    pRepeat->iPriority = iPriority;
+    pRepeat->uiLength = static_cast<uint16_t>(std::min(uiLength, REPEAT_TEXT_SIZE));
+    std::memcpy(pRepeat->aText, pText, pRepeat->uiLength);
+    openRepeat(*pRepeat, ullState);
+}
+
+bool Logger::takeToken(int iPriority, uint64_t ullNowNs) {
+    TokenBucket& oBucket = m_aBuckets[iPriority];
+    uint64_t ullIntervalNs = oBucket.ullIntervalNs.load(std::memory_order_relaxed);
+    if (!ullIntervalNs) {
+        return true;
+    }
 
-    if (!instance().m_bIsSetup) {
+    // Each token pushes the time the bucket is full again by one interval;
+    // a token is left while that time is at most the burst less one ahead.
+    uint64_t ullToleranceNs = oBucket.ullToleranceNs.load(std::memory_order_relaxed);
+    uint64_t ullFullNs = oBucket.ullFullNs.load(std::memory_order_relaxed);
+    for (;;) {
+        uint64_t ullFromNs = std::max(ullFullNs, ullNowNs);
+        if (ullFromNs - ullNowNs > ullToleranceNs) {
+            oBucket.ullPending.fetch_add(1, std::memory_order_relaxed);
+            oBucket.ullLimited.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (oBucket.ullFullNs.compare_exchange_weak(ullFullNs, ullFromNs + ullIntervalNs,
+                                                    std::memory_order_relaxed)) {
+            break;
+        }
+    }
+    flushLimited(iPriority);
+    return true;
+}
+
+// Under m_filterMutex: a new, odd generation turns the lock-free counters
+// away, the state before it is returned.
+uint64_t Logger::closeRepeat(Repeat& oRepeat) {
+    uint64_t ullState = oRepeat.ullState.load(std::memory_order_relaxed);
+    while (!oRepeat.ullState.compare_exchange_weak(ullState, ((ullState >> 32) + 1) << 32,
+                                                   std::memory_order_relaxed)) {
+    }
+    // Orders the generation before the changes to the slot
+    std::atomic_thread_fence(std::memory_order_release);
+    return ullState;
+}
+
+void Logger::openRepeat(Repeat& oRepeat, uint64_t ullState) {
+    oRepeat.ullState.store(((ullState >> 32) + 2) << 32, std::memory_order_release);
+}
+
+void Logger::flushRepeat(Repeat& oRepeat) {
+    if (!oRepeat.ullKey.load(std::memory_order_relaxed)) {
         return;
     }
 
-    if (iPriority <= instance().m_iMinLogLevel) {
-        syslog(iPriority, "%s", sMessage.c_str());
-        if (instance().m_bLogToStdout) {
-            std::cout << sMessage << std::endl;
+    uint64_t ullState = closeRepeat(oRepeat);
+    if (uint32_t uiRepeats = static_cast<uint32_t>(ullState)) {
+        Line oLine;
+        oLine.append("Logger| Last message repeated [", uiRepeats, "] times: [",
+                     std::string_view(oRepeat.aText, oRepeat.uiLength), "]");
+        emit(oRepeat.iPriority, oLine.data(), oLine.size());
+    }
+    oRepeat.ullKey.store(0, std::memory_order_relaxed);
+    openRepeat(oRepeat, ullState);
+}
+
+void Logger::flushLimited(int iPriority) {
+    TokenBucket& oBucket = m_aBuckets[iPriority];
+    if (!oBucket.ullPending.load(std::memory_order_relaxed)) {
+        return;
+    }
+    if (uint64_t ullPending = oBucket.ullPending.exchange(0, std::memory_order_relaxed)) {
+        Line oLine;
+        oLine.append("Logger| Rate limited [", ullPending, "] records of priority [", iPriority, "]");
+        emit(iPriority, oLine.data(), oLine.size());
+    }
+}
+
+void Logger::expire(uint64_t ullNowNs, bool bAll) {
+    m_ullExpiredNs.store(ullNowNs, std::memory_order_relaxed);
+
+    uint64_t ullWindowNs = m_ullDedupWindowNs.load(std::memory_order_relaxed);
+    for (Repeat& oRepeat : m_aRepeats) {
+        if (bAll || oRepeat.ullSinceNs.load(std::memory_order_relaxed) + ullWindowNs <= ullNowNs) {
+            flushRepeat(oRepeat);
         }
     }
+    for (int iPriority = 0; iPriority < PRIORITIES; ++iPriority) {
+        flushLimited(iPriority);
+    }
 }
@@ -0,0 +1,257 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <syslog.h>
+#include <unistd.h>
+
+#include "logger.h"
+
+namespace {
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<const metrics::Metric*> vMetrics;
+};
+
+Registry& registry() {
+    static Registry oRegistry;
+    return oRegistry;
+}
+
+void appendNumber(std::string& sOut, double dValue) {
+    char aBuf[32];
+    int iLen = std::snprintf(aBuf, sizeof(aBuf), "%.9g", dValue);
+    sOut.append(aBuf, iLen > 0 ? iLen : 0);
+}
+
+void appendSeries(std::string& sOut, const char* pName, const char* pSuffix,
+                  const char* pLabels, const char* pExtraLabel = nullptr) {
+    sOut += pName;
+    sOut += pSuffix;
+    if (*pLabels || pExtraLabel) {
+        sOut += '{';
+        sOut += pLabels;
+        if (*pLabels && pExtraLabel) {
+            sOut += ',';
+        }
+        if (pExtraLabel) {
+            sOut += pExtraLabel;
+        }
+        sOut += '}';
+    }
+    sOut += ' ';
+}
+
+const char* typeName(metrics::Metric::Type eType) {
+    switch (eType) {
+        case metrics::Metric::TYPE_COUNTER:
+            return "counter";
+        case metrics::Metric::TYPE_GAUGE:
+            return "gauge";
+        default:
+            return "histogram";
+    }
+}
+
+}
+
+metrics::Metric::Metric(Type eType, const char* pName, const char* pHelp, const char* pLabels)
+    : m_eType(eType), m_pName(pName), m_pHelp(pHelp), m_pLabels(pLabels) {
+    Registry& oRegistry = registry();
+    std::lock_guard<std::mutex> lock(oRegistry.mutex);
+    oRegistry.vMetrics.push_back(this);
+}
+
+metrics::Metric::~Metric() {
+    Registry& oRegistry = registry();
+    std::lock_guard<std::mutex> lock(oRegistry.mutex);
+    auto it = std::find(oRegistry.vMetrics.begin(), oRegistry.vMetrics.end(), this);
+    if (it != oRegistry.vMetrics.end()) {
+        oRegistry.vMetrics.erase(it);
+    }
+}
+
+metrics::Counter::Counter(const char* pName, const char* pHelp, const char* pLabels)
+    : Metric(TYPE_COUNTER, pName, pHelp, pLabels) {}
+
+void metrics::Counter::render(std::string& sOut) const {
+    appendSeries(sOut, name(), "", labels());
+    sOut += std::to_string(value());
+    sOut += '\n';
+}
+
+metrics::Callback::Callback(Type eType, const char* pName, const char* pHelp,
+                            std::function<double()> fValue, const char* pLabels)
+    : Metric(eType, pName, pHelp, pLabels), m_fValue(std::move(fValue)) {}
+
+void metrics::Callback::render(std::string& sOut) const {
+    appendSeries(sOut, name(), "", labels());
+    appendNumber(sOut, m_fValue());
+    sOut += '\n';
+}
+
+metrics::Histogram::Histogram(const char* pName, const char* pHelp, std::initializer_list<double> lBounds,
+                              const char* pLabels)
+    : Metric(TYPE_HISTOGRAM, pName, pHelp, pLabels) {
+    for (double dBound : lBounds) {
+        if (m_uiBounds == MAX_BUCKETS) {
+            break;
+        }
+        m_aBounds[m_uiBounds] = dBound;
+        m_aBoundsNs[m_uiBounds] = static_cast<uint64_t>(dBound * 1e9);
+        ++m_uiBounds;
+    }
+    for (auto& oCount : m_aCounts) {
+        oCount.store(0, std::memory_order_relaxed);
+    }
+}
+
+void metrics::Histogram::render(std::string& sOut) const {
+    uint64_t ullCumulative = 0;
+    char aLe[48];
+    for (size_t i = 0; i <= m_uiBounds; ++i) {
+        ullCumulative += m_aCounts[i].load(std::memory_order_relaxed);
+        if (i < m_uiBounds) {
+            std::snprintf(aLe, sizeof(aLe), "le=\"%g\"", m_aBounds[i]);
+        } else {
+            std::snprintf(aLe, sizeof(aLe), "le=\"+Inf\"");
+        }
+        appendSeries(sOut, name(), "_bucket", labels(), aLe);
+        sOut += std::to_string(ullCumulative);
+        sOut += '\n';
+    }
+    appendSeries(sOut, name(), "_sum", labels());
+    appendNumber(sOut, m_ullSumNs.load(std::memory_order_relaxed) / 1e9);
+    sOut += '\n';
+    appendSeries(sOut, name(), "_count", labels());
+    sOut += std::to_string(ullCumulative);
+    sOut += '\n';
+}
+
+std::string metrics::snapshot() {
+    Registry& oRegistry = registry();
+    std::lock_guard<std::mutex> lock(oRegistry.mutex);
+
+    // Series sharing a name are grouped under one HELP/TYPE header
+    std::string sOut;
+    std::vector<bool> vDone(oRegistry.vMetrics.size(), false);
+    for (size_t i = 0; i < oRegistry.vMetrics.size(); ++i) {
+        if (vDone[i]) {
+            continue;
+        }
+        const Metric* pFirst = oRegistry.vMetrics[i];
+        sOut += "# HELP ";
+        sOut += pFirst->name();
+        sOut += ' ';
+        sOut += pFirst->help();
+        sOut += "\n# TYPE ";
+        sOut += pFirst->name();
+        sOut += ' ';
+        sOut += typeName(pFirst->type());
+        sOut += '\n';
+        for (size_t j = i; j < oRegistry.vMetrics.size(); ++j) {
+            if (!vDone[j] && std::strcmp(oRegistry.vMetrics[j]->name(), pFirst->name()) == 0) {
+                oRegistry.vMetrics[j]->render(sOut);
+                vDone[j] = true;
+            }
+        }
+    }
+    return sOut;
+}
+
+metrics::Server::Server() {}
+
+metrics::Server::~Server() {
+    stop();
+}
+
+bool metrics::Server::start(const std::string& sPath) {
+    sockaddr_un oAddr {};
+    if (sPath.size() >= sizeof(oAddr.sun_path)) {
+        LOGGER_LOG(LOG_ERR, "Metrics| Socket path is too long: [", sPath, "]");
+        return false;
+    }
+
+    m_iFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (m_iFd < 0) {
+        LOGGER_LOG(LOG_ERR, "Metrics| Failed to create socket: ", std::strerror(errno));
+        return false;
+    }
+
+    oAddr.sun_family = AF_UNIX;
+    std::memcpy(oAddr.sun_path, sPath.c_str(), sPath.size() + 1);
+    unlink(sPath.c_str());
+    if (bind(m_iFd, reinterpret_cast<sockaddr*>(&oAddr), sizeof(oAddr)) < 0 || listen(m_iFd, 4) < 0) {
+        LOGGER_LOG(LOG_ERR, "Metrics| Failed to listen on [", sPath, "]: ", std::strerror(errno));
+        close(m_iFd);
+        m_iFd = -1;
+        return false;
+    }
+
+    // The thread blocks in poll() until a client or stop() comes along
+    m_iWakeFd = eventfd(0, EFD_CLOEXEC);
+    if (m_iWakeFd < 0) {
+        LOGGER_LOG(LOG_ERR, "Metrics| Failed to create eventfd: ", std::strerror(errno));
+        close(m_iFd);
+        m_iFd = -1;
+        unlink(sPath.c_str());
+        return false;
+    }
+
+    m_sPath = sPath;
+    m_bStop = false;
+    m_thread = std::thread(&Server::run, this);
+    LOGGER_LOG(LOG_INFO, "Metrics| Serving on [", sPath, "]");
+    return true;
+}
+
+void metrics::Server::stop() {
+    if (m_thread.joinable()) {
+        m_bStop = true;
+        uint64_t ullOne = 1;
+        if (write(m_iWakeFd, &ullOne, sizeof(ullOne)) < 0) {
+            LOGGER_LOG(LOG_ERR, "Metrics| Failed to wake the server: ", std::strerror(errno));
+        }
+        m_thread.join();
+    }
+    if (m_iWakeFd >= 0) {
+        close(m_iWakeFd);
+        m_iWakeFd = -1;
+    }
+    if (m_iFd >= 0) {
+        close(m_iFd);
+        m_iFd = -1;
+        unlink(m_sPath.c_str());
+    }
+}
+
+void metrics::Server::run() {
+    pollfd aPoll[2] = {{m_iFd, POLLIN, 0}, {m_iWakeFd, POLLIN, 0}};
+    while (!m_bStop.load()) {
+        if (poll(aPoll, 2, -1) <= 0 || !(aPoll[0].revents & POLLIN)) {
+            continue;
+        }
+        int iClient = accept4(m_iFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (iClient < 0) {
+            continue;
+        }
+
+        std::string sBody = snapshot();
+        size_t uiSent = 0;
+        while (uiSent < sBody.size()) {
+            ssize_t iRes = send(iClient, sBody.data() + uiSent, sBody.size() - uiSent, MSG_NOSIGNAL);
+            if (iRes <= 0) {
+                break;
+            }
+            uiSent += iRes;
+        }
+        close(iClient);
+    }
+}
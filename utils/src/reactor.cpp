@@ -0,0 +1,306 @@
+#include "reactor.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <syslog.h>
+#include <unistd.h>
+
+#include "logger.h"
+#include "metrics.h"
+
+namespace {
+
+metrics::Counter g_oWakeups("reactor_wakeups_total", "Event loop returns from epoll_wait");
+
+timespec toTimespec(std::chrono::nanoseconds oValue) {
+    timespec oTs;
+    oTs.tv_sec = oValue.count() / 1000000000;
+    oTs.tv_nsec = oValue.count() % 1000000000;
+    return oTs;
+}
+
+}
+
+Reactor::Reactor(VirtualClock* pClock) : m_pClock(pClock) {
+    m_iEpollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (m_iEpollFd < 0) {
+        LOGGER_LOG(LOG_ERR, "Reactor| Failed to create epoll: ", std::strerror(errno));
+    }
+}
+
+Reactor::~Reactor() {
+    for (const auto& oSource : m_mSources) {
+        if (oSource.second->eKind != KIND_FD) {
+            close(oSource.first);
+        }
+    }
+    if (m_iEpollFd >= 0) {
+        close(m_iEpollFd);
+    }
+}
+
+bool Reactor::isOpen() const {
+    return m_iEpollFd >= 0;
+}
+
+const Clock& Reactor::clock() const {
+    return m_pClock ? *m_pClock : Clock::system();
+}
+
+bool Reactor::addSignals(std::initializer_list<int> lSignals, SignalHandler fHandler) {
+    sigset_t oMask;
+    sigemptyset(&oMask);
+    for (int iSignal : lSignals) {
+        sigaddset(&oMask, iSignal);
+    }
+
+    // Blocked signals stay pending until read from the signalfd, so nothing
+    // runs in signal context.
+    int iErr = pthread_sigmask(SIG_BLOCK, &oMask, nullptr);
+    if (iErr != 0) {
+        LOGGER_LOG(LOG_ERR, "Reactor| Failed to block signals: ", std::strerror(iErr));
+        return false;
+    }
+
+    int iFd = signalfd(-1, &oMask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (iFd < 0) {
+        LOGGER_LOG(LOG_ERR, "Reactor| Failed to create signalfd: ", std::strerror(errno));
+        return false;
+    }
+
+    auto pSource = std::make_shared<Source>();
+    pSource->eKind = KIND_SIGNAL;
+    pSource->fSignal = std::move(fHandler);
+    if (!watch(iFd, EPOLLIN, pSource)) {
+        close(iFd);
+        return false;
+    }
+    return true;
+}
+
+int Reactor::addTimer(clockid_t iClock, TimerHandler fHandler) {
+    int iFd = timerfd_create(iClock, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (iFd < 0) {
+        LOGGER_LOG(LOG_ERR, "Reactor| Failed to create timerfd: ", std::strerror(errno));
+        return -1;
+    }
+
+    auto pSource = std::make_shared<Source>();
+    pSource->eKind = KIND_TIMER;
+    pSource->fTimer = std::move(fHandler);
+    if (!watch(iFd, EPOLLIN, pSource)) {
+        close(iFd);
+        return -1;
+    }
+    return iFd;
+}
+
+bool Reactor::armAfter(int iTimer, std::chrono::nanoseconds oDelay, std::chrono::nanoseconds oInterval) {
+    auto it = m_mSources.find(iTimer);
+    if (it == m_mSources.end() || it->second->eKind != KIND_TIMER) {
+        return false;
+    }
+    it->second->oAlign = std::chrono::seconds::zero();
+
+    if (m_pClock) {
+        it->second->bArmed = true;
+        it->second->oDeadline = m_pClock->steady() + std::max(oDelay, std::chrono::nanoseconds(1));
+        it->second->oInterval = oInterval;
+        return true;
+    }
+
+    itimerspec oSpec;
+    // A zero it_value would disarm the timer
+    oSpec.it_value = toTimespec(std::max(oDelay, std::chrono::nanoseconds(1)));
+    oSpec.it_interval = toTimespec(oInterval);
+    if (timerfd_settime(iTimer, 0, &oSpec, nullptr) < 0) {
+        LOGGER_LOG(LOG_ERR, "Reactor| Failed to arm timer: ", std::strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+bool Reactor::armAligned(int iTimer, std::chrono::seconds oPeriod) {
+    auto it = m_mSources.find(iTimer);
+    if (it == m_mSources.end() || it->second->eKind != KIND_TIMER || oPeriod.count() <= 0) {
+        return false;
+    }
+    it->second->oAlign = oPeriod;
+
+    if (m_pClock) {
+        std::chrono::nanoseconds oWall = m_pClock->wall().time_since_epoch();
+        it->second->bArmed = true;
+        it->second->oDeadline = m_pClock->steady() + (oWall / oPeriod + 1) * oPeriod - oWall;
+        it->second->oInterval = oPeriod;
+        return true;
+    }
+
+    timespec oNow;
+    clock_gettime(CLOCK_REALTIME, &oNow);
+
+    itimerspec oSpec {};
+    oSpec.it_value.tv_sec = (oNow.tv_sec / oPeriod.count() + 1) * oPeriod.count();
+    oSpec.it_interval.tv_sec = oPeriod.count();
+    if (timerfd_settime(iTimer, TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET, &oSpec, nullptr) < 0) {
+        LOGGER_LOG(LOG_ERR, "Reactor| Failed to arm aligned timer: ", std::strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+bool Reactor::disarm(int iTimer) {
+    auto it = m_mSources.find(iTimer);
+    if (it == m_mSources.end() || it->second->eKind != KIND_TIMER) {
+        return false;
+    }
+    it->second->oAlign = std::chrono::seconds::zero();
+    it->second->bArmed = false;
+
+    itimerspec oSpec {};
+    return timerfd_settime(iTimer, 0, &oSpec, nullptr) == 0;
+}
+
+void Reactor::removeTimer(int iTimer) {
+    auto it = m_mSources.find(iTimer);
+    if (it == m_mSources.end() || it->second->eKind != KIND_TIMER) {
+        return;
+    }
+    epoll_ctl(m_iEpollFd, EPOLL_CTL_DEL, iTimer, nullptr);
+    m_mSources.erase(it);
+    close(iTimer);
+}
+
+bool Reactor::addFd(int iFd, uint32_t uiEvents, FdHandler fHandler) {
+    auto pSource = std::make_shared<Source>();
+    pSource->eKind = KIND_FD;
+    pSource->fFd = std::move(fHandler);
+    return watch(iFd, uiEvents, pSource);
+}
+
+void Reactor::removeFd(int iFd) {
+    auto it = m_mSources.find(iFd);
+    if (it == m_mSources.end() || it->second->eKind != KIND_FD) {
+        return;
+    }
+    epoll_ctl(m_iEpollFd, EPOLL_CTL_DEL, iFd, nullptr);
+    m_mSources.erase(it);
+}
+
+void Reactor::run() {
+    epoll_event aEvents[8];
+
+    m_bStop = false;
+    while (!m_bStop) {
+        // Virtual time only moves on when nothing is ready
+        int iCount = epoll_wait(m_iEpollFd, aEvents, 8, m_pClock ? 0 : -1);
+        if (iCount == 0 && m_pClock) {
+            advance();
+            continue;
+        }
+        ++m_ullWakeups;
+        g_oWakeups.inc();
+        if (iCount < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOGGER_LOG(LOG_ERR, "Reactor| epoll_wait failed: ", std::strerror(errno));
+            return;
+        }
+        for (int i = 0; i < iCount && !m_bStop; ++i) {
+            dispatch(aEvents[i].data.fd, aEvents[i].events);
+        }
+    }
+}
+
+void Reactor::stop() {
+    m_bStop = true;
+}
+
+uint64_t Reactor::wakeups() const {
+    return m_ullWakeups;
+}
+
+// Fires the earliest virtual timer if it is due, else advances the clock to it
+void Reactor::advance() {
+    std::shared_ptr<Source> pDue;
+    for (const auto& oSource : m_mSources) {
+        const Source& oCandidate = *oSource.second;
+        if (oCandidate.eKind == KIND_TIMER && oCandidate.bArmed &&
+            (!pDue || oCandidate.oDeadline < pDue->oDeadline)) {
+            pDue = oSource.second;
+        }
+    }
+
+    std::chrono::steady_clock::time_point oNow = m_pClock->steady();
+    if (!pDue || pDue->oDeadline > oNow) {
+        m_pClock->advance(pDue ? pDue->oDeadline : std::chrono::steady_clock::time_point::max());
+        return;
+    }
+
+    // Expirations missed meanwhile fold into one, as with a timerfd
+    if (pDue->oInterval > std::chrono::nanoseconds::zero()) {
+        while (pDue->oDeadline <= oNow) {
+            pDue->oDeadline += pDue->oInterval;
+        }
+    } else {
+        pDue->bArmed = false;
+    }
+    ++m_ullWakeups;
+    g_oWakeups.inc();
+    pDue->fTimer();
+}
+
+bool Reactor::watch(int iFd, uint32_t uiEvents, std::shared_ptr<Source> pSource) {
+    epoll_event oEvent {};
+    oEvent.events = uiEvents;
+    oEvent.data.fd = iFd;
+    if (epoll_ctl(m_iEpollFd, EPOLL_CTL_ADD, iFd, &oEvent) < 0) {
+        LOGGER_LOG(LOG_ERR, "Reactor| Failed to watch fd [", iFd, "]: ", std::strerror(errno));
+        return false;
+    }
+    m_mSources[iFd] = std::move(pSource);
+    return true;
+}
+
+void Reactor::dispatch(int iFd, uint32_t uiEvents) {
+    auto it = m_mSources.find(iFd);
+    if (it == m_mSources.end()) {
+        // Removed by an earlier handler of the same batch
+        return;
+    }
+    // Keeps the handler alive if it removes its own source
+    std::shared_ptr<Source> pSource = it->second;
+
+    switch (pSource->eKind) {
+        case KIND_TIMER: {
+            uint64_t ullExpirations = 0;
+            if (::read(iFd, &ullExpirations, sizeof(ullExpirations)) < 0) {
+                if (errno != ECANCELED) {
+                    return;
+                }
+                // The wall clock was set: re-align and redraw right away
+                armAligned(iFd, pSource->oAlign);
+            }
+            pSource->fTimer();
+            break;
+        }
+
+        case KIND_SIGNAL: {
+            signalfd_siginfo oInfo;
+            while (::read(iFd, &oInfo, sizeof(oInfo)) == sizeof(oInfo)) {
+                pSource->fSignal(static_cast<int>(oInfo.ssi_signo));
+            }
+            break;
+        }
+
+        case KIND_FD:
+            pSource->fFd(uiEvents);
+            break;
+    }
+}
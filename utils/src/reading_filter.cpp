@@ -0,0 +1,175 @@
+#include "reading_filter.h"
+
+#include <algorithm>
+#include <cmath>
+
+RollingWindow::MonotonicDeque::MonotonicDeque(size_t uiSize) : m_vSeqs(uiSize) {}
+
+void RollingWindow::MonotonicDeque::clear() {
+    m_uiHead = 0;
+    m_uiCount = 0;
+}
+
+template <typename F>
+void RollingWindow::MonotonicDeque::push(uint64_t ullSeq, F fOutranks) {
+    // The new value outlives every older one it outranks
+    while (m_uiCount > 0 && !fOutranks(m_vSeqs[(m_uiHead + m_uiCount - 1) % m_vSeqs.size()], ullSeq)) {
+        --m_uiCount;
+    }
+    m_vSeqs[(m_uiHead + m_uiCount) % m_vSeqs.size()] = ullSeq;
+    ++m_uiCount;
+}
+
+void RollingWindow::MonotonicDeque::expire(uint64_t ullOldest) {
+    while (m_uiCount > 0 && m_vSeqs[m_uiHead] < ullOldest) {
+        m_uiHead = (m_uiHead + 1) % m_vSeqs.size();
+        --m_uiCount;
+    }
+}
+
+uint64_t RollingWindow::MonotonicDeque::front() const {
+    return m_vSeqs[m_uiHead];
+}
+
+RollingWindow::RollingWindow(size_t uiSize)
+    : m_vValues(std::max<size_t>(uiSize, 1)), m_oMin(m_vValues.size()), m_oMax(m_vValues.size()) {}
+
+void RollingWindow::push(float fValue) {
+    size_t uiSize = m_vValues.size();
+    uint64_t ullSeq = m_ullPushed++;
+    float& fSlot = m_vValues[ullSeq % uiSize];
+
+    if (ullSeq >= uiSize) {
+        m_dSum -= fSlot;
+    }
+    fSlot = fValue;
+    m_dSum += fValue;
+    if (ullSeq % uiSize == uiSize - 1) {
+        // Once per lap, so rounding errors of the running sum never pile up
+        m_dSum = 0;
+        for (float fOld : m_vValues) {
+            m_dSum += fOld;
+        }
+    }
+
+    uint64_t ullOldest = ullSeq + 1 > uiSize ? ullSeq + 1 - uiSize : 0;
+    m_oMin.expire(ullOldest);
+    m_oMax.expire(ullOldest);
+    m_oMin.push(ullSeq, [this](uint64_t ullOld, uint64_t ullNew) { return at(ullOld) < at(ullNew); });
+    m_oMax.push(ullSeq, [this](uint64_t ullOld, uint64_t ullNew) { return at(ullOld) > at(ullNew); });
+}
+
+void RollingWindow::clear() {
+    m_ullPushed = 0;
+    m_dSum = 0;
+    m_oMin.clear();
+    m_oMax.clear();
+}
+
+size_t RollingWindow::size() const {
+    return m_vValues.size();
+}
+
+size_t RollingWindow::count() const {
+    return static_cast<size_t>(std::min<uint64_t>(m_ullPushed, m_vValues.size()));
+}
+
+float RollingWindow::mean() const {
+    return count() ? static_cast<float>(m_dSum / count()) : 0.0f;
+}
+
+float RollingWindow::min() const {
+    return count() ? at(m_oMin.front()) : 0.0f;
+}
+
+float RollingWindow::max() const {
+    return count() ? at(m_oMax.front()) : 0.0f;
+}
+
+float RollingWindow::at(uint64_t ullSeq) const {
+    return m_vValues[ullSeq % m_vValues.size()];
+}
+
+MedianFilter::MedianFilter(size_t uiSize, float fMaxDeviation)
+    : m_vValues(std::max<size_t>(uiSize, 1)), m_vScratch(m_vValues.size()), m_fMaxDeviation(fMaxDeviation) {}
+
+float MedianFilter::filter(float fValue, bool& bOutlier) {
+    m_vValues[m_uiNext] = fValue;
+    m_uiNext = (m_uiNext + 1) % m_vValues.size();
+    m_uiCount = std::min(m_uiCount + 1, m_vValues.size());
+
+    std::copy(m_vValues.begin(), m_vValues.begin() + m_uiCount, m_vScratch.begin());
+    auto itMid = m_vScratch.begin() + m_uiCount / 2;
+    std::nth_element(m_vScratch.begin(), itMid, m_vScratch.begin() + m_uiCount);
+    float fMedian = *itMid;
+
+    bOutlier = std::fabs(fValue - fMedian) > m_fMaxDeviation;
+    return bOutlier ? fMedian : fValue;
+}
+
+void MedianFilter::clear() {
+    m_uiNext = 0;
+    m_uiCount = 0;
+}
+
+Ema::Ema(float fAlpha) : m_fAlpha(fAlpha) {}
+
+float Ema::push(float fValue) {
+    m_fValue = m_bPrimed ? m_fValue + m_fAlpha * (fValue - m_fValue) : fValue;
+    m_bPrimed = true;
+    return m_fValue;
+}
+
+float Ema::value() const {
+    return m_fValue;
+}
+
+void Ema::clear() {
+    m_bPrimed = false;
+}
+
+Hysteresis::Hysteresis(float fBand) : m_fBand(fBand) {}
+
+long Hysteresis::push(float fValue) {
+    if (!m_bPrimed || std::fabs(fValue - m_lValue) > 0.5f + m_fBand) {
+        m_lValue = std::lrint(fValue);
+        m_bPrimed = true;
+    }
+    return m_lValue;
+}
+
+long Hysteresis::value() const {
+    return m_lValue;
+}
+
+ReadingFilter::ReadingFilter(const Options& oOptions)
+    : m_oMedian(oOptions.uiMedian, oOptions.fMaxDeviation), m_oEma(oOptions.fAlpha),
+      m_oWindow(oOptions.uiWindow) {}
+
+float ReadingFilter::push(float fRaw, bool& bOutlier) {
+    float fValue = m_oMedian.filter(fRaw, bOutlier);
+    if (bOutlier) {
+        ++m_ullOutliers;
+    } else {
+        m_oWindow.push(fValue);
+    }
+    return m_oEma.push(fValue);
+}
+
+void ReadingFilter::clear() {
+    m_oMedian.clear();
+    m_oEma.clear();
+    m_oWindow.clear();
+}
+
+float ReadingFilter::filtered() const {
+    return m_oEma.value();
+}
+
+const RollingWindow& ReadingFilter::window() const {
+    return m_oWindow;
+}
+
+uint64_t ReadingFilter::outliers() const {
+    return m_ullOutliers;
+}
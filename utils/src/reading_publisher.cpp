@@ -0,0 +1,101 @@
+#include "reading_publisher.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <syslog.h>
+#include <unistd.h>
+
+#include "logger.h"
+
+ReadingPublisher::ReadingPublisher() {}
+
+ReadingPublisher::~ReadingPublisher() {
+    close();
+}
+
+bool ReadingPublisher::open(const std::string& sName, const int* pPins, size_t uiCount) {
+    close();
+
+    int iFd = shm_open(sName.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (iFd < 0) {
+        LOGGER_LOG(LOG_ERR, "ReadingPublisher| Failed to open [", sName, "]: ", std::strerror(errno));
+        return false;
+    }
+    if (ftruncate(iFd, sizeof(ReadingShm::Segment)) < 0) {
+        LOGGER_LOG(LOG_ERR, "ReadingPublisher| Failed to size [", sName, "]: ", std::strerror(errno));
+        ::close(iFd);
+        return false;
+    }
+    void* pMap = mmap(nullptr, sizeof(ReadingShm::Segment), PROT_READ | PROT_WRITE, MAP_SHARED, iFd, 0);
+    ::close(iFd);
+    if (pMap == MAP_FAILED) {
+        LOGGER_LOG(LOG_ERR, "ReadingPublisher| Failed to map [", sName, "]: ", std::strerror(errno));
+        return false;
+    }
+
+    m_pSegment = static_cast<ReadingShm::Segment*>(pMap);
+    m_uiSensors = std::min(uiCount, ReadingShm::MAX_SENSORS);
+    if (uiCount > m_uiSensors) {
+        LOGGER_LOG(LOG_WARNING, "ReadingPublisher| Only the first [", m_uiSensors, "] sensors are published");
+    }
+
+    // Slots are reset as regular writes, so readers of the previous process
+    // never see a torn slot. An odd sequence left by a crash is closed first.
+    for (size_t i = 0; i < m_uiSensors; ++i) {
+        ReadingShm::Slot& oSlot = m_pSegment->aSlots[i];
+        uint32_t uiSeq = oSlot.uiSeq.load(std::memory_order_relaxed) | 1;
+        oSlot.uiSeq.store(uiSeq, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        oSlot.iPin.store(pPins[i], std::memory_order_relaxed);
+        oSlot.uiTempBits.store(0, std::memory_order_relaxed);
+        oSlot.uiHumBits.store(0, std::memory_order_relaxed);
+        oSlot.uiTime.store(0, std::memory_order_relaxed);
+        oSlot.uiStatus.store(ReadingShm::STATUS_NONE, std::memory_order_relaxed);
+        oSlot.uiSamples.store(0, std::memory_order_relaxed);
+        oSlot.uiSeq.store(uiSeq + 1, std::memory_order_release);
+    }
+    m_pSegment->uiSensors.store(m_uiSensors, std::memory_order_release);
+    m_pSegment->uiVersion = ReadingShm::VERSION;
+    std::memcpy(m_pSegment->aMagic, ReadingShm::MAGIC, sizeof(ReadingShm::MAGIC));
+
+    LOGGER_LOG(LOG_INFO, "ReadingPublisher| Publishing [", m_uiSensors, "] sensors in [", sName, "]");
+    return true;
+}
+
+void ReadingPublisher::close() {
+    if (m_pSegment) {
+        munmap(m_pSegment, sizeof(ReadingShm::Segment));
+        m_pSegment = nullptr;
+    }
+    m_uiSensors = 0;
+}
+
+bool ReadingPublisher::isOpen() const {
+    return m_pSegment != nullptr;
+}
+
+void ReadingPublisher::publish(size_t uiIndex, ReadingShm::Status eStatus, float fTemp, float fHum, uint32_t uiTime) {
+    if (uiIndex >= m_uiSensors) {
+        return;
+    }
+
+    ReadingShm::Slot& oSlot = m_pSegment->aSlots[uiIndex];
+    uint32_t uiSeq = oSlot.uiSeq.load(std::memory_order_relaxed);
+    oSlot.uiSeq.store(uiSeq + 1, std::memory_order_relaxed);
+    // Keeps the field stores after the odd sequence
+    std::atomic_thread_fence(std::memory_order_release);
+
+    if (eStatus == ReadingShm::STATUS_OK) {
+        oSlot.uiTempBits.store(ReadingShm::toBits(fTemp), std::memory_order_relaxed);
+        oSlot.uiHumBits.store(ReadingShm::toBits(fHum), std::memory_order_relaxed);
+        oSlot.uiTime.store(uiTime, std::memory_order_relaxed);
+    }
+    oSlot.uiStatus.store(eStatus, std::memory_order_relaxed);
+    oSlot.uiSamples.store(oSlot.uiSamples.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    oSlot.uiSeq.store(uiSeq + 2, std::memory_order_release);
+}
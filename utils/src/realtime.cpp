@@ -0,0 +1,61 @@
+#include "realtime.h"
+
+#include <cerrno>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <syslog.h>
+
+#include "logger.h"
+
+bool Realtime::apply(const Options& oOptions) {
+    bool bRes = true;
+
+    // Page faults only matter under SCHED_FIFO, pinning alone keeps the memory pageable
+    if (oOptions.m_iPriority > 0) {
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) < 0) {
+            LOGGER_LOG(LOG_ERR, "Realtime| mlockall failed: ", std::strerror(errno));
+            bRes = false;
+        }
+
+        prefaultStack(oOptions.m_uiStackPrefault);
+    }
+
+    if (oOptions.m_iCpu >= 0) {
+        cpu_set_t oSet;
+        CPU_ZERO(&oSet);
+        CPU_SET(oOptions.m_iCpu, &oSet);
+        int iErr = pthread_setaffinity_np(pthread_self(), sizeof(oSet), &oSet);
+        if (iErr != 0) {
+            LOGGER_LOG(LOG_ERR, "Realtime| Failed to pin to CPU [", oOptions.m_iCpu, "]: ", std::strerror(iErr));
+            bRes = false;
+        }
+    }
+
+    if (oOptions.m_iPriority > 0) {
+        sched_param oParam {};
+        oParam.sched_priority = oOptions.m_iPriority;
+        int iErr = pthread_setschedparam(pthread_self(), SCHED_FIFO, &oParam);
+        if (iErr != 0) {
+            LOGGER_LOG(LOG_ERR, "Realtime| Failed to set SCHED_FIFO priority [", oOptions.m_iPriority, "]: ",
+                       std::strerror(iErr));
+            bRes = false;
+        }
+    }
+
+    LOGGER_LOG(LOG_INFO, "Realtime| priority [", oOptions.m_iPriority, "], cpu [", oOptions.m_iCpu,
+               "], applied: ", bRes);
+    return bRes;
+}
+
+// Not inlined so the buffer really lives below the caller's frame
+__attribute__((noinline)) void Realtime::prefaultStack(size_t uiBytes) {
+    if (!uiBytes) {
+        return;
+    }
+    volatile char* pStack = static_cast<volatile char*>(__builtin_alloca(uiBytes));
+    for (size_t i = 0; i < uiBytes; i += 4096) {
+        pStack[i] = 0;
+    }
+}
@@ -0,0 +1,93 @@
+#include "sample_bus.h"
+
+#include <cstring>
+
+namespace {
+
+uint32_t toBits(float fValue) {
+    uint32_t uiBits;
+    std::memcpy(&uiBits, &fValue, sizeof(uiBits));
+    return uiBits;
+}
+
+float fromBits(uint32_t uiBits) {
+    float fValue;
+    std::memcpy(&fValue, &uiBits, sizeof(fValue));
+    return fValue;
+}
+
+}
+
+SampleBus::SampleBus() {}
+
+uint32_t SampleBus::publish(bool bValid, float fTemp, float fHum, uint32_t uiTime, Clock::time_point oCaptured) {
+    return publish(bValid, fTemp, fHum, fTemp, fHum, false, uiTime, oCaptured);
+}
+
+uint32_t SampleBus::publish(bool bValid, float fTemp, float fHum, float fTempFiltered, float fHumFiltered,
+                            bool bOutlier, uint32_t uiTime, Clock::time_point oCaptured) {
+    uint32_t uiSeq = m_uiEnd.load(std::memory_order_relaxed);
+    Slot& oSlot = m_aSlots[uiSeq % CAPACITY];
+
+    oSlot.uiStamp.store(2 * uiSeq + 1, std::memory_order_relaxed);
+    // Keeps the field stores after the odd stamp
+    std::atomic_thread_fence(std::memory_order_release);
+    oSlot.uiFlags.store((bValid ? FLAG_VALID : 0) | (bOutlier ? FLAG_OUTLIER : 0), std::memory_order_relaxed);
+    oSlot.uiTempBits.store(toBits(fTemp), std::memory_order_relaxed);
+    oSlot.uiHumBits.store(toBits(fHum), std::memory_order_relaxed);
+    oSlot.uiTempFilteredBits.store(toBits(fTempFiltered), std::memory_order_relaxed);
+    oSlot.uiHumFilteredBits.store(toBits(fHumFiltered), std::memory_order_relaxed);
+    oSlot.uiTime.store(uiTime, std::memory_order_relaxed);
+    oSlot.uiCaptureMs.store(toMs(oCaptured), std::memory_order_relaxed);
+    oSlot.uiStamp.store(2 * uiSeq + 2, std::memory_order_release);
+
+    m_uiEnd.store(uiSeq + 1, std::memory_order_release);
+    return uiSeq;
+}
+
+bool SampleBus::at(uint32_t uiSeq, Record& oRecord) const {
+    const Slot& oSlot = m_aSlots[uiSeq % CAPACITY];
+    uint32_t uiStamp = 2 * uiSeq + 2;
+    if (oSlot.uiStamp.load(std::memory_order_acquire) != uiStamp) {
+        return false;
+    }
+
+    oRecord.uiSeq = uiSeq;
+    uint32_t uiFlags = oSlot.uiFlags.load(std::memory_order_relaxed);
+    oRecord.bValid = uiFlags & FLAG_VALID;
+    oRecord.bOutlier = uiFlags & FLAG_OUTLIER;
+    oRecord.fTemp = fromBits(oSlot.uiTempBits.load(std::memory_order_relaxed));
+    oRecord.fHum = fromBits(oSlot.uiHumBits.load(std::memory_order_relaxed));
+    oRecord.fTempFiltered = fromBits(oSlot.uiTempFilteredBits.load(std::memory_order_relaxed));
+    oRecord.fHumFiltered = fromBits(oSlot.uiHumFilteredBits.load(std::memory_order_relaxed));
+    oRecord.uiTime = oSlot.uiTime.load(std::memory_order_relaxed);
+    oRecord.uiCaptureMs = oSlot.uiCaptureMs.load(std::memory_order_relaxed);
+
+    // Orders the copies before the second look at the stamp
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return oSlot.uiStamp.load(std::memory_order_relaxed) == uiStamp;
+}
+
+bool SampleBus::latest(Record& oRecord) const {
+    for (int i = 0; i < MAX_TRIES; ++i) {
+        uint32_t uiEnd = end();
+        if (uiEnd == 0) {
+            return false;
+        }
+        if (at(uiEnd - 1, oRecord)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SampleBus::latestValid(Record& oRecord) const {
+    uint32_t uiEnd = end();
+    uint32_t uiCount = uiEnd < CAPACITY ? uiEnd : CAPACITY;
+    for (uint32_t i = 1; i <= uiCount; ++i) {
+        if (at(uiEnd - i, oRecord) && oRecord.bValid) {
+            return true;
+        }
+    }
+    return false;
+}
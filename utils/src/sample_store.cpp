@@ -0,0 +1,194 @@
+#include "sample_store.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <syslog.h>
+#include <unistd.h>
+
+#include "logger.h"
+
+namespace {
+
+const char MAGIC[8] = {'T', 'H', 'C', 'H', 'I', 'S', 'T', '1'};
+const uint32_t VERSION = 1;
+// Byte sum of a valid record; an all-zero slot never passes.
+const uint8_t CHECK_SEED = 0xA5;
+
+}
+
+SampleStore::SampleStore() {}
+
+SampleStore::~SampleStore() {
+    close();
+}
+
+bool SampleStore::open(const std::string& sPath, uint64_t ullCapacity, bool bReadOnly) {
+    close();
+
+    m_bReadOnly = bReadOnly;
+    m_iFd = ::open(sPath.c_str(), bReadOnly ? O_RDONLY : (O_RDWR | O_CREAT), 0644);
+    if (m_iFd < 0) {
+        LOGGER_LOG(LOG_ERR, "SampleStore| Failed to open [", sPath, "]: ", std::strerror(errno));
+        return false;
+    }
+
+    struct stat oStat;
+    if (fstat(m_iFd, &oStat) < 0) {
+        LOGGER_LOG(LOG_ERR, "SampleStore| Failed to stat [", sPath, "]: ", std::strerror(errno));
+        close();
+        return false;
+    }
+
+    bool bCreate = oStat.st_size == 0;
+    if (bCreate) {
+        if (bReadOnly || ullCapacity == 0) {
+            LOGGER_LOG(LOG_ERR, "SampleStore| Empty history file [", sPath, "]");
+            close();
+            return false;
+        }
+        // Sparse until written, so creation costs no SD card writes
+        if (ftruncate(m_iFd, HEADER_SIZE + ullCapacity * sizeof(Sample)) < 0) {
+            LOGGER_LOG(LOG_ERR, "SampleStore| Failed to size [", sPath, "]: ", std::strerror(errno));
+            close();
+            return false;
+        }
+        m_uiMapSize = HEADER_SIZE + ullCapacity * sizeof(Sample);
+    } else {
+        m_uiMapSize = oStat.st_size;
+    }
+
+    m_pMap = mmap(nullptr, m_uiMapSize, bReadOnly ? PROT_READ : (PROT_READ | PROT_WRITE), MAP_SHARED, m_iFd, 0);
+    if (m_pMap == MAP_FAILED) {
+        m_pMap = nullptr;
+        LOGGER_LOG(LOG_ERR, "SampleStore| Failed to map [", sPath, "]: ", std::strerror(errno));
+        close();
+        return false;
+    }
+
+    m_pHeader = static_cast<Header*>(m_pMap);
+    m_pSamples = reinterpret_cast<Sample*>(static_cast<char*>(m_pMap) + HEADER_SIZE);
+
+    if (bCreate) {
+        std::memcpy(m_pHeader->aMagic, MAGIC, sizeof(MAGIC));
+        m_pHeader->uiVersion = VERSION;
+        m_pHeader->uiRecordSize = sizeof(Sample);
+        m_pHeader->ullCapacity = ullCapacity;
+        m_pHeader->ullNextSeq.store(0, std::memory_order_release);
+    } else if (std::memcmp(m_pHeader->aMagic, MAGIC, sizeof(MAGIC)) != 0 ||
+               m_pHeader->uiVersion != VERSION ||
+               m_pHeader->uiRecordSize != sizeof(Sample) ||
+               m_pHeader->ullCapacity == 0 ||
+               HEADER_SIZE + m_pHeader->ullCapacity * sizeof(Sample) > m_uiMapSize) {
+        LOGGER_LOG(LOG_ERR, "SampleStore| Not a history file: [", sPath, "]");
+        close();
+        return false;
+    }
+
+    if (!bReadOnly) {
+        recover();
+    }
+    return true;
+}
+
+void SampleStore::close() {
+    if (m_pMap) {
+        munmap(m_pMap, m_uiMapSize);
+        m_pMap = nullptr;
+    }
+    if (m_iFd >= 0) {
+        ::close(m_iFd);
+        m_iFd = -1;
+    }
+    m_pHeader = nullptr;
+    m_pSamples = nullptr;
+    m_uiMapSize = 0;
+}
+
+bool SampleStore::isOpen() const {
+    return m_pHeader != nullptr;
+}
+
+bool SampleStore::append(uint32_t uiTime, float fTemp, float fHum, uint32_t uiLatencyUs, Status eStatus) {
+    if (!m_pHeader || m_bReadOnly) {
+        return false;
+    }
+
+    uint64_t ullSeq = m_pHeader->ullNextSeq.load(std::memory_order_relaxed);
+    Sample oSample;
+    oSample.uiTime = uiTime;
+    oSample.uiSeq = static_cast<uint32_t>(ullSeq);
+    oSample.iTempTenths = static_cast<int16_t>(std::lround(fTemp * 10));
+    oSample.uiHumTenths = static_cast<uint16_t>(std::lround(std::max(fHum, 0.0f) * 10));
+    oSample.uiLatency100Us = static_cast<uint16_t>(std::min<uint32_t>(uiLatencyUs / 100, 0xFFFF));
+    oSample.uiStatus = eStatus;
+    oSample.uiCheck = 0;
+    oSample.uiCheck = static_cast<uint8_t>(CHECK_SEED - checksum(oSample));
+
+    m_pSamples[ullSeq % m_pHeader->ullCapacity] = oSample;
+    m_pHeader->ullNextSeq.store(ullSeq + 1, std::memory_order_release);
+    return true;
+}
+
+uint64_t SampleStore::capacity() const {
+    return m_pHeader ? m_pHeader->ullCapacity : 0;
+}
+
+uint64_t SampleStore::begin() const {
+    uint64_t ullEnd = end();
+    return ullEnd > capacity() ? ullEnd - capacity() : 0;
+}
+
+uint64_t SampleStore::end() const {
+    if (!m_pHeader) {
+        return 0;
+    }
+    // The header hint may lag the records if the writer crashed
+    uint64_t ullEnd = m_pHeader->ullNextSeq.load(std::memory_order_acquire);
+    for (uint64_t i = 0; i < m_pHeader->ullCapacity && valid(m_pSamples[ullEnd % m_pHeader->ullCapacity], ullEnd); ++i) {
+        ++ullEnd;
+    }
+    return ullEnd;
+}
+
+const SampleStore::Sample* SampleStore::at(uint64_t ullSeq) const {
+    if (!m_pHeader) {
+        return nullptr;
+    }
+    const Sample& oSample = m_pSamples[ullSeq % m_pHeader->ullCapacity];
+    return valid(oSample, ullSeq) ? &oSample : nullptr;
+}
+
+float SampleStore::temperature(const Sample& oSample) {
+    return oSample.iTempTenths / 10.0f;
+}
+
+float SampleStore::humidity(const Sample& oSample) {
+    return oSample.uiHumTenths / 10.0f;
+}
+
+uint8_t SampleStore::checksum(const Sample& oSample) {
+    const uint8_t* pBytes = reinterpret_cast<const uint8_t*>(&oSample);
+    uint8_t uiSum = 0;
+    for (size_t i = 0; i < sizeof(Sample); ++i) {
+        uiSum += pBytes[i];
+    }
+    return uiSum;
+}
+
+bool SampleStore::valid(const Sample& oSample, uint64_t ullSeq) const {
+    return oSample.uiSeq == static_cast<uint32_t>(ullSeq) && checksum(oSample) == CHECK_SEED;
+}
+
+void SampleStore::recover() {
+    uint64_t ullHint = m_pHeader->ullNextSeq.load(std::memory_order_relaxed);
+    uint64_t ullEnd = end();
+    if (ullEnd != ullHint) {
+        LOGGER_LOG(LOG_INFO, "SampleStore| Recovered ", ullEnd - ullHint, " samples past the header");
+        m_pHeader->ullNextSeq.store(ullEnd, std::memory_order_release);
+    }
+}